@@ -14,10 +14,19 @@
 
 typedef float Elem;
 
+/*The sparse and packed forms of a vector. See vectorSparse.h and vectorPack.h*/
+struct Sparse;
+struct Packed;
+
 struct Vector {
 
 	int size;
+	/*Null while the vector is sparse or packed*/
 	Elem *elements;
+	/*Null unless the vector is sparse*/
+	struct Sparse *sparse;
+	/*Null unless the vector is packed*/
+	struct Packed *packed;
 };
 
 #endif /*_VECALC_H_*/
@@ -0,0 +1,44 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorAsync.h						//
+ * Synopsis	:	Asynchronous output. Results are handed to a writer	//
+ * 			thread so that a slow reader doesn't hold up the	//
+ * 			commands							//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORASYNC_H_
+#define _VECTORASYNC_H_
+
+/*Local Headers*/
+#include "vectorCmd.h" /*For definition of a Session*/
+
+/*
+ * Number of buffers that can be filled or waiting to be written at once. When
+ * they are all waiting, output waits for the writer to catch up.
+ */
+#define ASYNC_BUFFERS 3
+
+/*Size of each buffer handed to the writer thread*/
+#define ASYNC_BUFFER_SIZE 262144
+
+/*
+ * Starts the writer thread and replaces a session's output and error streams
+ * with ones that go through it. Output is handed to the writer a buffer at a
+ * time and whenever it is flushed. Anything printed as an error waits for the
+ * output before it to be written first, so the two stay in order. Everything
+ * is written out when the program exits.
+ * param struct Session *: The session whose streams are replaced
+ * param int: The file descriptor that output is written to
+ * param int: The file descriptor that errors are written to
+ * precond: Only called once
+ */
+void asyncOutput(struct Session *, int, int);
+
+/*
+ * Waits until everything printed so far has been written
+ */
+void asyncWait(void);
+
+#endif /*_VECTORASYNC_H_*/
@@ -0,0 +1,57 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorBin.h						//
+ * Synopsis	:	Defines the binary record format that commands can be	//
+ * 			sent in with instead of text				//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORBIN_H_
+#define _VECTORBIN_H_
+
+/*Standard Headers*/
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vectorCmd.h" /*For definition of a Session*/
+#include "vectorIn.h" /*For definition of Flags*/
+
+/*Input is read this many bytes at a time*/
+#define BIN_BLOCK_SIZE 65536
+
+/*Set in a record's flags when the operand and payload are doubles*/
+#define BIN_DOUBLE 0x01
+
+/*
+ * One command in binary form. Records are 16 bytes in the byte order of the
+ * host and are packed back to back. A record with a non-zero length is
+ * followed directly by that many values (floats, or doubles if BIN_DOUBLE is
+ * set), which are all appended to the vector. Only the a option may have a
+ * payload.
+ */
+struct BinaryRecord {
+
+	uint8_t opcode;		/*The same character as the text option*/
+	uint8_t flags;
+	uint16_t reserved;	/*Must be zero, or the record is rejected*/
+	uint32_t length;	/*Number of values in the payload*/
+	union {
+
+		float f;
+		double d;
+	} operand;
+};
+
+/*
+ * Reads binary records from a file descriptor until a q or e record or the
+ * end of the input and runs them against a session
+ * param struct Session *: The session to run the commands against
+ * param int: The file descriptor to read records from
+ * param struct Flags *: Settings that apply to running the commands
+ * return: EXIT_SUCCESS, or EXIT_FAILURE if the input could not be read or ends
+ * part way through a record
+ */
+int binaryIn(struct Session *, int, struct Flags *);
+
+#endif /*_VECTORBIN_H_*/
@@ -0,0 +1,193 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorCmd.h						//
+ * Synopsis	:	Defines a parsed command and the session that commands	//
+ * 			are run against						//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORCMD_H_
+#define _VECTORCMD_H_
+
+/*Standard Headers*/
+#include <stdio.h>
+#include <stdbool.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Vector*/
+#include "vectorOut.h" /*For definition of Format*/
+#include "vectorIn.h" /*For definition of Flags*/
+#include "vectorDiag.h" /*For definition of Diagnostics*/
+#include "vectorStats.h" /*For definition of Stats*/
+#include "vectorPack.h" /*For definition of Storage*/
+
+/*Number of registers that v can save the vector in*/
+#define VEC_REGISTERS 10
+
+/*
+ * A single option from the command line after it has been checked. Options
+ * that take a value have it converted already so that running a command never
+ * has to look at the original string again.
+ */
+struct Command {
+
+	char option;
+	Elem value;
+	/*
+	 * Whole number arguments of the ranged printing options; the count for
+	 * b, t and k, or the start and end of a slice for s
+	 */
+	long range[2];
+	/*The input line the command came from, for diagnostics*/
+	long line;
+	/*
+	 * Set by the optimizer when a query can re-use the result of the same
+	 * query earlier in the line instead of computing it again
+	 */
+	bool reuse;
+};
+
+/*
+ * Everything that running a command can change. The vector may be null after
+ * a clear, in which case a new one is allocated by the next command.
+ */
+struct Session {
+
+	struct Vector *vec;
+	/*Where printed results and error messages go*/
+	FILE *out;
+	FILE *err;
+	/*Result of the last magnitude query, for commands marked reuse*/
+	Elem lastMagnitude;
+	/*The format results are printed in, changed with the f option*/
+	enum Format format;
+	/*How the vector and saved registers are stored, changed with the z option*/
+	enum Storage storage;
+	/*Vectors saved with v, or loaded with --reference, for d to compare against*/
+	struct Vector *registers[VEC_REGISTERS];
+	/*How far apart elements can be for d, and how many differences it lists*/
+	struct Tolerance tolerance;
+	int showFirst;
+	/*Counts of bad input and commands with no effect*/
+	struct Diagnostics diag;
+	/*Latencies of the commands that have run, or null if they aren't timed*/
+	struct Stats *stats;
+	/*The number of the input line being parsed. Initial options are line 0*/
+	long line;
+	/*The options of the last line run, for the r option and for snapshots*/
+	char *lastLine;
+	/*
+	 * Set while another thread parses lines into lastLine ahead of the
+	 * commands being run, so snapshots leave it out
+	 */
+	bool lastLineShared;
+	/*Where w writes a snapshot. See vectorSnap.h*/
+	const char *snapshotPath;
+	/*Lines between periodic snapshots, or 0 for none, and the line of the last*/
+	long snapshotEvery;
+	long snapshotLast;
+};
+
+/*
+ * Sets up a session with an empty vector
+ * param struct Session *: The session to initialise
+ * param FILE *: Stream that results are printed to
+ * param FILE *: Stream that errors are printed to
+ */
+void init_session(struct Session *, FILE *, FILE *);
+
+/*
+ * Applies the flags vecalc was run with to a session
+ * param struct Session *: The session the flags apply to
+ * param struct Flags *: The flags
+ */
+void configure_session(struct Session *, struct Flags *);
+
+/*
+ * Frees everything held by a session, printing a summary of its diagnostics
+ * first if they are quiet
+ * param struct Session *: The session to free. The session itself isn't freed
+ */
+void free_session(struct Session *);
+
+/*
+ * Checks a list of options and their values and converts them to commands.
+ * Bad options and bad values are reported on the session's error stream and
+ * left out, exactly as if they had been skipped over.
+ * param struct Session *: The session that errors are reported to
+ * param char *[]: The options, starting with the first one entered
+ * param int: The number of options
+ * param struct Command *: Filled with the parsed commands. Must have room for
+ * at least as many commands as there are options
+ * return: The number of commands placed in the command list
+ * precond: Parsing stops after a q or e, since nothing after them will run
+ */
+int parseCommands(struct Session *, char *[], int, struct Command *);
+
+/*
+ * Runs a single command on the session's vector
+ * param struct Session *: The session to run the command against
+ * param struct Command *: The command to run
+ * return: false if the command ends the session (q or e), true otherwise
+ * postcond: The session's vector is deallocated if false is returned
+ */
+bool runCommand(struct Session *, struct Command *);
+
+/*
+ * Appends values to the session's vector in the way the a option does, so the
+ * session's storage and sparse settings apply, stopping at the maximum size of
+ * a vector
+ * param struct Session *: The session whose vector is extended
+ * param Elem *: The values to append
+ * param int: The number of values
+ * param long: The line the values came from, for diagnostics
+ */
+void appendValues(struct Session *, Elem *, int, long);
+
+/*
+ * Runs a list of commands in order, stopping early if one ends the session
+ * param struct Session *: The session to run the commands against
+ * param struct Command *: The list of commands
+ * param int: The number of commands in the list
+ * return: false if the session was ended, true otherwise
+ */
+bool runCommands(struct Session *, struct Command *, int);
+
+/*
+ * Keeps the options of a line that was split into arguments as the session's
+ * last line, as parseLine() does for the lines it parses
+ * param struct Session *: The session
+ * param char *[]: The options of the line
+ * param int: The number of options
+ */
+void rememberLine(struct Session *, char *[], int);
+
+/*
+ * Converts one line of input into commands, in the same way a line typed at
+ * the vecalc prompt is checked. Only the session's error stream and the last
+ * line (for r) are used, so a line can be parsed while another thread is
+ * running commands against the same session.
+ * param struct Session *: The session the line belongs to
+ * param char *: The line of input. A trailing newline is ignored
+ * param bool: true if the commands should be run through the optimizer
+ * param FILE *: If not null, the optimizer reports what it eliminated here
+ * param struct Command **: Set to the list of commands, which must be freed by
+ * the caller
+ * return: The number of commands, or -1 for a blank line
+ */
+int parseLine(struct Session *, char *, bool, FILE *, struct Command **);
+
+/*
+ * Runs one line of input against a session, in the same way a line typed at
+ * the vecalc prompt is run. A line starting with r repeats the options of the
+ * last line run against the session, followed by any new options.
+ * param struct Session *: The session to run the line against
+ * param char *: The line of input. A trailing newline is ignored
+ * param bool: true if the line should be run through the optimizer
+ * param FILE *: If not null, the optimizer reports what it eliminated here
+ * return: false if the line ended the session (q, e or a blank line)
+ */
+bool runLine(struct Session *, char *, bool, FILE *);
+
+#endif /*_VECTORCMD_H_*/
@@ -0,0 +1,133 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorDiag.h						//
+ * Synopsis	:	Diagnostics. Messages about bad input and commands	//
+ * 			with no effect are counted by type and input line,	//
+ * 			and can be kept quiet until a summary at the end	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORDIAG_H_
+#define _VECTORDIAG_H_
+
+/*Standard Headers*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/*Size of the buffer given to stderr when it isn't a terminal*/
+#define DIAG_BUFFER_SIZE 65536
+
+/*The most input lines listed for each type of diagnostic in the summary*/
+#define DIAG_SUMMARY_LINES 10
+
+/*The kinds of events that are counted*/
+enum DiagType {
+
+	DIAG_INVALID_OPTION,	/*An option vecalc doesn't have*/
+	DIAG_BAD_ARGUMENT,	/*An option with a missing or bad value*/
+	DIAG_MISPLACED_REPEAT,	/*An r after another option*/
+	DIAG_ZERO_SIZE,		/*An operation or print on a zero size vector*/
+	DIAG_DIVIDE_BY_ZERO,	/*A divide by zero*/
+	DIAG_VECTOR_FULL,	/*An append to a vector at MAXVECSIZE*/
+	DIAG_BAD_RECORD,	/*A binary record that can't be run*/
+	DIAG_SNAPSHOT,		/*A snapshot that couldn't be written*/
+	DIAG_TYPES		/*The number of types*/
+};
+
+/*The number of times one type of event happened on one input line*/
+struct DiagCount {
+
+	long line;
+	int type;
+	long count;
+};
+
+/*An event held back by diagnostics that hold, to be counted and printed later*/
+struct DiagEvent {
+
+	enum DiagType type;
+	long line;
+	FILE *stream;
+	char *message;
+};
+
+/*
+ * The diagnostics of a session. Counts are kept in an open addressing hash
+ * table keyed on the type and the input line. The lock is there for the
+ * pipeline, where lines are parsed and run on different threads.
+ */
+struct Diagnostics {
+
+	/*Count events instead of printing them*/
+	bool quiet;
+	/*While quiet, the number of events of each type still printed*/
+	long sample;
+	long totals[DIAG_TYPES];
+	struct DiagCount *counts;
+	int capacity;
+	int used;
+	pthread_mutex_t lock;
+	/*
+	 * Hold events back instead of counting and printing them. The pipeline
+	 * parses with diagnostics that hold, and replays the events on the
+	 * thread that runs the commands, so they come out in order.
+	 */
+	bool hold;
+	struct DiagEvent *held;
+	int heldCount;
+	int heldCapacity;
+};
+
+/*
+ * Sets up diagnostics with nothing counted, printing every message
+ * param struct Diagnostics *: The diagnostics to initialise
+ */
+void init_diag(struct Diagnostics *);
+
+/*
+ * Frees the counts held by diagnostics, and any events held back
+ * param struct Diagnostics *: The diagnostics to free
+ */
+void free_diag(struct Diagnostics *);
+
+/*
+ * Counts an event and prints its message, unless the diagnostics are quiet and
+ * enough of this type have already been sampled
+ * param struct Diagnostics *: The diagnostics that count the event
+ * param enum DiagType: The type of event
+ * param long: The input line that caused the event
+ * param FILE *: Where the message is printed
+ * param const char *: printf style format of the message, followed by its
+ * arguments
+ */
+void diagnose(struct Diagnostics *, enum DiagType, long, FILE *, const char *, ...);
+
+/*
+ * Hands over the events held back since the last call, leaving none held
+ * param struct Diagnostics *: Diagnostics that hold
+ * param struct DiagEvent **: Filled with the events, or null if there are none.
+ * They are freed by replay_diag()
+ * return: The number of events
+ */
+int take_held(struct Diagnostics *, struct DiagEvent **);
+
+/*
+ * Counts and prints held events as if they had just happened, then frees them
+ * param struct Diagnostics *: The diagnostics that count the events
+ * param struct DiagEvent *: The events, from take_held(). May be null
+ * param int: The number of events
+ */
+void replay_diag(struct Diagnostics *, struct DiagEvent *, int);
+
+/*
+ * Prints how many of each type of event happened and on which input lines most
+ * of them did, then clears the counts. Nothing is printed if nothing was
+ * counted.
+ * param struct Diagnostics *: The diagnostics to summarise
+ * param FILE *: Where the summary is printed
+ */
+void diagSummary(struct Diagnostics *, FILE *);
+
+#endif /*_VECTORDIAG_H_*/
@@ -0,0 +1,63 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorDiff.h						//
+ * Synopsis	:	Compares a vector against a reference vector, within	//
+ * 			a tolerance						//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORDIFF_H_
+#define _VECTORDIFF_H_
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of a Vector*/
+
+/*The most differing indices a comparison can report*/
+#define DIFF_FIRST_MAX 64
+
+/*
+ * Vectors smaller than this are compared on one thread, unless a profile from
+ * vecalc --calibrate says otherwise (see vectorTune.h)
+ */
+#define DIFF_PARALLEL_MIN 262144
+
+/*
+ * How far apart two elements can be and still match. Elements match if they
+ * are within any one of the tolerances. All zero means they must be exactly
+ * the same.
+ */
+struct Tolerance {
+
+	double absolute;	/*Largest difference*/
+	double relative;	/*Largest difference, relative to the larger element*/
+	long ulps;		/*Most floats that can lie between them*/
+};
+
+/*What a comparison found*/
+struct DiffResult {
+
+	/*Number of elements compared, which is the size of the smaller vector*/
+	long compared;
+	long mismatches;
+	/*The largest difference between two elements, and where it was*/
+	double maxError;
+	long maxErrorIndex;
+	/*The indices of the first mismatches, in order*/
+	int firstCount;
+	long first[DIFF_FIRST_MAX];
+};
+
+/*
+ * Compares two vectors element by element in a single pass, on several
+ * threads for large vectors. Two NaNs match each other and nothing else.
+ * param struct Vector *: The vector being checked
+ * param struct Vector *: The reference vector
+ * param struct Tolerance *: How far apart elements can be and still match
+ * param int: The most mismatched indices to record, up to DIFF_FIRST_MAX
+ * param struct DiffResult *: Filled with what was found
+ * precond: Neither vector is null
+ */
+void diff_vec(struct Vector *, struct Vector *, struct Tolerance *, int, struct DiffResult *);
+
+#endif /*_VECTORDIFF_H_*/
@@ -0,0 +1,136 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorEpoch.h						//
+ * Synopsis	:	Versions of a vector that other threads can read	//
+ * 			without locks while one thread keeps changing it	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTOREPOCH_H_
+#define _VECTOREPOCH_H_
+
+/*Standard Headers*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Vector*/
+
+/*Most readers that can hold a version at once*/
+#define EPOCH_READERS 16
+
+/*
+ * Each reader holds at most one buffer, and the writer needs the current one
+ * and one to write the next version into, so it never has to wait for a reader
+ */
+#define EPOCH_BUFFERS (EPOCH_READERS + 2)
+
+/*The epoch is kept in this many bits of the state, and wraps around*/
+#define EPOCH_BITS 24
+
+/*Elements copied and swept at a time, so the copy is still in cache for the sweep*/
+#define EPOCH_BLOCK 4096
+
+/*Bytes in a cache line, which each reader's slot is padded to*/
+#define EPOCH_LINE 64
+
+/*Memory a version's elements are in*/
+struct EpochBuffer {
+
+	Elem *elements;
+	long capacity;		/*Elements there is room for*/
+};
+
+/*
+ * The buffer a reader holds, plus one, or 0 while it holds none. Every slot
+ * is on its own cache line, so readers don't slow each other down.
+ */
+struct EpochSlot {
+
+	long buffer;
+	char pad[EPOCH_LINE - sizeof(long)];
+};
+
+/*
+ * The versions of a vector. Every change the writer makes is published as a
+ * new version with the next epoch: + - * and / are written into a buffer no
+ * reader holds, and appends that fit go on the end of the current buffer,
+ * which readers of the shorter versions never look past. A buffer is reused
+ * as soon as no reader holds it. The state is read and written with GCC's
+ * __atomic builtins.
+ */
+struct Epochs {
+
+	uint64_t state;		/*The epoch, buffer and size of the current version, published together*/
+	struct EpochSlot slots[EPOCH_READERS];
+	struct EpochBuffer buffers[EPOCH_BUFFERS];
+	int current;		/*The buffer of the current version. Only the writer uses this*/
+	long epoch;		/*The epoch of the current version. Only the writer uses this*/
+};
+
+/*
+ * Starts keeping versions of a vector, taking over its elements as the first
+ * one. From then on the elements are only changed through the other writer
+ * functions, which keep the vector pointing at the current version.
+ * param struct Vector *: The vector, which must be dense
+ * param long: Elements there is room for in its memory
+ * return: The versions, or null if they couldn't be allocated
+ */
+struct Epochs *epoch_share(struct Vector *, long);
+
+/*
+ * Frees every version, and the vector's elements with them. No reader can be
+ * holding a version
+ * param struct Epochs *: The versions. Null is ignored
+ */
+void epoch_free(struct Epochs *);
+
+/*
+ * Applies an operation to the vector as a new version, with the same results
+ * as the kernels give in place
+ * param struct Epochs *: The versions
+ * param struct Vector *: The vector
+ * param char: +, -, * or /
+ * param Elem: The value of the operation
+ * return: false if there wasn't memory for the new version, which leaves the
+ * vector as it was
+ */
+bool epoch_sweep(struct Epochs *, struct Vector *, char, Elem);
+
+/*
+ * Appends elements to the vector as a new version
+ * param struct Epochs *: The versions
+ * param struct Vector *: The vector
+ * param const Elem *: The values
+ * param long: The number of values
+ * return: false if there wasn't memory for the new version
+ */
+bool epoch_append(struct Epochs *, struct Vector *, const Elem *, long);
+
+/*
+ * Empties the vector as a new version
+ * param struct Epochs *: The versions
+ * param struct Vector *: The vector
+ */
+void epoch_clear(struct Epochs *, struct Vector *);
+
+/*
+ * Takes hold of the current version, from any thread, without locking. The
+ * version doesn't change, and its buffer isn't reused, until it is let go of
+ * param struct Epochs *: The versions
+ * param struct Vector *: Filled with the elements and size of the version
+ * param long *: Filled with its epoch
+ * return: The reader slot it is held with, or -1 if EPOCH_READERS versions are
+ * held already
+ */
+int epoch_enter(struct Epochs *, struct Vector *, long *);
+
+/*
+ * Lets go of a version
+ * param struct Epochs *: The versions
+ * param int: The reader slot from epoch_enter()
+ */
+void epoch_exit(struct Epochs *, int);
+
+#endif /*_VECTOREPOCH_H_*/
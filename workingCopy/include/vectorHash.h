@@ -0,0 +1,75 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorHash.h						//
+ * Synopsis	:	Checksums of a vector, for checking that two runs	//
+ * 			ended with the same vector without printing it		//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORHASH_H_
+#define _VECTORHASH_H_
+
+/*Standard Headers*/
+#include <stddef.h>
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of a Vector*/
+
+/*
+ * State of a running XXH64 hash, so input can be hashed a piece at a time.
+ * Input is consumed in stripes of 32 bytes, one 8 byte lane per accumulator.
+ */
+struct HashState {
+
+	uint64_t lanes[4];
+	uint64_t length;
+	unsigned char stripe[32];
+	int buffered;
+};
+
+/*
+ * Starts a hash
+ * param struct HashState *: The state to start
+ * param uint64_t: The seed
+ */
+void hashStart(struct HashState *, uint64_t);
+
+/*
+ * Adds bytes to a hash
+ * param struct HashState *: The hash
+ * param const void *: The bytes
+ * param size_t: The number of bytes
+ */
+void hashAdd(struct HashState *, const void *, size_t);
+
+/*
+ * Finishes a hash
+ * param struct HashState *: The hash
+ * return: The XXH64 hash of everything added
+ */
+uint64_t hashEnd(struct HashState *);
+
+/*
+ * Hashes the raw bytes of a vector's elements with XXH64. Two vectors have the
+ * same checksum when their elements are exactly the same, bit for bit.
+ * param struct Vector *: The vector to hash
+ * return: The checksum
+ * precond: Input vector is not null
+ */
+uint64_t checksum(struct Vector *);
+
+/*
+ * Hashes a vector's elements after rounding them to a multiple of a tolerance,
+ * so that vectors whose elements differ by much less than the tolerance almost
+ * always get the same fingerprint. -0 is the same as 0, and every NaN is the
+ * same.
+ * param struct Vector *: The vector to hash
+ * param double: The tolerance. Must be greater than zero
+ * return: The fingerprint
+ * precond: Input vector is not null
+ */
+uint64_t fingerprint(struct Vector *, double);
+
+#endif /*_VECTORHASH_H_*/
@@ -1,11 +1,64 @@
 #ifndef _VECTORIN_H_
-#define _VECTORIN_H
+#define _VECTORIN_H_
 
 #define MAX_INPUT_LENGTH 185 /*Arbritray choice based on how many characters
 			       fit the width of my screen*/
+#define MAX_OPTIONS 4096 /*Most options argv can hold, including repeats*/
 /*Standard Headers*/
 #include <stdbool.h>
 
+/*Local Headers*/
+#include "vecalc.h" /*For definition of a Vector*/
+#include "vectorDiff.h" /*For definition of a Tolerance*/
+
+/*
+ * Settings for the whole run of vecalc. These are given as initial arguments
+ * starting with "--", before the first option.
+ */
+struct Flags {
+
+	bool optimize;	/*Run the peephole optimizer over each line*/
+	bool showOptimized; /*Print what the optimizer eliminated to stderr*/
+	bool binary;	/*Read commands from stdin as binary records*/
+	bool pipeline;	/*Parse input on a separate thread from running it*/
+	bool run;	/*The arguments are scripts to run, not options*/
+	char *socketPath; /*Run as a server on this Unix domain socket*/
+	int workers;	/*Number of threads that run commands for the server*/
+	int format;	/*The output format every session starts with*/
+	bool asyncOutput; /*Write output on a separate thread*/
+	bool quiet;	/*Count diagnostics instead of printing them*/
+	bool stats;	/*Time every command and print the statistics at the end*/
+	bool calibrate;	/*Measure the thresholds of the kernels and write a profile*/
+	int placement;	/*Where large vectors are put, or -1 for the profile's placement*/
+	long sample;	/*While quiet, how many of each diagnostic are printed*/
+	struct Tolerance tolerance; /*How far apart elements can be for d*/
+	int showFirst;	/*How many differing indices d prints*/
+	struct Vector *reference; /*Loaded into register 0 of every session*/
+	char *snapshotPath;	/*Where w writes snapshots, or null for SNAP_DEFAULT_NAME*/
+	long snapshotEvery;	/*Lines between snapshots of the main session, or 0 for none*/
+	char *restorePath;	/*A snapshot the main session is restored from*/
+};
+
+/*
+ * Takes any flags off the front of argv and shifts the remaining arguments
+ * down so that argv[1] is the first option
+ * param char *[]: The argument vector the program was run with
+ * param int: The number of arguments in argv
+ * param struct Flags *: Filled in with the flags that were given
+ * return: The number of arguments left in argv
+ * postcond: Exits with a usage message if a flag isn't recognised
+ */
+int parseFlags(char *[], int, struct Flags *);
+
+/*
+ * Reads a vector from a file of numbers separated by white space, such as
+ * the output of p
+ * param char *: The path of the file
+ * return: The vector, or null if the file couldn't be read or has something
+ * in it that isn't a number
+ */
+struct Vector *load_vec(char *);
+
 /*
  * Checks to see if the argument is a digit or not
  * param arg: The current argument that needs to be checked
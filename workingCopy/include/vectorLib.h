@@ -0,0 +1,222 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorLib.h						//
+ * Synopsis	:	The vector calculator as a library that programs can	//
+ * 			call in-process, without argv strings			//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORLIB_H_
+#define _VECTORLIB_H_
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Elem*/
+
+/*
+ * What every library call returns. Nothing in the library prints, exits or
+ * asks for input; anything that goes wrong comes back as one of these and
+ * leaves the vector as it was.
+ */
+enum VecStatus {
+
+	VEC_OK = 0,
+	/*An allocation failed*/
+	VEC_NO_MEMORY,
+	/*A null context or buffer, or a negative count*/
+	VEC_BAD_ARGUMENT,
+	/*A divide by zero, which the command line reports as an error too*/
+	VEC_DIVIDE_BY_ZERO,
+	/*The vector can't hold that many elements, or a loaded buffer is full*/
+	VEC_TOO_LARGE,
+	/*Every snapshot a vector can have at once is held*/
+	VEC_BUSY
+};
+
+/*
+ * A vector and everything the library keeps with it. Its members are private;
+ * contexts are only handled through pointers. A context must not be used by
+ * two threads at once, but separate contexts are independent of each other.
+ * Once a context is shared, any thread can take snapshots of it while one
+ * thread uses it.
+ */
+struct VecContext;
+
+/*
+ * A version of a shared vector, which doesn't change while it is held. Taking
+ * one doesn't lock or copy anything, and the thread changing the vector never
+ * waits for it.
+ */
+struct VecSnapshot {
+
+	/*The elements, which can be read until the snapshot is released*/
+	const Elem *elements;
+	long size;
+	/*Different for every version, so readers can tell if the vector changed. It wraps after 16777216 changes*/
+	long epoch;
+	/*Private: the slot the snapshot is held with*/
+	int reader;
+};
+
+/*
+ * Makes a context with an empty vector
+ * return: The context, or null if it couldn't be allocated
+ */
+struct VecContext *vecalc_create(void);
+
+/*
+ * Frees a context and the memory of its vector. A buffer given to vecalc_load()
+ * is the caller's and isn't freed.
+ * param struct VecContext *: The context. Null is ignored
+ */
+void vecalc_destroy(struct VecContext *);
+
+/*
+ * The message for a status, for printing
+ * param enum VecStatus: The status
+ * return: A string that is never freed
+ */
+const char *vecalc_error(enum VecStatus);
+
+/*
+ * Adds a value to every element, like the + option
+ * param struct VecContext *: The context
+ * param Elem: The value
+ * return: VEC_OK, VEC_BAD_ARGUMENT for a null context, or VEC_NO_MEMORY if
+ * the context is shared and there is no memory for the new version
+ */
+enum VecStatus vecalc_plus(struct VecContext *, Elem);
+
+/*
+ * Subtracts a value from every element, like the - option
+ * param struct VecContext *: The context
+ * param Elem: The value
+ * return: VEC_OK, VEC_BAD_ARGUMENT for a null context, or VEC_NO_MEMORY if
+ * the context is shared and there is no memory for the new version
+ */
+enum VecStatus vecalc_minus(struct VecContext *, Elem);
+
+/*
+ * Multiplies every element by a value, like the * option
+ * param struct VecContext *: The context
+ * param Elem: The value
+ * return: VEC_OK, VEC_BAD_ARGUMENT for a null context, or VEC_NO_MEMORY if
+ * the context is shared and there is no memory for the new version
+ */
+enum VecStatus vecalc_mult(struct VecContext *, Elem);
+
+/*
+ * Divides every element by a value, like the / option
+ * param struct VecContext *: The context
+ * param Elem: The value
+ * return: VEC_OK, VEC_DIVIDE_BY_ZERO, VEC_BAD_ARGUMENT for a null context, or
+ * VEC_NO_MEMORY if the context is shared and there is no memory for the new
+ * version
+ */
+enum VecStatus vecalc_div(struct VecContext *, Elem);
+
+/*
+ * Sums the elements, like the m option
+ * param struct VecContext *: The context
+ * param Elem *: Set to the sum, which is 0 for an empty vector
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null context or result
+ */
+enum VecStatus vecalc_magnitude(struct VecContext *, Elem *);
+
+/*
+ * Appends elements, like the a option given many values
+ * param struct VecContext *: The context
+ * param const Elem *: The values, which are copied. Can be null if the count is 0
+ * param long: The number of values
+ * return: VEC_OK, VEC_NO_MEMORY, VEC_BAD_ARGUMENT, or VEC_TOO_LARGE if a
+ * loaded buffer doesn't have room for them or the vector would pass INT_MAX
+ * elements
+ */
+enum VecStatus vecalc_append(struct VecContext *, const Elem *, long);
+
+/*
+ * Empties the vector, like the c option. The context stops using a loaded
+ * buffer, and keeps any memory of its own for the next appends.
+ * param struct VecContext *: The context
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null context
+ */
+enum VecStatus vecalc_clear(struct VecContext *);
+
+/*
+ * Makes a buffer of the caller's the vector, without copying it. Operations
+ * change the buffer in place, and appends fill it up to its capacity. The
+ * buffer stays the caller's: it is never freed or reallocated, and must
+ * outlive its use by the context. The vector the context had is freed.
+ * param struct VecContext *: The context
+ * param Elem *: The buffer
+ * param long: The number of elements already in the buffer
+ * param long: The most elements the buffer can hold
+ * return: VEC_OK, VEC_BAD_ARGUMENT for a null argument or a context that
+ * vecalc_share() was called on, or VEC_TOO_LARGE if the size is more than the
+ * capacity or INT_MAX
+ */
+enum VecStatus vecalc_load(struct VecContext *, Elem *, long, long);
+
+/*
+ * Copies the vector into a buffer of the caller's. Nothing is copied if the
+ * buffer is the one that was loaded
+ * param struct VecContext *: The context
+ * param Elem *: The buffer
+ * param long: The most elements the buffer can hold
+ * param long *: Set to the number of elements in the vector
+ * return: VEC_OK, VEC_BAD_ARGUMENT, or VEC_TOO_LARGE if the buffer is too
+ * small, in which case nothing is copied
+ */
+enum VecStatus vecalc_store(struct VecContext *, Elem *, long, long *);
+
+/*
+ * Gives the elements of the vector without copying them
+ * param struct VecContext *: The context
+ * param const Elem **: Set to the elements, which are valid until the next
+ * call that changes the size of the vector, or any change once it is shared
+ * param long *: Set to the number of elements
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument
+ */
+enum VecStatus vecalc_view(struct VecContext *, const Elem **, long *);
+
+/*
+ * Lets other threads take snapshots of the vector while the thread that owns
+ * the context keeps changing it. Call it before those threads start. From then
+ * on every change makes a new version: + - * and / write into memory no
+ * snapshot holds, and vecalc_view() gives elements that are valid until the
+ * next change. vecalc_load() can't be used on a shared context.
+ * param struct VecContext *: The context, which can't have a loaded buffer
+ * return: VEC_OK, VEC_NO_MEMORY, or VEC_BAD_ARGUMENT for a null context or
+ * one with a loaded buffer
+ */
+enum VecStatus vecalc_share(struct VecContext *);
+
+/*
+ * Takes a snapshot of a shared vector, from any thread, without locking. Each
+ * snapshot has to be released, and all of them before the context is destroyed
+ * param struct VecContext *: The context
+ * param struct VecSnapshot *: Filled with the snapshot
+ * return: VEC_OK, VEC_BUSY if 16 snapshots are held already, or
+ * VEC_BAD_ARGUMENT for a null argument or a context that isn't shared
+ */
+enum VecStatus vecalc_snapshot(struct VecContext *, struct VecSnapshot *);
+
+/*
+ * Lets go of a snapshot, so its memory can be reused
+ * param struct VecContext *: The context it was taken of
+ * param struct VecSnapshot *: The snapshot
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument or a snapshot that
+ * isn't held
+ */
+enum VecStatus vecalc_release(struct VecContext *, struct VecSnapshot *);
+
+/*
+ * Sums the elements of a snapshot, the way the m option sums the vector
+ * param const struct VecSnapshot *: The snapshot
+ * param Elem *: Set to the sum
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument or a snapshot that
+ * isn't held
+ */
+enum VecStatus vecalc_snapshot_magnitude(const struct VecSnapshot *, Elem *);
+
+#endif /*_VECTORLIB_H_*/
@@ -9,6 +9,9 @@
 #ifndef _VECTORMEM_H_
 #define _VECTORMEM_H_
 
+/*Standard Headers*/
+#include <stddef.h> /*For size_t*/
+
 /*Local Headers*/
 #include "vecalc.h" /*For definition of Vector*/
 
@@ -24,7 +27,8 @@ struct Vector *alloc_vec();
 void dealloc_vec(struct Vector *);
 
 /*
- * Extend an existing vecotr by 1 element
+ * Extend an existing vecotr by 1 element. A sparse or packed vector stays
+ * sparse or packed
  * param vector: The vector to be extened
  * param Elem: The value placed in the new spot
  * return: A vector (separate from the original) that is one element larger
@@ -34,6 +38,52 @@ void dealloc_vec(struct Vector *);
  */
 struct Vector *extend_vec(struct Vector *, Elem);
 
+/*
+ * Extend an existing vector by many elements at once, in place. A sparse or
+ * packed vector stays sparse or packed
+ * param vector: The vector to be extended
+ * param Elem *: The values placed in the new spots, in order
+ * param int: The number of values
+ * return: The same vector, now count elements larger
+ * precond: input vector is not null and the new size is at most MAXVECSIZE
+ */
+struct Vector *append_vec(struct Vector *, Elem *, int);
+
+/*
+ * Make a copy of a vector
+ * param vector: The vector to copy
+ * return: A new dense vector with the same elements, which must be freed
+ * separately
+ * precond: input vector is not null
+ */
+struct Vector *copy_vec(struct Vector *);
+
+/*
+ * Marks a vector's elements as mapped from a file, as a restored snapshot's
+ * are, so that free_elements() unmaps them. Only one mapping is kept track of
+ * param void *: The start of the mapping
+ * param size_t: Its length in bytes
+ * param Elem *: The elements, somewhere in the mapping
+ */
+void map_elements(void *, size_t, Elem *);
+
+/*
+ * Frees the elements of a vector, whether they were allocated or mapped.
+ * Anything that replaces a vector's elements frees them with this
+ * param Elem *: The elements. Null is ignored
+ */
+void free_elements(Elem *);
+
+/*
+ * Resizes the elements of a vector, as realloc() does. Mapped elements are
+ * copied into memory of their own, and unmapped
+ * param Elem *: The elements
+ * param long: The number of elements in them now
+ * param long: The number of elements there needs to be room for
+ * return: The elements, or null if there wasn't memory
+ */
+Elem *resize_elements(Elem *, long, long);
+
 /*
  * Checks malloc calls to make sure the succeeded
  * param void *: The newly allocated pointer
@@ -8,11 +8,32 @@
  */
 
 #ifndef _VECTOROPS_H_
-#define _VECTOROPS_H
+#define _VECTOROPS_H_
 
 /*Local Headers*/
 #include "vecalc.h"
 
+/*How an operation is applied to every element*/
+enum Path {
+
+	PATH_AUTO,	/*Whichever is fastest for the size, from the tuning*/
+	PATH_SCALAR,
+	PATH_SIMD,
+	PATH_THREADS
+};
+
+/*
+ * Applies an operation to every element of a vector, with a scalar loop, SIMD
+ * or threads. Every path gives the same result. The scalar operations call
+ * it for dense vectors, and sparse_sweep() and packed_sweep() for the others
+ * param struct Vector *: The vector
+ * param char: +, -, * or /
+ * param Elem: The value of the operation
+ * param enum Path: The path to take, or PATH_AUTO
+ * precond: The vector is dense
+ */
+void sweep(struct Vector *, char, Elem, enum Path);
+
 /*
  * Adds a chosen value to each element of the vector
  * param vector: the vector whose elements will be added on to
@@ -0,0 +1,39 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorOpt.h						//
+ * Synopsis	:	Removes redundant work from a list of commands before	//
+ * 			it is run						//
+ *==============================================================================//
+ */
+
+#ifndef _VECTOROPT_H_
+#define _VECTOROPT_H_
+
+/*Standard Headers*/
+#include <stdio.h>
+
+/*Local Headers*/
+#include "vectorCmd.h" /*For definition of a Command*/
+
+/*
+ * Peephole optimizer for a line of commands. Neighbouring * and / that scale
+ * by powers of two of at least one are folded into a single command, commands
+ * with no effect (- 0, * 1, etc.) are dropped, changes to the elements whose
+ * result is thrown away by a following c, q or e are dropped (options that
+ * change the session, like f, are always kept), and a repeated m with nothing
+ * changing the vector in between re-uses the earlier result.
+ * The optimized line prints exactly what the line would have, bit for bit.
+ * Nothing is folded unless the folded command gives the same bits, and nothing
+ * that could print a diagnostic is dropped or folded. The size of the vector
+ * isn't known at the start of the line, so that is only once an a or c in the
+ * line shows it can't be empty or full.
+ * param struct Command *: The list of commands. It is optimized in place
+ * param int: The number of commands in the list
+ * param FILE *: If not null, a line is printed here for every command that was
+ * eliminated or changed
+ * return: The number of commands left in the list
+ */
+int optimizeCommands(struct Command *, int, FILE *);
+
+#endif /*_VECTOROPT_H_*/
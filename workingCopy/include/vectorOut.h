@@ -1,8 +1,53 @@
 #ifndef _VECTOROUT_H_
 #define _VECTOROUT_H_
 
+/*Standard Headers*/
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 /*Local Headers*/
 #include "vecalc.h" /*For definition of a Vector*/
+#include "vectorDiff.h" /*For definition of a DiffResult*/
+#include "vectorStats.h" /*For definition of Stats*/
+#include "vectorPack.h" /*For definition of a PackReport*/
+
+/*
+ * The formats results can be printed in. The numbers are the values given to
+ * the f option.
+ */
+enum Format {
+
+	FORMAT_TEXT = 0,	/*One "%f" per line, as vecalc always has*/
+	FORMAT_CSV = 1,		/*An index,value header and one row per element*/
+	FORMAT_JSON = 2,	/*A JSON array, or an object for a query*/
+	FORMAT_BINARY = 3	/*A BinaryFrame followed by the raw elements*/
+};
+
+/*
+ * Header written before the raw elements in the binary format, in the byte
+ * order of the host. kind is 'p' for a vector or 'm' for a magnitude, and
+ * count Elems follow the header. For 'x' a checksum, 'd' a comparison, 'i'
+ * statistics and 'z' storage, count 8 byte fields follow instead, least
+ * significant byte first: whole numbers as int64 and the rest as doubles. The
+ * layout of each is in programmerDocs.txt.
+ */
+struct BinaryFrame {
+
+	uint8_t kind;
+	uint8_t reserved[3];
+	uint32_t count;
+};
+
+/*Size of the buffer that a vector is formatted into before it is written*/
+#define PRINT_BUFFER_SIZE 65536
+
+/*
+ * The longest an element can be once formatted with "%f". FLT_MAX has 39
+ * digits, plus a sign and the decimal places.
+ */
+#define FORMAT_MAX_LENGTH 64
 
 /*
  * Print the vector to stdout
@@ -13,9 +58,135 @@
 bool print_vec(struct Vector *);
 
 /*
- * Prints a help page for usage of vecalc to a file in the CWD
+ * Print the vector to a stream, one element per line
+ * param FILE *: Where the elements are printed
+ * param vector: pointer to vector to be printed
+ * return: True if it can be printed, false otherwise
+ * precond: input vector is not null
+ */
+bool fprint_vec(FILE *, struct Vector *);
+
+/*
+ * Print the vector to a stream in one of the output formats. Every format is
+ * written in pieces of at most PRINT_BUFFER_SIZE, however large the vector.
+ * param FILE *: Where the elements are printed
+ * param struct Vector *: pointer to vector to be printed
+ * param enum Format: The format to print in
+ * return: True if it can be printed, false otherwise
+ * precond: input vector is not null
+ */
+bool fprint_vec_as(FILE *, struct Vector *, enum Format);
+
+/*
+ * Print part of the vector to a stream in one of the output formats. Only the
+ * elements that are printed are read, so printing a few elements of a large
+ * vector costs the same as printing them from a small one.
+ * param FILE *: Where the elements are printed
+ * param struct Vector *: pointer to vector to be printed
+ * param int: Index of the first element to print
+ * param int: Index one past the last element that may be printed
+ * param int: The distance between printed elements
+ * param enum Format: The format to print in
+ * return: True if it can be printed, false otherwise
+ * precond: input vector is not null, 0 <= first, last <= size of the vector
+ * and step > 0
+ */
+bool fprint_range(FILE *, struct Vector *, int, int, int, enum Format);
+
+/*
+ * Print part of a vector, like fprint_range(), from a buffer that holds only
+ * the elements from first up to last. Sparse and packed vectors are printed
+ * this way, so only the part that is printed is decoded.
+ * param FILE *: Where the elements are printed
+ * param Elem *: The elements, the one at index first in the vector first
+ * param int: Index in the vector of the first element to print
+ * param int: Index one past the last element that may be printed
+ * param int: The distance between printed elements
+ * param enum Format: The format to print in
+ * return: True if it can be printed, false otherwise
+ * precond: 0 <= first and step > 0
+ */
+bool fprint_window(FILE *, Elem *, int, int, int, enum Format);
+
+/*
+ * Print the result of a magnitude query in one of the output formats
+ * param FILE *: Where the magnitude is printed
+ * param Elem: The magnitude
+ * param enum Format: The format to print in
+ */
+void fprint_magnitude(FILE *, Elem, enum Format);
+
+/*
+ * Print a checksum or fingerprint in one of the output formats
+ * param FILE *: Where the checksum is printed
+ * param uint64_t: The checksum or fingerprint
+ * param const char *: "checksum" or "fingerprint"
+ * param enum Format: The format to print in
+ */
+void fprint_hash(FILE *, uint64_t, const char *, enum Format);
+
+/*
+ * Print how a vector is stored, how much memory it takes and the precision it
+ * keeps, in one of the output formats
+ * param FILE *: Where the report is printed
+ * param struct PackReport *: The report
+ * param enum Format: The format to print in
+ */
+void fprint_storage(FILE *, struct PackReport *, enum Format);
+
+/*
+ * Print the result of comparing the vector against a reference in one of the
+ * output formats
+ * param FILE *: Where the result is printed
+ * param struct DiffResult *: What the comparison found
+ * param int: The size of the vector
+ * param int: The size of the reference vector
+ * param enum Format: The format to print in
+ */
+void fprint_diff(FILE *, struct DiffResult *, int, int, enum Format);
+
+/*
+ * Print the count, median, 99th and 99.9th percentile and largest latency of
+ * every option that has been run, and the elements they touched, in one of the
+ * output formats
+ * param FILE *: Where the statistics are printed
+ * param struct Stats *: The statistics
+ * param enum Format: The format to print in
+ */
+void fprint_stats(FILE *, struct Stats *, enum Format);
+
+/*
+ * Looks up an output format by name
+ * param char *: The name of the format; text, csv, json or binary
+ * return: The format, or -1 if there is no format with that name
+ */
+int formatByName(char *);
+
+/*
+ * Formats an element exactly the same as printf's "%f" does, without going
+ * through printf for all but very large values, infinity and NaN
+ * param char *: Where the text is placed. It needs room for FORMAT_MAX_LENGTH
+ * characters
+ * param Elem: The element to format
+ * return: The number of characters placed in the buffer. No null terminator is
+ * added
+ */
+int formatElem(char *, Elem);
+
+/*
+ * Writes out formatted text, directly to the file descriptor behind the
+ * stream if it has one
+ * param FILE *: Where the text is written
+ * param char *: The text
+ * param size_t: The number of characters of text
+ */
+void writeOut(FILE *, char *, size_t);
+
+/*
+ * Prints a help page for usage of vecalc
+ * param FILE *: Where the help page is printed
  */
-void getHelp();
+void getHelp(FILE *);
 
 /*
  * Sums up all the values in the vector; Returns the magnitude and prints it to
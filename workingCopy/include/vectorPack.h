@@ -0,0 +1,130 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPack.h						//
+ * Synopsis	:	Vectors stored in compressed blocks, as 16 bit floats	//
+ * 			or losslessly, to fit more of them in memory		//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORPACK_H_
+#define _VECTORPACK_H_
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Vector*/
+
+/*Elements in each block. Only the last block of a vector can have fewer*/
+#define PACK_BLOCK 1024
+
+/*
+ * How the elements of a vector are stored. The numbers are the values given to
+ * the z option.
+ */
+enum Storage {
+
+	STORAGE_FLOAT = 0,	/*An Elem each, which is not packed*/
+	STORAGE_BF16 = 1,	/*The top 16 bits of each Elem, rounded: 8 bits of precision*/
+	STORAGE_FP16 = 2,	/*IEEE half precision: 11 bits of precision, up to 65504*/
+	STORAGE_XOR = 3		/*Each Elem XORed with the one before, without the zero bits*/
+};
+
+/*
+ * The blocks of a packed vector. The Vector's elements are null while it is
+ * packed. Every block is decoded into PACK_BLOCK Elems to be read or changed,
+ * and encoded again after a change, so a lossy vector is rounded after every
+ * operation, as if its elements were 16 bit floats.
+ */
+struct Packed {
+
+	enum Storage storage;
+	int count;			/*Blocks in the vector*/
+	int capacity;			/*Blocks there is room for*/
+	unsigned char **blocks;		/*The encoded blocks*/
+	int *bytes;			/*The length of each block*/
+};
+
+/*What packing a vector cost in precision, and saved in memory*/
+struct PackReport {
+
+	enum Storage storage;
+	long elements;
+	long bytes;		/*Memory the elements take, with the list of blocks*/
+	int bits;		/*Bits of precision each element keeps*/
+	double maxError;	/*Largest change relative to an element, for those that stayed finite*/
+	long overflows;		/*Finite elements that became infinite*/
+	long underflows;	/*Elements that weren't 0 and became 0*/
+};
+
+/*
+ * Stores a vector in a storage, from whatever form it is in now. STORAGE_FLOAT
+ * makes it dense again.
+ * param struct Vector *: The vector
+ * param enum Storage: The storage
+ * param struct PackReport *: Filled with what it cost and saved. Can be null
+ */
+void pack_vec(struct Vector *, enum Storage, struct PackReport *);
+
+/*
+ * Makes a packed vector dense. A vector that isn't packed is left alone
+ * param struct Vector *: The vector
+ */
+void unpack_vec(struct Vector *);
+
+/*
+ * Rounds an element the way a storage keeps it
+ * param enum Storage: The storage
+ * param Elem: The element
+ * return: The element as it is after being packed and unpacked
+ */
+Elem storage_round(enum Storage, Elem);
+
+/*
+ * Writes out the elements of a packed vector from first up to last, decoding
+ * only the blocks that hold them
+ * param struct Vector *: The packed vector
+ * param int: Index of the first element
+ * param int: Index one past the last element
+ * param Elem *: Filled with the elements, the first one at index 0
+ * precond: 0 <= first <= last <= size of the vector
+ */
+void packed_fill(struct Vector *, int, int, Elem *);
+
+/*
+ * Applies an operation to a packed vector, one decoded block at a time with
+ * the scalar or SIMD loop
+ * param struct Vector *: The packed vector
+ * param char: +, -, * or /
+ * param Elem: The value of the operation
+ */
+void packed_sweep(struct Vector *, char, Elem);
+
+/*
+ * Sums a packed vector in order, which gives the same sum as the dense vector
+ * of its elements
+ * param struct Vector *: The packed vector
+ * return: The sum
+ */
+Elem packed_magnitude(struct Vector *);
+
+/*
+ * Appends elements to a packed vector, filling up its last block first
+ * param struct Vector *: The packed vector
+ * param Elem *: The values
+ * param int: The number of values
+ */
+void packed_append(struct Vector *, Elem *, int);
+
+/*
+ * Copies the blocks of a packed vector
+ * param struct Vector *: The packed vector
+ * return: A copy of its blocks, which the copy of the vector owns
+ */
+struct Packed *packed_copy(struct Vector *);
+
+/*
+ * Frees the blocks of a packed vector
+ * param struct Packed *: The blocks. Null is ignored
+ */
+void packed_free(struct Packed *);
+
+#endif /*_VECTORPACK_H_*/
@@ -0,0 +1,40 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPipe.h						//
+ * Synopsis	:	Pipelined input, where lines are read and parsed on one	//
+ * 			thread while commands are run on another		//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORPIPE_H_
+#define _VECTORPIPE_H_
+
+/*Standard Headers*/
+#include <stdio.h>
+
+/*Local Headers*/
+#include "vectorCmd.h" /*For definition of a Session*/
+#include "vectorIn.h" /*For definition of Flags*/
+
+/*
+ * Number of parsed commands that can be waiting to run. Once the ring is full
+ * the reader waits for the commands to catch up.
+ */
+#define PIPE_RING_SIZE 4096
+
+/*
+ * Reads lines from a stream on a separate thread and runs them against a
+ * session as they are parsed. Commands run in exactly the same order as they
+ * would without the pipeline. Input ends at a q or e, at the end of the stream,
+ * or at a blank line when the stream isn't a terminal.
+ * param struct Session *: The session to run the commands against
+ * param FILE *: The stream to read lines from
+ * param char *[]: The options vecalc was run with, which are run first
+ * param int: The number of options vecalc was run with, including argv[0]
+ * param struct Flags *: Settings that apply to running the commands
+ * return: EXIT_SUCCESS
+ */
+int pipelineIn(struct Session *, FILE *, char *[], int, struct Flags *);
+
+#endif /*_VECTORPIPE_H_*/
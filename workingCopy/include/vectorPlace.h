@@ -0,0 +1,98 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPlace.h						//
+ * Synopsis	:	Which NUMA node the elements of large vectors are put	//
+ * 			on, and which CPUs the threads that sweep them run on	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORPLACE_H_
+#define _VECTORPLACE_H_
+
+/*Standard Headers*/
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Elem*/
+
+/*Most nodes and CPUs the topology is read for*/
+#define PLACE_MAX_NODES 64
+#define PLACE_MAX_CPUS 1024
+
+/*
+ * Where the pages of a vector go. A page is put on the node of the thread that
+ * first writes it, unless it is interleaved.
+ */
+enum Placement {
+
+	PLACE_LOCAL = 0,	/*Wherever the thread copying the vector runs, and threads aren't pinned*/
+	PLACE_INTERLEAVE = 1,	/*Round robin over every node, and threads are pinned*/
+	PLACE_CHUNK = 2		/*Each part of the vector on the node of the pinned thread that sweeps it*/
+};
+
+/*
+ * The nodes of the host and the CPUs on each. A host without NUMA, or that
+ * doesn't say, is one node with every CPU.
+ */
+struct Topology {
+
+	int nodes;
+	int nodeIds[PLACE_MAX_NODES];	/*The number of each node, which can have gaps*/
+	int cpuCount;			/*CPUs this process can run on, over every node*/
+	int cpus[PLACE_MAX_CPUS];	/*The CPUs, those on the first node first*/
+	int nodeOf[PLACE_MAX_CPUS];	/*The node of each CPU in cpus*/
+};
+
+/*
+ * The topology of the host, which is read the first time it is asked for
+ * return: The topology. It is never freed
+ */
+const struct Topology *topology(void);
+
+/*
+ * Looks up a placement by the name it is given on the command line and in the
+ * profile
+ * param const char *: local, interleave or chunk
+ * return: The placement, or -1 if there isn't one by that name
+ */
+int placementByName(const char *);
+
+/*
+ * The name of a placement
+ * param enum Placement: The placement
+ * return: local, interleave or chunk
+ */
+const char *placementName(enum Placement);
+
+/*
+ * The number of parts a threaded sweep is split into
+ * return: The number of threads in tuning, at least 2 and at most
+ * TUNE_MAX_THREADS
+ */
+int place_parts(void);
+
+/*
+ * Starts a thread for one part of some work split into parts. Unless the
+ * placement is local it is pinned to a CPU, and consecutive parts go to CPUs
+ * on the same node
+ * param pthread_t *: Filled with the thread
+ * param void *(*)(void *): What the thread runs
+ * param void *: The argument it is given
+ * param int: The part
+ * param int: The number of parts
+ * return: 0, or the error from pthread_create()
+ */
+int place_thread(pthread_t *, void *(*)(void *), void *, int, int);
+
+/*
+ * Copies elements into a new buffer that no one has written to yet, putting
+ * its pages where the placement says. With chunk, a buffer the sweeps split
+ * over threads is copied by the same parts on the same CPUs
+ * param Elem *: The new buffer
+ * param Elem *: The elements copied into it
+ * param long: The number of elements
+ */
+void place_copy(Elem *, Elem *, long);
+
+#endif /*_VECTORPLACE_H_*/
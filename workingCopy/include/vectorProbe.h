@@ -0,0 +1,91 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorProbe.h						//
+ * Synopsis	:	Static tracepoints that perf and bpftrace can attach	//
+ * 			to a running vecalc					//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORPROBE_H_
+#define _VECTORPROBE_H_
+
+/*
+ * Each probe is a single nop in the code, and a note in the .note.stapsdt
+ * section of the executable that says where the nop is, what the probe is
+ * called and where its arguments are. This is the same layout SystemTap's
+ * sys/sdt.h writes, so perf, bpftrace and anything else that reads USDT
+ * probes can find them, but it needs nothing outside this header to build.
+ * Until a tracer replaces the nop with a breakpoint, a probe costs the nop and
+ * keeping its arguments where the note says they are.
+ *
+ * Every probe belongs to the provider "vecalc", and every argument is passed
+ * as a signed 8 byte number. Build with -DVEC_NO_PROBES to leave them out.
+ *
+ * vecalc:command_start(option, size)	Before a command runs
+ * vecalc:command_end(option, size)	After it runs. size is the vector's size
+ * 					before and after
+ * vecalc:kernel_entry(option, size)	When an operation on every element of
+ * vecalc:kernel_exit(option, size)	the vector starts and finishes
+ * vecalc:vector_grow(from, to)		When extend_vec() or append_vec() grow a
+ * 					vector
+ * vecalc:vector_sparse(size, count)	When a vector is made sparse, and made
+ * vecalc:vector_dense(size, count)	dense again. count is the number of
+ * 					elements listed
+ * vecalc:line_read(line, length)	When a line of input has been read.
+ * 					length is the number of options for
+ * 					the prompt, and characters otherwise
+ */
+
+#if !defined(VEC_NO_PROBES) && defined(__GNUC__) && (defined(__x86_64__) || defined(__aarch64__))
+
+/*The note, and a base symbol that tracers use to find where the code moved to*/
+#define VEC_PROBE_ASM(name, args)						\
+	"990:	nop\n"								\
+	".pushsection .note.stapsdt,\"?\",\"note\"\n"			\
+	".balign 4\n"								\
+	".4byte 992f-991f, 994f-993f, 3\n"					\
+	"991:	.asciz \"stapsdt\"\n"						\
+	"992:	.balign 4\n"							\
+	"993:	.8byte 990b\n"							\
+	".8byte _.stapsdt.base\n"						\
+	".8byte 0\n"								\
+	".asciz \"vecalc\"\n"							\
+	".asciz \"" #name "\"\n"						\
+	".asciz \"" args "\"\n"							\
+	"994:	.balign 4\n"							\
+	".popsection\n"								\
+	".ifndef _.stapsdt.base\n"						\
+	".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"	\
+	".weak _.stapsdt.base\n"						\
+	".hidden _.stapsdt.base\n"						\
+	"_.stapsdt.base: .space 1\n"						\
+	".size _.stapsdt.base, 1\n"						\
+	".popsection\n"								\
+	".endif\n"
+
+#define VEC_PROBE0(name)							\
+	__asm__ __volatile__(VEC_PROBE_ASM(name, ""))
+
+#define VEC_PROBE1(name, a)							\
+	__asm__ __volatile__(VEC_PROBE_ASM(name, "-8@%0")			\
+		: : "nor"((long)(a)))
+
+#define VEC_PROBE2(name, a, b)							\
+	__asm__ __volatile__(VEC_PROBE_ASM(name, "-8@%0 -8@%1")		\
+		: : "nor"((long)(a)), "nor"((long)(b)))
+
+#define VEC_PROBE3(name, a, b, c)						\
+	__asm__ __volatile__(VEC_PROBE_ASM(name, "-8@%0 -8@%1 -8@%2")	\
+		: : "nor"((long)(a)), "nor"((long)(b)), "nor"((long)(c)))
+
+#else
+
+#define VEC_PROBE0(name)
+#define VEC_PROBE1(name, a)
+#define VEC_PROBE2(name, a, b)
+#define VEC_PROBE3(name, a, b, c)
+
+#endif
+
+#endif /*_VECTORPROBE_H_*/
@@ -0,0 +1,30 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorRun.h						//
+ * Synopsis	:	Runs many independent scripts at once, each with its	//
+ * 			own vector						//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORRUN_H_
+#define _VECTORRUN_H_
+
+/*Local Headers*/
+#include "vectorIn.h" /*For definition of Flags*/
+
+/*
+ * Runs every script as if it was redirected into its own vecalc, spread over
+ * a pool of worker threads. Each script has its own vector, and its output is
+ * collected separately and written to stdout (errors to stderr) in the same
+ * order as the scripts were given, no matter which one finishes first.
+ * param char *[]: The paths of the scripts
+ * param int: The number of scripts. If it is zero, the paths are read from
+ * stdin, one per line
+ * param int: The number of worker threads
+ * param struct Flags *: Settings that apply to every script
+ * return: EXIT_SUCCESS if every script could be opened, EXIT_FAILURE otherwise
+ */
+int runScripts(char *[], int, int, struct Flags *);
+
+#endif /*_VECTORRUN_H_*/
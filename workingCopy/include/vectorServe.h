@@ -0,0 +1,29 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorServe.h						//
+ * Synopsis	:	Runs vecalc as a server on a Unix domain socket, with	//
+ * 			a separate session for every connection			//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORSERVE_H_
+#define _VECTORSERVE_H_
+
+/*Local Headers*/
+#include "vectorIn.h" /*For definition of Flags*/
+
+/*
+ * Listens on a Unix domain socket and runs the lines sent on each connection
+ * against that connection's own session. Results and errors are sent back on
+ * the connection. A connection's session ends with q, e or a blank line, or
+ * when the client closes it. Runs until the process gets SIGINT or SIGTERM.
+ * param char *: The path of the socket. Any existing file there is replaced
+ * param int: The number of worker threads that run commands
+ * param struct Flags *: Settings that apply to every session
+ * return: EXIT_SUCCESS once the server is stopped, EXIT_FAILURE if it could not
+ * be started
+ */
+int serve(char *, int, struct Flags *);
+
+#endif /*_VECTORSERVE_H_*/
@@ -0,0 +1,99 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorSnap.h						//
+ * Synopsis	:	Snapshots of a session written to a file that a new	//
+ * 			vecalc maps back in, to carry on where it left off	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORSNAP_H_
+#define _VECTORSNAP_H_
+
+/*Standard Headers*/
+#include <stdbool.h>
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vectorCmd.h" /*For definition of Session*/
+
+/*Where snapshots are written if vecalc isn't given --snapshot*/
+#define SNAP_DEFAULT_NAME "vecalc.snap"
+
+/*The first bytes of every snapshot, and the version of the layout after them*/
+#define SNAP_MAGIC "vecsnap"
+#define SNAP_VERSION 1
+
+/*Written as a number, so a host with another byte order reads it differently*/
+#define SNAP_ORDER 0x01020304
+
+/*
+ * Bytes the header is padded to. The elements start here, so once the file is
+ * mapped they are page aligned, as the SIMD kernels like them.
+ */
+#define SNAP_HEADER_BYTES 4096
+
+/*The form the vector was in when the snapshot was taken*/
+enum SnapForm {
+
+	SNAP_DENSE = 0,
+	SNAP_SPARSE = 1,
+	SNAP_PACKED = 2
+};
+
+/*
+ * The start of a snapshot. The elements follow it, dense whatever form the
+ * vector was in, and then the last line, without a null. Numbers are in the
+ * byte order of the host that wrote them, and a snapshot from a host with
+ * another order or another Elem is refused.
+ */
+struct SnapHeader {
+
+	char magic[8];		/*SNAP_MAGIC*/
+	uint32_t version;	/*SNAP_VERSION*/
+	uint32_t elemBytes;	/*sizeof(Elem) where it was written*/
+	uint32_t order;		/*SNAP_ORDER*/
+	uint32_t form;		/*An enum SnapForm*/
+	uint32_t storage;	/*The session's storage, which a packed vector is stored in*/
+	uint32_t format;	/*The session's format*/
+	uint64_t size;		/*Elements in the vector*/
+	uint64_t line;		/*The number of the last input line*/
+	uint64_t lineBytes;	/*Length of the last line, or 0 without one*/
+};
+
+/*
+ * Writes a snapshot of a session's vector, storage, format and last line. It
+ * is written next to the path and renamed over it once it is on disk, so the
+ * path always holds a whole snapshot, even one that is mapped by a vecalc
+ * that restored it.
+ * param struct Session *: The session
+ * param const char *: The path of the snapshot
+ * param long: The number of the last input line that has run. With the
+ * pipeline, the session's line is the one being parsed, which is ahead of it
+ * return: false if it couldn't be written, with errno set
+ */
+bool snapshot_write(struct Session *, const char *, long);
+
+/*
+ * Restores a session from a snapshot. The file is mapped copy on write and
+ * the vector's elements are left in the mapping, so restoring takes the same
+ * time however large the vector is. A page is only read in when it is first
+ * used, and only copied when it is first changed. A vector that was packed is
+ * packed again, which does read it all; one that was sparse comes back dense,
+ * which gives the same results, until it is next made sparse.
+ * param struct Session *: The session, whose vector is replaced
+ * param const char *: The path of the snapshot
+ * return: false if the snapshot couldn't be read or isn't one this vecalc can
+ * restore, which leaves the session as it was
+ */
+bool snapshot_restore(struct Session *, const char *);
+
+/*
+ * Takes a periodic snapshot if one is due. They are taken after every
+ * snapshotEvery lines, to the session's snapshotPath
+ * param struct Session *: The session
+ * param long: The line that has just finished running
+ */
+void snapshot_due(struct Session *, long);
+
+#endif /*_VECTORSNAP_H_*/
@@ -0,0 +1,124 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorSparse.h						//
+ * Synopsis	:	Vectors kept as the few elements that differ from a	//
+ * 			background value, and switching to and from them	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORSPARSE_H_
+#define _VECTORSPARSE_H_
+
+/*Standard Headers*/
+#include <stdbool.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of Vector*/
+
+/*Vectors shorter than this are always dense*/
+#define SPARSE_MIN_SIZE 1024
+
+/*
+ * A vector is made sparse once no more than 1 in SPARSE_DENSITY of its
+ * elements differ from the background, and dense again once more than 1 in
+ * DENSE_DENSITY do. The gap between the two keeps a vector near the threshold
+ * from switching back and forth.
+ */
+#define SPARSE_DENSITY 8
+#define DENSE_DENSITY 4
+
+/*
+ * Every element of a sparse vector that isn't listed is the background. The
+ * background starts as 0, and + and - move it along with the listed values, so
+ * they don't make the vector dense. Elements are the background only if they
+ * have the same bits: -0 is listed when the background is 0.
+ */
+struct Sparse {
+
+	int count;		/*Elements listed*/
+	int capacity;		/*Elements there is room to list*/
+	int *indices;		/*Where each listed element is, in increasing order*/
+	Elem *values;		/*The listed elements*/
+	Elem background;	/*Every other element*/
+};
+
+/*
+ * Makes a dense vector sparse, if it is at least SPARSE_MIN_SIZE long and
+ * sparse enough. A packed vector is never made sparse
+ * param struct Vector *: The vector
+ * return: true if the vector is sparse
+ */
+bool sparsify(struct Vector *);
+
+/*
+ * Makes a sparse vector dense. A dense vector is left alone
+ * param struct Vector *: The vector
+ */
+void densify(struct Vector *);
+
+/*
+ * Writes out the elements of a sparse vector from first up to last
+ * param struct Vector *: The sparse vector
+ * param int: Index of the first element
+ * param int: Index one past the last element
+ * param Elem *: Filled with the elements, the first one at index 0
+ * precond: 0 <= first <= last <= size of the vector
+ */
+void sparse_fill(struct Vector *, int, int, Elem *);
+
+/*
+ * Switches a vector to the form that suits it after an option changed it.
+ * Checking if a sparse vector has become too dense is free, so it is always
+ * done; a dense vector is only scanned after * 0, and when appending makes its
+ * size a power of two, so scanning costs appends a constant factor. A packed
+ * vector is left as it is
+ * param struct Vector *: The vector
+ * param char: The option that changed it
+ * param Elem: The value of the option
+ */
+void settle_vec(struct Vector *, char, Elem);
+
+/*
+ * Applies an operation to a sparse vector, touching only the background and
+ * the listed elements. Results are the same as on the dense vector, bit for
+ * bit. Listed elements that become the background stop being listed.
+ * param struct Vector *: The sparse vector
+ * param char: +, -, * or /
+ * param Elem: The value of the operation
+ */
+void sparse_sweep(struct Vector *, char, Elem);
+
+/*
+ * Sums a sparse vector in the order magnitude() adds up the dense vector, so
+ * the sum is the same bit for bit. With a background of 0 only the listed
+ * elements are added; any other background is added in for each element that
+ * is the background, which takes as long as the dense sum.
+ * param struct Vector *: The sparse vector
+ * return: The sum
+ */
+Elem sparse_magnitude(struct Vector *);
+
+/*
+ * Appends elements to a sparse vector, in place. Only those that aren't the
+ * background are listed.
+ * param struct Vector *: The sparse vector
+ * param Elem *: The values
+ * param int: The number of values
+ */
+void sparse_append(struct Vector *, Elem *, int);
+
+/*
+ * Copies the sparse form of a vector
+ * param struct Vector *: The sparse vector
+ * return: A copy of its sparse form, which the copy of the vector owns
+ */
+struct Sparse *sparse_copy(struct Vector *);
+
+/*
+ * Frees the sparse form of a vector
+ * param struct Sparse *: The sparse form. Null is ignored
+ */
+void sparse_free(struct Sparse *);
+
+#endif /*_VECTORSPARSE_H_*/
@@ -0,0 +1,85 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorStats.h						//
+ * Synopsis	:	Latency histograms of the commands a session runs	//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORSTATS_H_
+#define _VECTORSTATS_H_
+
+/*Standard Headers*/
+#include <stdint.h>
+
+/*
+ * Every power of two is split into this many buckets, so a latency is known to
+ * within 1/16th of itself
+ */
+#define STATS_SUB_BITS 4
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BITS)
+
+/*Enough buckets for any 64 bit latency*/
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1)*STATS_SUB_BUCKETS)
+
+/*One histogram for each option character*/
+#define STATS_OPTIONS 128
+
+/*The unit latencies are measured in*/
+#if defined(__x86_64__) || defined(__i386__)
+#define STATS_UNIT "cycles"
+#else
+#define STATS_UNIT "ns"
+#endif
+
+/*
+ * The latencies of one option, in buckets whose width grows with the latency
+ * like an HDR histogram
+ */
+struct Histogram {
+
+	long count;
+	uint64_t max;
+	/*Elements in the vector when each command ran, added up*/
+	uint64_t elements;
+	long buckets[STATS_BUCKETS];
+};
+
+/*Histograms of the options a session has run, allocated as they are first run*/
+struct Stats {
+
+	struct Histogram *options[STATS_OPTIONS];
+};
+
+/*
+ * Reads the cycle counter, or the monotonic clock in nanoseconds where there is
+ * no cycle counter
+ * return: The time in STATS_UNIT
+ */
+uint64_t statsClock(void);
+
+/*
+ * Counts one command in the histogram of its option
+ * param struct Stats *: The statistics
+ * param char: The option
+ * param uint64_t: How long the command took, in STATS_UNIT
+ * param long: The elements in the vector when it ran
+ */
+void statsRecord(struct Stats *, char, uint64_t, long);
+
+/*
+ * The latency that a fraction of the commands in a histogram took no longer
+ * than, to within the width of its bucket
+ * param struct Histogram *: The histogram
+ * param double: The fraction, from 0 to 1
+ * return: The latency in STATS_UNIT
+ */
+uint64_t statsPercentile(struct Histogram *, double);
+
+/*
+ * Frees the histograms held by statistics
+ * param struct Stats *: The statistics, which are not freed themselves
+ */
+void free_stats(struct Stats *);
+
+#endif /*_VECTORSTATS_H_*/
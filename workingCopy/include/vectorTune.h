@@ -0,0 +1,75 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorTune.h						//
+ * Synopsis	:	Sizes at which the kernels switch from scalar loops to	//
+ * 			SIMD and to threads, measured on the host		//
+ *==============================================================================//
+ */
+
+#ifndef _VECTORTUNE_H_
+#define _VECTORTUNE_H_
+
+/*Standard Headers*/
+#include <stdio.h>
+#include <stdbool.h>
+
+/*A threshold that is never reached, so that path is never taken*/
+#define TUNE_NEVER 0
+
+/*
+ * Defaults for a host without a profile. SIMD gives the same results as the
+ * scalar loop and is faster on anything but the shortest vectors; threads are
+ * only worth it once it is known that they are.
+ */
+#define TUNE_DEFAULT_SIMD_MIN 64
+#define TUNE_DEFAULT_THREAD_MIN TUNE_NEVER
+
+/*Most threads a kernel is split over*/
+#define TUNE_MAX_THREADS 16
+
+/*The profile, in the home directory, unless VECALC_PROFILE names another*/
+#define TUNE_PROFILE_NAME ".vecalcProfile"
+
+/*
+ * The smallest vectors that each path is taken for. Sizes in between use the
+ * fastest path whose threshold they reach.
+ */
+struct Tuning {
+
+	long simdMin;		/*SIMD instead of a scalar loop*/
+	long threadMin;		/*Split over threads*/
+	long diffThreadMin;	/*diff_vec() split over threads*/
+	int threads;		/*Threads a kernel is split over*/
+	int placement;		/*Where large vectors are put, an enum Placement*/
+};
+
+/*The thresholds the kernels use. Defaults until a profile is loaded*/
+extern struct Tuning tuning;
+
+/*
+ * The path of the profile
+ * return: VECALC_PROFILE if it is set, or TUNE_PROFILE_NAME in the home
+ * directory. The string is never freed
+ */
+const char *tuningPath(void);
+
+/*
+ * Loads a profile written by calibrate(). Thresholds missing from it, or a
+ * missing profile, leave the defaults
+ * param const char *: The path of the profile
+ * return: true if the profile was read
+ */
+bool loadTuning(const char *);
+
+/*
+ * Times the scalar, SIMD and threaded kernels and diff_vec() at sizes from 16
+ * elements up, finds where each path starts to win, and writes a profile with
+ * them and the placement in use
+ * param const char *: The path the profile is written to
+ * param FILE *: Where the timings are reported
+ * return: true if the profile was written
+ */
+bool calibrate(const char *, FILE *);
+
+#endif /*_VECTORTUNE_H_*/
@@ -0,0 +1,18 @@
+#!/bin/sh
+#
+# Counts vecalc's probes with perf instead of bpftrace. Any arguments are given
+# to vecalc, and its input is stdin.
+# Usage: sudo ./perfprobes.sh --optimize < workload.txt
+#
+
+VECALC=${VECALC:-./vecalc}
+
+perf buildid-cache --add "$VECALC" || exit 1
+
+for probe in command_start command_end kernel_entry kernel_exit vector_grow vector_sparse vector_dense line_read; do
+	perf probe --quiet --add "sdt_vecalc:$probe" || exit 1
+done
+
+perf stat -e 'sdt_vecalc:*' "$VECALC" "$@"
+
+perf probe --quiet --del 'sdt_vecalc:*'
@@ -21,6 +21,64 @@
 #include "vectorOut.h"
 #include "vectorIn.h"
 #include "vectorMem.h"
+#include "vectorCmd.h"
+#include "vectorOpt.h"
+#include "vectorBin.h"
+#include "vectorServe.h"
+#include "vectorPipe.h"
+#include "vectorRun.h"
+#include "vectorAsync.h"
+#include "vectorDiag.h"
+#include "vectorProbe.h"
+#include "vectorTune.h"
+#include "vectorSnap.h"
+
+/*
+ * The session holding the main vector on which operation are performed. It
+ * outlives main so that its diagnostics can be summarised at exit.
+ */
+static struct Session session;
+
+/*
+ * Prints the summary of the main session's diagnostics, and its statistics if
+ * they were kept, however vecalc exits
+ */
+static void summarise(void) {
+
+	diagSummary(&session.diag, session.err);
+
+	if(session.stats != NULL) {
+
+		fprint_stats(session.err, session.stats, FORMAT_TEXT);
+	}
+}
+
+/*
+ * Splits a line of options into argv, after argv[0]
+ * param argv: The argument vector, with room for MAX_OPTIONS arguments
+ * param line: The options, separated by spaces
+ * return: The number of arguments in argv, including argv[0]
+ */
+static int restoreArgv(char *argv[], char *line) {
+
+	char *copy = malloc(strlen(line) + 1);
+	checkAlloc(copy);
+	strcpy(copy, line);
+
+	int argc = 1;
+	char *option = strtok(copy, " ");
+
+	while(option != NULL && argc < MAX_OPTIONS - 1) {
+
+		argv[argc] = malloc(strlen(option) + 1);
+		checkAlloc(argv[argc]);
+		strcpy(argv[argc++], option);
+		option = strtok(NULL, " ");
+	}
+	free(copy);
+
+return argc;
+}
 
 /*
  * Program main entry point.
@@ -28,18 +86,43 @@
  */
 int main(int argc, char *argv[]) {
 
-	/*The main vector on which operation are performed*/
-	struct Vector *vec = alloc_vec();
+	/*Settings given as flags before the first option*/
+	struct Flags flags;
+	argc = parseFlags(argv, argc, &flags);
+
+	/*The sizes the kernels switch to SIMD and threads at, for this host*/
+	if(!flags.calibrate) {
+
+		loadTuning(tuningPath());
+	}
+
+	/*A placement given as a flag is used instead of the profile's, and saved by --calibrate*/
+	if(flags.placement >= 0) {
+
+		tuning.placement = flags.placement;
+	}
+
+	if(flags.calibrate) {
 
-	/*Temporary vector when the extend_vec function is called*/
-	struct Vector *tempVec = vec;
+		return calibrate(tuningPath(), stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
 
 	/*
-	 * option holds the current option being processed. Option never 
-	 * contains an argument to an option for all valid input.
+	 * Diagnostics are buffered like any other output unless they are
+	 * going to a terminal, where they are wanted straight away
 	 */
-	char *option;
-	
+	if(isatty(STDERR_FILENO) == 0) {
+
+		setvbuf(stderr, NULL, _IOFBF, DIAG_BUFFER_SIZE);
+	}
+
+	init_session(&session, stdout, stderr);
+	configure_session(&session, &flags);
+
+	/*The options in argv once they have been checked*/
+	struct Command *cmds;
+	int numCmds;
+
 	/*
 	 * In order to manage memory usage properly, we need to know how
 	 * much of argv has been dynamically allocated and how much hasn't, so 
@@ -55,17 +138,92 @@ int main(int argc, char *argv[]) {
 	int maxArgc;
 	maxArgc = argc;
 
+	/*The server gives each connection a session of its own*/
+	if(flags.socketPath != NULL) {
+
+		dealloc_vec(session.vec);
+		return serve(flags.socketPath, flags.workers, &flags);
+	}
+
+	/*With --run, what would be the initial options are scripts instead*/
+	if(flags.run) {
+
+		dealloc_vec(session.vec);
+		return runScripts(argv + 1, argc - 1, flags.workers, &flags);
+	}
+
+	/*Only the main session is snapshotted periodically, and restored*/
+	session.snapshotEvery = flags.snapshotEvery;
+
+	if(flags.restorePath != NULL && !snapshot_restore(&session, flags.restorePath)) {
+
+		fprintf(stderr, "Could not restore a snapshot from %s\n", flags.restorePath);
+		dealloc_vec(session.vec);
+		return EXIT_FAILURE;
+	}
+	session.snapshotLast = session.line;
+
+	if(flags.asyncOutput) {
+
+		asyncOutput(&session, STDOUT_FILENO, STDERR_FILENO);
+	}
+
+	/*After asyncOutput() so that it runs before the output is closed*/
+	atexit(summarise);
+
+	if(flags.pipeline) {
+
+		int status = pipelineIn(&session, stdin, argv, argc, &flags);
+		free_session(&session);
+		return status;
+	}
+
+	/*Binary records skip argv and the text options altogether*/
+	if(flags.binary) {
+
+		int status = binaryIn(&session, STDIN_FILENO, &flags);
+		dealloc_vec(session.vec);
+		return status;
+	}
+
 	/*
-	 * float to hold the value of magnitude. m is only used in this program
-	 * for testing, so warnings about it being unused are generated if we
-	 * aren't compiling the test code. We can safely ignore it.
+	 * refreshArgv() places every option of a line in argv, which needs
+	 * more room than the argv vecalc was given. The options it was given
+	 * are copied into memory of our own, so all of argv after argv[0] is
+	 * dynamically allocated.
 	 */
-	#pragma GCC diagnostic push
-	#pragma GCC diagnostic ignored "-Wunused-parameter"
-	#pragma GCC diagnostic ignored "-Wunused-but-set-variable"	
-	Elem m;
-	#pragma GCC diagnostic pop
-	
+	char **options = calloc(MAX_OPTIONS, sizeof(char *));
+	checkAlloc(options);
+
+	int i;
+	for(i = 0; i < argc && i < MAX_OPTIONS - 1; i++) {
+
+		options[i] = malloc(strlen(argv[i]) + 1);
+		checkAlloc(options[i]);
+		strcpy(options[i], argv[i]);
+	}
+	argv = options;
+	argc = i;
+	initialArgc = 1;
+
+	/*
+	 * Without options to run first, the last line of a restored snapshot
+	 * goes in argv as if it had just run, so that r repeats it, and the
+	 * first line is read in the same way as every line after it
+	 */
+	if(argc == 1 && session.lastLine != NULL) {
+
+		argc = restoreArgv(argv, session.lastLine);
+		maxArgc = argc;
+		argc = refreshArgv(argv, maxArgc, initialArgc, argc);
+		session.line++;
+
+		if(argc < maxArgc) {
+
+			cleanArgv(argv, argc, argc + 1);
+		}
+	}
+
 	#ifdef TESTING
 
 	int loopCount = 0;
@@ -88,7 +246,14 @@ int main(int argc, char *argv[]) {
 		 */
 		while(argv[1] == NULL) {
 
+			/*Everything from the last line is shown before the prompt*/
+			if(isatty(STDIN_FILENO) == 1) {
+
+				asyncWait();
+			}
 			argc = refreshArgv(argv, maxArgc, initialArgc, argc);
+			session.line++;
+			VEC_PROBE2(line_read, session.line, argc - 1);
 
 			/*Check if this is the most space we've needed so far*/
 			if(argc > maxArgc) {
@@ -121,149 +286,41 @@ int main(int argc, char *argv[]) {
 		 */
 		if(isatty(STDIN_FILENO) == 0 && strcmp(argv[1], "") == 0) {
 
-			dealloc_vec(vec);
-			free(option);
+			dealloc_vec(session.vec);
 			return EXIT_SUCCESS;	
 		}
 		
-		int i;
-		for(i = 1; i < argc; i++) {
-		
-       			/*Check vec in case the c option was given*/
-			if(vec == NULL) {
-
-				vec = alloc_vec();
-			}
-
-			option = argv[i];
-
-			/*Any option should only be one character in length*/
-			if(strlen(option) > 1) {
-			
-				fprintf(stderr, "Invalid option: %s Type 'h' for usage\n", argv[i]);
-				continue;
-				
-				#ifdef TESTING
-
-				loopCount++;
-
-				#endif
-			
-				option = argv[i];
-			}
-
-			switch(*option) {
-			
-				case 'q':	dealloc_vec(vec);
-						return EXIT_SUCCESS;
-						break;
-				
-				case 'e':	dealloc_vec(vec);
-						return EXIT_SUCCESS;
-						break;
-			
-				case 'c':	dealloc_vec(vec);
-						vec = NULL;
-						break;
-
-				case 'p':	print_vec(vec);
-						break;
-
-				case 'h':	getHelp();
-						break;
-
-				case 'a':	if(vec->size == MAXVECSIZE) {
-
-							fprintf(stderr, "Vector is at maximum size and can not be extended");
-						}	
-						else if(ensureDigit(argv[i + 1])) {
-
-							tempVec = vec;
-
-							/*
-							 * Notice the pre-inrement. extend_vec takes the next value
-							 * of i. This also skips over the next i value iteration in
-							 * the for loop.
-							 */
-							vec = extend_vec(vec, atof(argv[++i]));
-							dealloc_vec(tempVec);
-						}
-						else {
-
-							fprintf(stderr, "Bad argument - Usage: [a] [value]\n");
-							i++;
-						}
-						break;
-
-				case '+':	if(ensureDigit(argv[i + 1])) {
-
-							scalar_plus(vec, atof(argv[++i]));	
-						}
-						else {
-
-							fprintf(stderr, "Bad argument - Usage [+] [value]\n");
-							/*
-							 * The argument is invalid, so skip over it. This same logic
-							 * is repeated in other cases
-							 */
-							i++;
-						}
-						break;
-				
-				case '-':	if(ensureDigit(argv[i + 1])) {
-
-							scalar_minus(vec, atof(argv[++i]));
-	
-						}
-						else {
-
-							fprintf(stderr, "Bad argument - Usage [-] [value]\n");
-							i++;
-						}
-						break;
-
-				case '*':	if(ensureDigit(argv[i + 1])) {
-
-							scalar_mult(vec, atof(argv[++i]));	
-						}
-						else {
-
-							fprintf(stderr, "Bad argument - Usage [*] [value]\n");
-							i++;
-						}
-						break;
-
-				case '/':	if(ensureDigit(argv[i + 1])) {
-
-							scalar_div(vec, atof(argv[++i]));	
-						}
-						else {
+		/*
+		 * There can't be more commands than there are options, so
+		 * that is all the room the command list needs.
+		 */
+		cmds = malloc(argc*sizeof(struct Command));
+		checkAlloc(cmds);
 
-							fprintf(stderr, "Bad argument - Usage [/] [value]\n");
-							i++;
-						}
-						break;
+		rememberLine(&session, argv + 1, argc - 1);
+		numCmds = parseCommands(&session, argv + 1, argc - 1, cmds);
 
-				case 'm':	m = magnitude(vec);
-						printf("Magnitude: %f\n", m);
-						break;
+		if(flags.optimize) {
 
-				case 'r':	if(i != 1) {
+			numCmds = optimizeCommands(cmds, numCmds, flags.showOptimized ? stderr : NULL);
+		}
 
-							fprintf(stderr, "The r option can not follow any other option.\n");
-						}
-						break;
+		if(!runCommands(&session, cmds, numCmds)) {
 
-				default:	fprintf(stderr, "Invalid option: %s\n", argv[i]);
-						
-						break;
-			}/*delimits case*/
-		}/*delimits for*/
+			free(cmds);
+			return EXIT_SUCCESS;
+		}
+		free(cmds);
+		snapshot_due(&session, session.line);
 		
 	#ifdef TESTING
 		
 		const Elem ERROR = 1E-5;
 
+		/*The tests were written against the vector on its own*/
+		struct Vector *vec = session.vec;
+		Elem m = session.lastMagnitude;
+
 		/*
 		 * The testing file is generated from the makefile. Refer to
 		 * it for the sequence of input, and adding more testing
@@ -1301,6 +1358,7 @@ int main(int argc, char *argv[]) {
 	#endif /*TESTING*/
 
 		argc = refreshArgv(argv, maxArgc, initialArgc, argc);
+		session.line++;
 	
 		if(argc < maxArgc) {
 
@@ -1308,8 +1366,7 @@ int main(int argc, char *argv[]) {
 		}
 	}/*delimits while(1)*/
 
-	dealloc_vec(vec);
-	free(option);
+	dealloc_vec(session.vec);
 
 return 0;
 } 
@@ -0,0 +1,643 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vecalcBench.c						//
+ * Synopsis	:	Microbenchmarks of the vector kernels over sizes from	//
+ * 			L1 resident to DRAM resident				//
+ *==============================================================================//
+ */
+
+/*For sched_setaffinity(), pthread_attr_setaffinity_np() and clock_gettime()*/
+#define _GNU_SOURCE
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of a Vector*/
+#include "vectorOps.h"
+#include "vectorOut.h" /*For fprint_vec() and magnitude()*/
+#include "vectorMem.h"
+#include "vectorPlace.h" /*For the topology of the host*/
+
+/*Smallest and largest number of elements benchmarked by default*/
+#define BENCH_MIN_SIZE 256
+#define BENCH_MAX_SIZE 16777216
+
+/*
+ * Each sample calls a kernel until it has touched at least this many elements,
+ * so that small vectors aren't timed by the clock's resolution
+ */
+#define BENCH_BATCH_ELEMENTS 1048576
+
+/*
+ * Largest vector grown with extend_vec(). Growth copies the whole vector for
+ * every element, so a growth to MAXVECSIZE takes seconds, and the quadratic
+ * cost is plain from the smaller sizes anyway.
+ */
+#define BENCH_EXTEND_MAX 16384
+
+/*Most samples taken of one kernel at one size*/
+#define BENCH_MAX_REPS 1000
+
+/*The kernels that are timed*/
+enum Kernel {
+
+	KERNEL_PLUS,
+	KERNEL_MINUS,
+	KERNEL_MULT,
+	KERNEL_DIV,
+	KERNEL_MAGNITUDE,
+	KERNEL_EXTEND,
+	KERNEL_PRINT,
+	KERNELS
+};
+
+static const char *kernelNames[KERNELS] = {
+
+	"scalar_plus",
+	"scalar_minus",
+	"scalar_mult",
+	"scalar_div",
+	"magnitude",
+	"extend_vec",
+	"print_vec"
+};
+
+/*Bytes read and written for each element a kernel touches*/
+static const int kernelBytes[KERNELS] = {8, 8, 8, 8, 4, 8, 4};
+
+/*What was measured for one kernel at one size*/
+struct BenchResult {
+
+	enum Kernel kernel;
+	long size;
+	long batch;
+	int reps;
+	/*Nanoseconds per element*/
+	double min;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+	/*Bytes moved per second at the median, in billions*/
+	double gbPerSec;
+	/*Every timed sample, smallest first, for vecalcGate to test*/
+	double samples[BENCH_MAX_REPS];
+};
+
+/*One CPU's share of a buffer swept for the bandwidth between nodes*/
+struct NodePart {
+
+	struct Vector part;
+	int cpu;
+	bool fill;	/*Write the share for the first time instead of sweeping it*/
+	pthread_t thread;
+	bool threaded;
+};
+
+/*Keeps magnitude() from being thrown away*/
+static volatile float sink;
+
+/*
+ * Reads the monotonic clock
+ * return: The time in nanoseconds
+ */
+static double now() {
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+return time.tv_sec*1e9 + time.tv_nsec;
+}
+
+/*
+ * Orders two doubles from smallest to largest, for qsort()
+ * param a: A double
+ * param b: Another double
+ * return: Less than zero if a comes first, more than zero if b comes first
+ */
+static int ascending(const void *a, const void *b) {
+
+	double first = *(const double *)a;
+	double second = *(const double *)b;
+
+return (first > second) - (first < second);
+}
+
+/*
+ * The nearest rank percentile of sorted samples
+ * param samples: The samples, smallest first
+ * param count: The number of samples
+ * param percent: The percentile, from 0 to 100
+ * return: The sample at that percentile
+ */
+static double percentile(double *samples, int count, double percent) {
+
+	int rank = (int)(percent/100*count + 0.999999);
+
+	if(rank < 1) {
+
+		rank = 1;
+	}
+
+	if(rank > count) {
+
+		rank = count;
+	}
+
+return samples[rank - 1];
+}
+
+/*
+ * Makes a vector without going through extend_vec(), so that it can be larger
+ * than MAXVECSIZE
+ * param size: The number of elements
+ * return: The vector, with every element written so its pages are mapped
+ */
+static struct Vector *makeVector(long size) {
+
+	struct Vector *vector = alloc_vec();
+	vector->elements = malloc(size*sizeof(Elem));
+	checkAlloc(vector->elements);
+	vector->size = size;
+
+	long i;
+	for(i = 0; i < size; i++) {
+
+		vector->elements[i] = i%100 + 0.5;
+	}
+
+return vector;
+}
+
+/*
+ * Grows a vector from nothing one element at a time, the way the a option does
+ * param size: The size to grow to
+ */
+static void grow(long size) {
+
+	struct Vector *vector = alloc_vec();
+
+	long i;
+	for(i = 0; i < size; i++) {
+
+		struct Vector *bigger = extend_vec(vector, i);
+		dealloc_vec(vector);
+		vector = bigger;
+	}
+	dealloc_vec(vector);
+}
+
+/*
+ * Runs a kernel once over a vector. The scalar values keep the elements the
+ * same size forever, so no sample runs into infinities or denormals.
+ * param kernel: The kernel
+ * param vector: The vector
+ * param devNull: Where print_vec's output goes
+ */
+static void runKernel(enum Kernel kernel, struct Vector *vector, FILE *devNull) {
+
+	switch(kernel) {
+
+		case KERNEL_PLUS:	scalar_plus(vector, 1);
+					break;
+
+		case KERNEL_MINUS:	scalar_minus(vector, 1);
+					break;
+
+		case KERNEL_MULT:	scalar_mult(vector, -1);
+					break;
+
+		case KERNEL_DIV:	scalar_div(vector, -1);
+					break;
+
+		case KERNEL_MAGNITUDE:	sink = magnitude(vector);
+					break;
+
+		case KERNEL_EXTEND:	grow(vector->size);
+					break;
+
+		case KERNEL_PRINT:	fprint_vec(devNull, vector);
+					break;
+
+		default:		break;
+	}
+}
+
+/*
+ * Times a kernel at one size
+ * param kernel: The kernel
+ * param vector: The vector it runs over
+ * param warmup: The number of untimed samples first
+ * param reps: The number of timed samples
+ * param devNull: Where print_vec's output goes
+ * param result: Filled in with what was measured
+ */
+static void bench(enum Kernel kernel, struct Vector *vector, int warmup, int reps, FILE *devNull, struct BenchResult *result) {
+
+	double *samples = result->samples;
+
+	/*Growing a vector is quadratic, so one growth is plenty of work*/
+	long batch = kernel == KERNEL_EXTEND ? 1 : (BENCH_BATCH_ELEMENTS + vector->size - 1)/vector->size;
+
+	int r;
+	for(r = -warmup; r < reps; r++) {
+
+		double start = now();
+
+		long b;
+		for(b = 0; b < batch; b++) {
+
+			runKernel(kernel, vector, devNull);
+		}
+
+		if(r >= 0) {
+
+			samples[r] = (now() - start)/batch/vector->size;
+		}
+	}
+	qsort(samples, reps, sizeof(double), ascending);
+
+	result->kernel = kernel;
+	result->size = vector->size;
+	result->batch = batch;
+	result->reps = reps;
+	result->min = samples[0];
+	result->p50 = percentile(samples, reps, 50);
+	result->p90 = percentile(samples, reps, 90);
+	result->p99 = percentile(samples, reps, 99);
+	result->max = samples[reps - 1];
+
+	/*Each growth copies every element before it once*/
+	double bytesPerElem = kernel == KERNEL_EXTEND ? kernelBytes[kernel]*(vector->size - 1)/2.0 : kernelBytes[kernel];
+	result->gbPerSec = bytesPerElem/result->p50;
+}
+
+/*
+ * Pins the benchmark to one CPU, so that samples aren't moved between caches
+ * param cpu: The CPU
+ * return: true if the benchmark was pinned
+ */
+static bool pin(int cpu) {
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+
+return sched_setaffinity(0, sizeof(cpu_set_t), &set) == 0;
+}
+
+/*
+ * Sweeps one CPU's share of a buffer, multiplying by one so the elements stay
+ * the same, which reads and writes every byte
+ * param arg: The NodePart
+ * return: NULL
+ */
+static void *sweepNodePart(void *arg) {
+
+	struct NodePart *part = arg;
+
+	if(part->fill) {
+
+		long i;
+		for(i = 0; i < part->part.size; i++) {
+
+			part->part.elements[i] = i%100 + 0.5;
+		}
+	}
+	else {
+
+		sweep(&part->part, '*', 1, PATH_SIMD);
+	}
+
+return NULL;
+}
+
+/*
+ * Splits a buffer between CPUs, each sweeping or writing its share on a thread
+ * pinned to it, and waits for them all
+ * param parts: One for each CPU, with its CPU and fill set
+ * param count: The number of CPUs
+ * param elements: The buffer
+ * param size: The number of elements in it
+ */
+static void sweepOnCpus(struct NodePart *parts, int count, Elem *elements, long size) {
+
+	int c;
+	for(c = 0; c < count; c++) {
+
+		long first = size*c/count;
+		long last = size*(c + 1)/count;
+
+		parts[c].part.elements = elements + first;
+		parts[c].part.size = last - first;
+
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(parts[c].cpu, &set);
+
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set);
+		parts[c].threaded = pthread_create(&parts[c].thread, &attr, sweepNodePart, &parts[c]) == 0;
+		pthread_attr_destroy(&attr);
+
+		if(!parts[c].threaded) {
+
+			sweepNodePart(&parts[c]);
+		}
+	}
+
+	for(c = 0; c < count; c++) {
+
+		if(parts[c].threaded) {
+
+			pthread_join(parts[c].thread, NULL);
+		}
+	}
+}
+
+/*
+ * Measures the bandwidth from the CPUs of each node to memory on each node, and
+ * prints it as a matrix: the diagonal is what each socket gets from its own
+ * memory, and the rest what it gets across the interconnect. A buffer is put on
+ * a node by first writing it from a CPU there, and every CPU of the node
+ * reading it sweeps a share at once. Nodes without CPUs can't be measured.
+ * param size: Elements in the buffer, which should be much larger than the
+ * caches
+ * param warmup: The number of untimed sweeps first
+ * param reps: The number of timed sweeps; the median is printed
+ */
+static void benchNodes(long size, int warmup, int reps) {
+
+	const struct Topology *host = topology();
+	int first[PLACE_MAX_NODES];
+	int count[PLACE_MAX_NODES];
+	double samples[BENCH_MAX_REPS];
+
+	struct NodePart *parts = malloc(host->cpuCount*sizeof(struct NodePart));
+	Elem *elements = malloc(size*sizeof(Elem));
+	checkAlloc(parts);
+	checkAlloc(elements);
+
+	/*The CPUs of each node are next to each other in the topology*/
+	int n;
+	for(n = 0; n < host->nodes; n++) {
+
+		first[n] = 0;
+		count[n] = 0;
+
+		int c;
+		for(c = 0; c < host->cpuCount; c++) {
+
+			if(host->nodeOf[c] == host->nodeIds[n] && count[n]++ == 0) {
+
+				first[n] = c;
+			}
+		}
+	}
+
+	printf("%ld MiB swept by every CPU of a node, GB/s at the median of %d\n", size*(long)sizeof(Elem)/1048576, reps);
+	printf("%-16s", "cpus \\ memory");
+
+	char label[32];
+
+	for(n = 0; n < host->nodes; n++) {
+
+		if(count[n] > 0) {
+
+			sprintf(label, "node %d", host->nodeIds[n]);
+			printf(" %11s", label);
+		}
+	}
+	printf("\n");
+
+	int cpuNode;
+	for(cpuNode = 0; cpuNode < host->nodes; cpuNode++) {
+
+		if(count[cpuNode] == 0) {
+
+			continue;
+		}
+		sprintf(label, "node %d, %d cpus", host->nodeIds[cpuNode], count[cpuNode]);
+		printf("%-16s", label);
+
+		int memoryNode;
+		for(memoryNode = 0; memoryNode < host->nodes; memoryNode++) {
+
+			if(count[memoryNode] == 0) {
+
+				continue;
+			}
+
+			/*Fresh pages, first written by one CPU of the memory node*/
+			free(elements);
+			elements = malloc(size*sizeof(Elem));
+			checkAlloc(elements);
+
+			struct NodePart toucher;
+			toucher.cpu = host->cpus[first[memoryNode]];
+			toucher.fill = true;
+			sweepOnCpus(&toucher, 1, elements, size);
+
+			int c;
+			for(c = 0; c < count[cpuNode]; c++) {
+
+				parts[c].cpu = host->cpus[first[cpuNode] + c];
+				parts[c].fill = false;
+			}
+
+			int r;
+			for(r = -warmup; r < reps; r++) {
+
+				double start = now();
+				sweepOnCpus(parts, count[cpuNode], elements, size);
+
+				if(r >= 0) {
+
+					samples[r] = now() - start;
+				}
+			}
+			qsort(samples, reps, sizeof(double), ascending);
+
+			/*Every element is read and written*/
+			printf(" %11.2f", 2*size*(double)sizeof(Elem)/percentile(samples, reps, 50));
+			fflush(stdout);
+		}
+		printf("\n");
+	}
+	free(elements);
+	free(parts);
+}
+
+/*
+ * Prints the results as JSON
+ * param stream: Where they are printed
+ * param results: The results
+ * param count: The number of results
+ * param cpu: The CPU the benchmark was pinned to, or -1
+ */
+static void printJson(FILE *stream, struct BenchResult *results, int count, int cpu) {
+
+	fprintf(stream, "{\"cpu\":%d,\"results\":[\n", cpu);
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		struct BenchResult *r = &results[i];
+
+		fprintf(stream, "{\"kernel\":\"%s\",\"elements\":%ld,\"bytes\":%ld,\"batch\":%ld,\"reps\":%d,", kernelNames[r->kernel], r->size, r->size*(long)sizeof(Elem), r->batch, r->reps);
+		fprintf(stream, "\"nsPerElem\":{\"min\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f},\"gbPerSec\":%.3f,\"samples\":[", r->min, r->p50, r->p90, r->p99, r->max, r->gbPerSec);
+
+		int s;
+		for(s = 0; s < r->reps; s++) {
+
+			fprintf(stream, "%s%.4f", s > 0 ? "," : "", r->samples[s]);
+		}
+		fprintf(stream, "]}%s\n", i + 1 < count ? "," : "");
+	}
+	fprintf(stream, "]}\n");
+}
+
+/*
+ * Runs every kernel over every size from --min to --max elements, four times
+ * larger each step, and prints a table of nanoseconds per element at the
+ * median and other percentiles, and the bandwidth at the median. With --numa,
+ * prints the bandwidth between the CPUs and memory of each node instead, over
+ * a buffer of --max elements.
+ *
+ * Usage: vecalcBench [--min n] [--max n] [--warmup n] [--reps n] [--cpu n]
+ * [--json path] [--only kernel] [--numa]
+ */
+int main(int argc, char *argv[]) {
+
+	long minSize = BENCH_MIN_SIZE;
+	long maxSize = BENCH_MAX_SIZE;
+	int warmup = 2;
+	int reps = 15;
+	int cpu = 0;
+	char *jsonPath = NULL;
+	char *only = NULL;
+	bool numa = false;
+
+	int i;
+	for(i = 1; i < argc; i++) {
+
+		bool hasValue = i + 1 < argc;
+
+		if(strcmp(argv[i], "--min") == 0 && hasValue && atol(argv[i + 1]) > 0) {
+
+			minSize = atol(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--max") == 0 && hasValue && atol(argv[i + 1]) > 0) {
+
+			maxSize = atol(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--warmup") == 0 && hasValue && atoi(argv[i + 1]) >= 0) {
+
+			warmup = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--reps") == 0 && hasValue && atoi(argv[i + 1]) > 0 && atoi(argv[i + 1]) <= BENCH_MAX_REPS) {
+
+			reps = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--cpu") == 0 && hasValue) {
+
+			cpu = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "--json") == 0 && hasValue) {
+
+			jsonPath = argv[++i];
+		}
+		else if(strcmp(argv[i], "--only") == 0 && hasValue) {
+
+			only = argv[++i];
+		}
+		else if(strcmp(argv[i], "--numa") == 0) {
+
+			numa = true;
+		}
+		else {
+
+			fprintf(stderr, "Usage: vecalcBench [--min n] [--max n] [--warmup n] [--reps 1-%d] [--cpu n|-1] [--json path] [--only kernel] [--numa]\n", BENCH_MAX_REPS);
+			return EXIT_FAILURE;
+		}
+	}
+
+	/*Every thread is pinned to a CPU of the node it measures*/
+	if(numa) {
+
+		benchNodes(maxSize, warmup, reps);
+		return EXIT_SUCCESS;
+	}
+
+	/*A negative CPU leaves the benchmark wherever the scheduler puts it*/
+	if(cpu >= 0 && !pin(cpu)) {
+
+		fprintf(stderr, "Could not pin to CPU %d. Running unpinned\n", cpu);
+		cpu = -1;
+	}
+
+	FILE *devNull = fopen("/dev/null", "w");
+	checkAlloc(devNull);
+
+	int maxResults = KERNELS*64;
+	struct BenchResult *results = malloc(maxResults*sizeof(struct BenchResult));
+	checkAlloc(results);
+	int count = 0;
+
+	printf("%-13s %10s %10s %9s %9s %9s %9s %9s\n", "kernel", "elements", "KiB", "ns/elem", "min", "p90", "p99", "GB/s");
+
+	long size;
+	for(size = minSize; size <= maxSize && count + KERNELS <= maxResults; size *= 4) {
+
+		struct Vector *vector = makeVector(size);
+
+		int k;
+		for(k = 0; k < KERNELS; k++) {
+
+			if(only != NULL && strcmp(only, kernelNames[k]) != 0) {
+
+				continue;
+			}
+
+			if(k == KERNEL_EXTEND && size > BENCH_EXTEND_MAX) {
+
+				continue;
+			}
+
+			struct BenchResult *r = &results[count++];
+			bench(k, vector, warmup, reps, devNull, r);
+
+			printf("%-13s %10ld %10ld %9.3f %9.3f %9.3f %9.3f %9.2f\n", kernelNames[k], size, size*(long)sizeof(Elem)/1024, r->p50, r->min, r->p90, r->p99, r->gbPerSec);
+			fflush(stdout);
+		}
+		dealloc_vec(vector);
+	}
+
+	if(jsonPath != NULL) {
+
+		FILE *json = fopen(jsonPath, "w");
+
+		if(json == NULL) {
+
+			fprintf(stderr, "Could not write %s\n", jsonPath);
+		}
+		else {
+
+			printJson(json, results, count, cpu);
+			fclose(json);
+		}
+	}
+	free(results);
+	fclose(devNull);
+
+return EXIT_SUCCESS;
+}
@@ -0,0 +1,1277 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vecalcCheck.c						//
+ * Synopsis	:	Differential tests of the vector kernels, the optimizer	//
+ * 			and threaded comparison against plain scalar loops	//
+ *==============================================================================//
+ */
+
+/*For sched_yield()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include <pthread.h>
+#include <sched.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For definition of a Vector*/
+#include "vectorOps.h"
+#include "vectorOpt.h"
+#include "vectorDiff.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorSparse.h"
+#include "vectorPack.h"
+#include "vectorTune.h" /*For the placement and the thread threshold*/
+#include "vectorPlace.h"
+#include "vectorEpoch.h"
+#include "vectorCmd.h" /*For definition of Session*/
+#include "vectorSnap.h"
+
+/*
+ * The kernels are held to the reference loops exactly. Every operation on an
+ * element is a single IEEE operation, so any kernel that gives a different bit
+ * pattern (apart from which NaN) has changed what vecalc computes.
+ */
+#define CHECK_KERNEL_ULPS 0
+
+/*
+ * magnitude() is allowed to add up a dense vector in any order. Reordering n
+ * elements moves the result by at most n*FLT_EPSILON of the sum of their
+ * absolute values. Sparse and packed vectors have to give the same bits as
+ * the dense vector they stand for, whatever order that is.
+ */
+#define CHECK_SUM_BOUND(n, absoluteSum) ((n)*(double)FLT_EPSILON*(absoluteSum))
+
+/*
+ * The optimizer only folds commands when the folded one gives the same bits,
+ * so a chain of commands has to come out the same with and without it
+ */
+#define CHECK_CHAIN_ULPS 0
+
+/*Longest random chain of commands*/
+#define CHECK_CHAIN_MAX 8
+
+/*Largest vector the kernels are checked on, which is not a multiple of anything*/
+#define CHECK_MAX_SIZE (MAXVECSIZE + 37)
+
+/*
+ * Vectors start up to this many elements past an aligned address, so kernels
+ * see every alignment of a 32 byte vector register
+ */
+#define CHECK_MAX_OFFSET 7
+
+/*Most divergences printed for each test*/
+#define CHECK_REPORT_MAX 5
+
+/*Smallest vector placement is checked on, which place_copy() doesn't leave alone*/
+#define CHECK_PLACE_MIN_SIZE 16384
+
+/*Changes the writer makes to a shared vector while it is read*/
+#define CHECK_EPOCH_CHANGES 2000
+
+/*Where snapshots are written and restored from. It is removed after*/
+#define CHECK_SNAP_PATH "vecalcCheck.snap"
+
+/*The element-wise kernels, in the order they're checked*/
+#define CHECK_KERNELS "+-*/"
+
+/*State of the random number generator*/
+static uint64_t state;
+
+/*Divergences found by the current test, and in all tests*/
+static long divergences;
+static long totalDivergences;
+
+/*
+ * The next number from splitmix64, so the same seed checks the same cases on
+ * every machine
+ * return: A random 64 bit number
+ */
+static uint64_t next() {
+
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+
+return z ^ (z >> 31);
+}
+
+/*
+ * A random number in a range
+ * param low: The smallest number
+ * param high: The largest number
+ * return: A number from low to high, inclusive
+ */
+static long between(long low, long high) {
+
+return low + (long)(next()%(uint64_t)(high - low + 1));
+}
+
+/*
+ * Makes a float from its bits
+ * param bits: The bits
+ * return: The float
+ */
+static Elem fromBits(uint32_t bits) {
+
+	union {
+
+		float f;
+		uint32_t bits;
+	} u;
+	u.bits = bits;
+
+return u.f;
+}
+
+/*
+ * The bits of a float
+ * param value: The float
+ * return: Its bits
+ */
+static uint32_t toBits(Elem value) {
+
+	union {
+
+		float f;
+		uint32_t bits;
+	} u;
+	u.f = value;
+
+return u.bits;
+}
+
+/*
+ * A random finite element of either sign, from about 1e-12 to 5e5, with every
+ * bit of its mantissa random
+ * return: The element
+ */
+static Elem randomFinite() {
+
+	uint32_t sign = (next() & 1) << 31;
+	uint32_t exponent = between(127 - 40, 127 + 18);
+	uint32_t mantissa = next() & 0x007FFFFF;
+
+return fromBits(sign | exponent << 23 | mantissa);
+}
+
+/*
+ * A random element, which is sometimes a value that kernels get wrong most
+ * easily: NaN, an infinity, a zero of either sign, a denormal, the smallest
+ * normal or the largest float
+ * param huge: false if the largest float can't be picked, when a result that
+ * overflows would make the reference depend on the order things are done in
+ * return: The element
+ */
+static Elem randomElem(bool huge) {
+
+	if(next()%8 != 0) {
+
+		return randomFinite();
+	}
+
+	uint32_t sign = (next() & 1) << 31;
+
+	switch(between(0, huge ? 5 : 4)) {
+
+		case 0:		return fromBits(0x7FC00000);
+		case 1:		return fromBits(sign | 0x7F800000);
+		case 2:		return fromBits(sign);
+		case 3:		return fromBits(sign | (uint32_t)between(1, 0x007FFFFF));
+		case 4:		return fromBits(sign | 0x00800000);
+		default:	return fromBits(sign | 0x7F7FFFFF);
+	}
+}
+
+/*
+ * Checks if an element is NaN or an infinity
+ * param value: The element
+ * return: true if it isn't finite
+ */
+static bool notFinite(double value) {
+
+return value - value != 0;
+}
+
+/*
+ * Runs one command on one element the way the original loops did
+ * param option: +, -, * or /
+ * param element: The element
+ * param value: The value of the command
+ * return: The new element
+ */
+static Elem reference(char option, Elem element, Elem value) {
+
+	switch(option) {
+
+		case '+':	return element + value;
+		case '-':	return element - value;
+		case '*':	return element*value;
+		default:	return element/value;
+	}
+}
+
+/*
+ * Runs a kernel on a vector
+ * param option: +, -, * or /
+ * param vector: The vector
+ * param value: The value of the command
+ */
+static void kernel(char option, struct Vector *vector, Elem value) {
+
+	switch(option) {
+
+		case '+':	scalar_plus(vector, value); break;
+		case '-':	scalar_minus(vector, value); break;
+		case '*':	scalar_mult(vector, value); break;
+		default:	scalar_div(vector, value); break;
+	}
+}
+
+/*
+ * Counts a divergence, and prints it if it is one of the first of its test
+ * param test: The name of the test
+ * param size: The size of the vector
+ * param index: The element that diverged
+ * param input: What the element was before the test
+ * param expected: The reference result
+ * param got: The result that was checked
+ */
+static void diverged(const char *test, long size, long index, double input, double expected, double got) {
+
+	if(divergences < CHECK_REPORT_MAX) {
+
+		printf("  %s: size %ld element %ld: %.9g gave %.9g, expected %.9g\n", test, size, index, input, got, expected);
+	}
+	divergences++;
+}
+
+/*
+ * Starts counting divergences for a test
+ */
+static void startTest() {
+
+	divergences = 0;
+}
+
+/*
+ * Prints the result of a test
+ * param test: The name of the test
+ * param cases: The number of cases it checked
+ */
+static void endTest(const char *test, long cases) {
+
+	printf("%-12s %6ld cases, %ld divergences\n", test, cases, divergences);
+	totalDivergences += divergences;
+}
+
+/*
+ * A vector of a random size that starts up to CHECK_MAX_OFFSET elements past an
+ * aligned address. Half of the sizes are small enough to be all tail.
+ * param buffer: Set to the memory that has to be freed
+ * param huge: false if the largest float can't be an element
+ * return: The vector, which is not freed itself
+ */
+static struct Vector randomVector(Elem **buffer, bool huge) {
+
+	struct Vector vector;
+	vector.size = next()%2 == 0 ? between(1, 67) : between(1, CHECK_MAX_SIZE);
+
+	long offset = between(0, CHECK_MAX_OFFSET);
+	*buffer = malloc((vector.size + CHECK_MAX_OFFSET)*sizeof(Elem));
+	checkAlloc(*buffer);
+	vector.elements = *buffer + offset;
+	vector.sparse = NULL;
+	vector.packed = NULL;
+
+	long i;
+	for(i = 0; i < vector.size; i++) {
+
+		vector.elements[i] = randomElem(huge);
+	}
+
+return vector;
+}
+
+/*
+ * Checks each element-wise kernel against a scalar loop on random vectors and
+ * values, through each path of sweep() as well as the kernel as vecalc calls
+ * it. The results have to be identical, apart from which NaN.
+ * param cases: Vectors checked for each kernel and path
+ */
+static void checkKernels(long cases) {
+
+	const char *pathNames[] = {"", " scalar", " simd", " threads"};
+
+	/*Every kernel, through every path*/
+	int k;
+	for(k = 0; k < 4*(PATH_THREADS + 1); k++) {
+
+		char option = CHECK_KERNELS[k/(PATH_THREADS + 1)];
+		enum Path path = k%(PATH_THREADS + 1);
+		char test[32];
+		sprintf(test, "%c%s", option, pathNames[path]);
+
+		startTest();
+
+		long c;
+		for(c = 0; c < cases; c++) {
+
+			Elem *buffer;
+			struct Vector vector = randomVector(&buffer, true);
+
+			Elem value = randomElem(true);
+
+			/*Division by zero is an error, and leaves the vector alone*/
+			if(option == '/' && value == 0) {
+
+				value = 1;
+			}
+
+			Elem *input = malloc(vector.size*sizeof(Elem));
+			checkAlloc(input);
+			memcpy(input, vector.elements, vector.size*sizeof(Elem));
+
+			if(path == PATH_AUTO) {
+
+				kernel(option, &vector, value);
+			}
+			else {
+
+				sweep(&vector, option, value, path);
+			}
+
+			long i;
+			for(i = 0; i < vector.size; i++) {
+
+				Elem expected = reference(option, input[i], value);
+				Elem got = vector.elements[i];
+
+				if(expected != expected && got != got) {
+
+					continue;
+				}
+
+				long ulps = (long)toBits(got) - (long)toBits(expected);
+
+				if((ulps < 0 ? -ulps : ulps) > CHECK_KERNEL_ULPS) {
+
+					diverged(test, vector.size, i, input[i], expected, got);
+				}
+			}
+			free(input);
+			free(buffer);
+		}
+		endTest(test, cases);
+	}
+}
+
+/*
+ * Checks magnitude() against a scalar sum, to within CHECK_SUM_BOUND
+ * param cases: Vectors checked
+ */
+static void checkMagnitude(long cases) {
+
+	startTest();
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		Elem *buffer;
+		struct Vector vector = randomVector(&buffer, false);
+
+		Elem expected = 0;
+		double absoluteSum = 0;
+
+		long i;
+		for(i = 0; i < vector.size; i++) {
+
+			expected += vector.elements[i];
+			absoluteSum += vector.elements[i] < 0 ? -(double)vector.elements[i] : vector.elements[i];
+		}
+
+		Elem got = magnitude(&vector);
+		bool same;
+
+		/*NaN is NaN, however it was added up, and an infinity has a sign*/
+		if(notFinite(expected) || notFinite(got)) {
+
+			same = (expected != expected && got != got) || expected == got;
+		}
+		else {
+
+			double error = (double)got - expected;
+			same = (error < 0 ? -error : error) <= CHECK_SUM_BOUND(vector.size, absoluteSum);
+		}
+
+		if(!same) {
+
+			diverged("magnitude", vector.size, -1, absoluteSum, expected, got);
+		}
+		free(buffer);
+	}
+	endTest("magnitude", cases);
+}
+
+/*
+ * Runs a chain of commands on an element one at a time
+ * param cmds: The chain
+ * param count: The number of commands in it
+ * param element: The element
+ * return: The result
+ */
+static Elem runChain(struct Command *cmds, int count, Elem element) {
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		element = reference(cmds[i].option, element, cmds[i].value);
+	}
+
+return element;
+}
+
+/*
+ * A random command for a chain. Values that cancel the command before them,
+ * have no effect, or are powers of two, are picked often so the optimizer
+ * drops commands as well as folding them.
+ * param cmd: Filled with the command
+ * param before: The command before it, or NULL
+ */
+static void randomCommand(struct Command *cmd, struct Command *before) {
+
+	memset(cmd, 0, sizeof(struct Command));
+	cmd->option = CHECK_KERNELS[between(0, 3)];
+
+	bool additive = cmd->option == '+' || cmd->option == '-';
+	int pick = between(0, 7);
+
+	if(pick == 0) {
+
+		/*Either zero, since + 0 and - -0 turn -0 into +0*/
+		cmd->value = additive ? fromBits((next() & 1) << 31) : 1;
+	}
+	else if(pick == 1 && before != NULL) {
+
+		switch(before->option) {
+
+			case '+':	cmd->option = '-'; break;
+			case '-':	cmd->option = '+'; break;
+			case '*':	cmd->option = '/'; break;
+			default:	cmd->option = '*'; break;
+		}
+		cmd->value = before->value;
+	}
+	else if(additive) {
+
+		cmd->value = randomFinite();
+	}
+	else if(pick == 2) {
+
+		/*From 1/16 to 16, and from 2^100 to 2^127 so a chain can overflow*/
+		int exponent = next()%2 == 0 ? between(123, 131) : between(227, 254);
+		cmd->value = fromBits((next() & 1) << 31 | (uint32_t)exponent << 23);
+	}
+	else {
+
+		/*From 1/16 to 16, so no chain overflows or underflows a normal float*/
+		cmd->value = fromBits((next() & 1) << 31 | (uint32_t)between(123, 130) << 23 | (next() & 0x007FFFFF));
+	}
+}
+
+/*
+ * Runs random chains of commands through the optimizer and the kernels, and
+ * checks them against the same chains run one command at a time on a scalar
+ * loop. The results have to be identical, apart from which NaN.
+ * param cases: Chains checked
+ */
+static void checkChains(long cases) {
+
+	startTest();
+
+	struct Command chain[CHECK_CHAIN_MAX];
+	struct Command optimized[CHECK_CHAIN_MAX + 1];
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		int count = between(2, CHECK_CHAIN_MAX);
+
+		int i;
+		for(i = 0; i < count; i++) {
+
+			randomCommand(&chain[i], i > 0 ? &chain[i - 1] : NULL);
+		}
+		/*
+		 * After an append the optimizer knows the vector isn't empty, so
+		 * it can drop and fold commands without losing a diagnostic. The
+		 * append is always kept, and isn't run.
+		 */
+		memset(optimized, 0, sizeof(struct Command));
+		optimized[0].option = 'a';
+		memcpy(optimized + 1, chain, count*sizeof(struct Command));
+		int kept = optimizeCommands(optimized, count + 1, NULL);
+
+		Elem *buffer;
+		struct Vector vector = randomVector(&buffer, false);
+
+		Elem *input = malloc(vector.size*sizeof(Elem));
+		checkAlloc(input);
+		memcpy(input, vector.elements, vector.size*sizeof(Elem));
+
+		for(i = 1; i < kept; i++) {
+
+			kernel(optimized[i].option, &vector, optimized[i].value);
+		}
+
+		long e;
+		for(e = 0; e < vector.size; e++) {
+
+			Elem expected = runChain(chain, count, input[e]);
+			Elem got = vector.elements[e];
+
+			if(expected != expected && got != got) {
+
+				continue;
+			}
+
+			long ulps = (long)toBits(got) - (long)toBits(expected);
+
+			if((ulps < 0 ? -ulps : ulps) > CHECK_CHAIN_ULPS) {
+
+				diverged("chain", vector.size, e, input[e], expected, got);
+
+				if(divergences <= CHECK_REPORT_MAX) {
+
+					printf("    chain:");
+
+					for(i = 0; i < count; i++) {
+
+						printf(" %c %.9g", chain[i].option, chain[i].value);
+					}
+					printf("\n    optimized:");
+
+					for(i = 1; i < kept; i++) {
+
+						printf(" %c %.9g", optimized[i].option, optimized[i].value);
+					}
+					printf("\n");
+				}
+			}
+		}
+		free(input);
+		free(buffer);
+	}
+	endTest("chain", cases);
+}
+
+/*
+ * Checks that a sparse vector is the dense vector it stands for, and that they
+ * sum to the same, bit for bit apart from which NaN
+ * param test: The name of the test
+ * param sparse: The vector that may be sparse
+ * param dense: The dense vector
+ */
+static void compareForms(const char *test, struct Vector *sparse, struct Vector *dense) {
+
+	if(sparse->size != dense->size) {
+
+		diverged(test, dense->size, -1, 0, dense->size, sparse->size);
+		return;
+	}
+
+	struct Vector *filled = copy_vec(sparse);
+
+	long i;
+	for(i = 0; i < dense->size; i++) {
+
+		Elem expected = dense->elements[i];
+		Elem got = filled->elements[i];
+
+		if(!(expected != expected && got != got) && toBits(expected) != toBits(got)) {
+
+			diverged(test, dense->size, i, 0, expected, got);
+		}
+	}
+	dealloc_vec(filled);
+
+	Elem expected = magnitude(dense);
+	Elem got = magnitude(sparse);
+
+	if(!(expected != expected && got != got) && toBits(expected) != toBits(got)) {
+
+		diverged("sparse sum", dense->size, -1, 0, expected, got);
+	}
+}
+
+/*
+ * Runs random chains of commands and appends on vectors that are mostly 0, once
+ * sparse and once dense, letting the sparse one switch forms the way vecalc
+ * does after each command. Both have to hold the same elements throughout.
+ * param cases: Chains checked
+ */
+static void checkSparse(long cases) {
+
+	startTest();
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		struct Vector *sparse = alloc_vec();
+		struct Vector *dense = alloc_vec();
+		long size = between(SPARSE_MIN_SIZE, MAXVECSIZE/2);
+		int every = between(SPARSE_DENSITY*2, 1024);
+
+		Elem *values = malloc(size*sizeof(Elem));
+		checkAlloc(values);
+
+		long i;
+		for(i = 0; i < size; i++) {
+
+			values[i] = next()%every == 0 ? randomElem(false) : 0;
+		}
+		append_vec(sparse, values, size);
+		append_vec(dense, values, size);
+		free(values);
+
+		if(!sparsify(sparse)) {
+
+			diverged("sparsify", size, -1, 0, 1, 0);
+		}
+
+		int count = between(2, CHECK_CHAIN_MAX);
+		struct Command cmd;
+		struct Command before;
+
+		int k;
+		for(k = 0; k < count; k++) {
+
+			randomCommand(&cmd, k > 0 ? &before : NULL);
+
+			/*Some chains zero the vector, some append to it*/
+			if(next()%8 == 0) {
+
+				cmd.option = '*';
+				cmd.value = 0;
+			}
+
+			/*Undoing * 0 would divide by zero*/
+			if(cmd.option == '/' && cmd.value == 0) {
+
+				cmd.value = 1;
+			}
+
+			if(next()%4 == 0 && sparse->size < MAXVECSIZE) {
+
+				Elem value = next()%2 == 0 ? randomElem(false) : sparse->sparse != NULL ? sparse->sparse->background : 0;
+				struct Vector *bigger = extend_vec(sparse, value);
+				dealloc_vec(sparse);
+				sparse = bigger;
+				bigger = extend_vec(dense, value);
+				dealloc_vec(dense);
+				dense = bigger;
+				settle_vec(sparse, 'a', value);
+			}
+			else {
+
+				kernel(cmd.option, sparse, cmd.value);
+				kernel(cmd.option, dense, cmd.value);
+				settle_vec(sparse, cmd.option, cmd.value);
+			}
+			before = cmd;
+		}
+		/*Half the time through densify() instead of copy_vec()*/
+		if(next()%2 == 0) {
+
+			densify(sparse);
+		}
+		compareForms("sparse", sparse, dense);
+
+		dealloc_vec(sparse);
+		dealloc_vec(dense);
+	}
+	endTest("sparse", cases);
+}
+
+/*
+ * Runs random chains of commands and appends on packed vectors, in each
+ * storage, against a scalar loop that rounds every element the way the storage
+ * keeps it after every command. Lossless storage has to give the same bits as
+ * a dense vector, and 16 bit storage the same bits as 16 bit elements would.
+ * param cases: Chains checked in each storage
+ */
+static void checkPacked(long cases) {
+
+	const char *names[] = {"", "pack bf16", "pack fp16", "pack xor"};
+
+	int s;
+	for(s = STORAGE_BF16; s <= STORAGE_XOR; s++) {
+
+		enum Storage storage = s;
+		startTest();
+
+		long c;
+		for(c = 0; c < cases; c++) {
+
+			Elem *buffer;
+			struct Vector vector = randomVector(&buffer, false);
+
+			/*Runs of the same element, as well as random ones*/
+			long i;
+			for(i = 1; i < vector.size; i++) {
+
+				if(next()%4 == 0) {
+
+					vector.elements[i] = vector.elements[i - 1];
+				}
+			}
+			struct Vector *packed = copy_vec(&vector);
+			pack_vec(packed, storage, NULL);
+
+			for(i = 0; i < vector.size; i++) {
+
+				vector.elements[i] = storage_round(storage, vector.elements[i]);
+			}
+			struct Vector *expected = copy_vec(&vector);
+			free(buffer);
+
+			int count = between(1, CHECK_CHAIN_MAX);
+			struct Command cmd;
+			struct Command before;
+
+			int k;
+			for(k = 0; k < count; k++) {
+
+				randomCommand(&cmd, k > 0 ? &before : NULL);
+
+				if(next()%4 == 0) {
+
+					Elem value = randomElem(false);
+					append_vec(packed, &value, 1);
+					value = storage_round(storage, value);
+					append_vec(expected, &value, 1);
+				}
+				else {
+
+					kernel(cmd.option, packed, cmd.value);
+
+					for(i = 0; i < expected->size; i++) {
+
+						expected->elements[i] = storage_round(storage, reference(cmd.option, expected->elements[i], cmd.value));
+					}
+				}
+				before = cmd;
+			}
+			compareForms(names[storage], packed, expected);
+
+			dealloc_vec(packed);
+			dealloc_vec(expected);
+		}
+		endTest(names[storage], cases);
+	}
+}
+
+/*
+ * Checks diff_vec() on vectors large enough to be split over threads against
+ * the same comparison made in parts small enough for one thread each
+ * param cases: Vectors checked
+ */
+static void checkDiff(long cases) {
+
+	startTest();
+
+	struct Tolerance tolerance = {0, 0, 4};
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		struct Vector vector;
+		struct Vector other;
+		vector.size = between(2*DIFF_PARALLEL_MIN, 4*DIFF_PARALLEL_MIN + 17);
+		other.size = vector.size;
+		vector.elements = malloc(vector.size*sizeof(Elem));
+		other.elements = malloc(other.size*sizeof(Elem));
+		checkAlloc(vector.elements);
+		checkAlloc(other.elements);
+
+		/*Mostly the same, some a few ulps apart and some far apart*/
+		long i;
+		for(i = 0; i < vector.size; i++) {
+
+			vector.elements[i] = randomElem(true);
+			other.elements[i] = vector.elements[i];
+
+			if(next()%64 == 0) {
+
+				other.elements[i] = fromBits(toBits(vector.elements[i]) + between(1, 8));
+			}
+			else if(next()%256 == 0) {
+
+				other.elements[i] = randomElem(true);
+			}
+		}
+
+		struct DiffResult threaded;
+		diff_vec(&vector, &other, &tolerance, DIFF_FIRST_MAX, &threaded);
+
+		/*The same comparison, one thread at a time*/
+		struct DiffResult serial;
+		memset(&serial, 0, sizeof(struct DiffResult));
+
+		long start;
+		for(start = 0; start < vector.size; start += DIFF_PARALLEL_MIN - 1) {
+
+			struct Vector part;
+			struct Vector otherPart;
+			part.elements = vector.elements + start;
+			otherPart.elements = other.elements + start;
+			part.size = vector.size - start < DIFF_PARALLEL_MIN - 1 ? vector.size - start : DIFF_PARALLEL_MIN - 1;
+			otherPart.size = part.size;
+
+			struct DiffResult result;
+			diff_vec(&part, &otherPart, &tolerance, DIFF_FIRST_MAX, &result);
+
+			for(i = 0; i < result.firstCount && serial.firstCount < DIFF_FIRST_MAX; i++) {
+
+				serial.first[serial.firstCount++] = result.first[i] + start;
+			}
+			serial.mismatches += result.mismatches;
+
+			if(result.maxError > serial.maxError) {
+
+				serial.maxError = result.maxError;
+			}
+		}
+
+		bool same = threaded.compared == vector.size && threaded.mismatches == serial.mismatches && threaded.maxError == serial.maxError && threaded.firstCount == serial.firstCount;
+
+		for(i = 0; same && i < serial.firstCount; i++) {
+
+			same = threaded.first[i] == serial.first[i];
+		}
+
+		if(!same) {
+
+			diverged("diff", vector.size, -1, 0, serial.mismatches, threaded.mismatches);
+		}
+		free(vector.elements);
+		free(other.elements);
+	}
+	endTest("diff", cases);
+}
+
+/*
+ * Copies and grows vectors with each placement that pins threads, and sweeps
+ * the copies over threads split the same way. The copies have to hold the same
+ * elements, and the sweeps give what the scalar loop does.
+ * param cases: Vectors checked with each placement
+ */
+static void checkPlacement(long cases) {
+
+	const char *names[] = {"", "interleave", "chunk"};
+	struct Tuning saved = tuning;
+
+	/*Every copy large enough to place is copied in parts*/
+	tuning.threadMin = CHECK_PLACE_MIN_SIZE;
+
+	int p;
+	for(p = PLACE_INTERLEAVE; p <= PLACE_CHUNK; p++) {
+
+		tuning.placement = p;
+		startTest();
+
+		long c;
+		for(c = 0; c < cases; c++) {
+
+			struct Vector vector;
+			vector.size = between(CHECK_PLACE_MIN_SIZE, MAXVECSIZE - 1);
+			vector.elements = malloc(vector.size*sizeof(Elem));
+			vector.sparse = NULL;
+			vector.packed = NULL;
+			checkAlloc(vector.elements);
+
+			long i;
+			for(i = 0; i < vector.size; i++) {
+
+				vector.elements[i] = randomElem(true);
+			}
+
+			char option = CHECK_KERNELS[next()%4];
+			Elem value = randomElem(true);
+
+			if(option == '/' && value == 0) {
+
+				value = 1;
+			}
+
+			struct Vector *copy = copy_vec(&vector);
+			struct Vector *bigger = extend_vec(&vector, value);
+			sweep(copy, option, value, PATH_THREADS);
+
+			for(i = 0; i < vector.size; i++) {
+
+				Elem expected = reference(option, vector.elements[i], value);
+				Elem got = copy->elements[i];
+
+				if(!(expected != expected && got != got) && toBits(expected) != toBits(got)) {
+
+					diverged(names[p], vector.size, i, vector.elements[i], expected, got);
+				}
+
+				if(toBits(bigger->elements[i]) != toBits(vector.elements[i])) {
+
+					diverged(names[p], vector.size, i, vector.elements[i], vector.elements[i], bigger->elements[i]);
+				}
+			}
+
+			if(bigger->size != vector.size + 1 || toBits(bigger->elements[vector.size]) != toBits(value)) {
+
+				diverged(names[p], vector.size, vector.size, value, value, bigger->elements[vector.size]);
+			}
+			dealloc_vec(copy);
+			dealloc_vec(bigger);
+			free(vector.elements);
+		}
+		endTest(names[p], cases);
+	}
+	tuning = saved;
+}
+
+/*What the reader of a shared vector sees while the writer changes it*/
+struct EpochReader {
+
+	struct Epochs *epochs;
+	bool done;
+	long snapshots;
+	long torn;		/*Snapshots that changed while they were held*/
+};
+
+/*
+ * Takes snapshots until the writer is done. Every element the writer publishes
+ * is the same, so a snapshot that isn't, or that changes while it is held, is a
+ * mix of versions. Each snapshot is held while the writer gets a turn.
+ * param arg: The EpochReader
+ * return: NULL
+ */
+static void *readEpochs(void *arg) {
+
+	struct EpochReader *reader = arg;
+
+	while(!__atomic_load_n(&reader->done, __ATOMIC_SEQ_CST)) {
+
+		struct Vector version;
+		long epoch;
+		int slot = epoch_enter(reader->epochs, &version, &epoch);
+		Elem first = version.size > 0 ? version.elements[0] : 0;
+		sched_yield();
+
+		long i;
+		for(i = 0; i < version.size; i++) {
+
+			/*Apart from which NaN, which the kernels don't keep*/
+			Elem element = version.elements[i];
+			bool bothNaN = element != element && first != first;
+
+			if(!bothNaN && toBits(element) != toBits(first)) {
+
+				reader->torn++;
+				break;
+			}
+		}
+		epoch_exit(reader->epochs, slot);
+		reader->snapshots++;
+	}
+
+return NULL;
+}
+
+/*
+ * Changes a shared vector with random operations, appends and clears while
+ * other threads take snapshots of it. Every element is kept the same, and
+ * checked against the scalar loop after each change; the readers check that
+ * no snapshot mixes two versions.
+ * param cases: Shared vectors checked
+ */
+static void checkEpochs(long cases) {
+
+	startTest();
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		struct Vector vector;
+		vector.size = 0;
+		vector.elements = NULL;
+		vector.sparse = NULL;
+		vector.packed = NULL;
+
+		struct Epochs *epochs = epoch_share(&vector, 0);
+		checkAlloc(epochs);
+
+		struct EpochReader readers[2];
+		pthread_t threads[2];
+
+		int r;
+		for(r = 0; r < 2; r++) {
+
+			memset(&readers[r], 0, sizeof(struct EpochReader));
+			readers[r].epochs = epochs;
+			pthread_create(&threads[r], NULL, readEpochs, &readers[r]);
+		}
+
+		Elem element = randomElem(false);
+		Elem *values = malloc(CHECK_MAX_SIZE*sizeof(Elem));
+		checkAlloc(values);
+
+		int k;
+		for(k = 0; k < CHECK_EPOCH_CHANGES; k++) {
+
+			long kind = next()%16;
+
+			if(kind == 0) {
+
+				epoch_clear(epochs, &vector);
+			}
+			else if(kind < 6 || vector.size == 0) {
+
+				long count = between(1, vector.size < MAXVECSIZE ? 67 : 1);
+
+				long i;
+				for(i = 0; i < count; i++) {
+
+					values[i] = element;
+				}
+				if(!epoch_append(epochs, &vector, values, count)) {
+
+					diverged("epochs", vector.size, -1, count, 0, 0);
+				}
+			}
+			else {
+
+				char option = CHECK_KERNELS[next()%4];
+				Elem value = randomElem(false);
+
+				if(option == '/' && value == 0) {
+
+					value = 1;
+				}
+				if(!epoch_sweep(epochs, &vector, option, value)) {
+
+					diverged("epochs", vector.size, -1, value, 0, 0);
+				}
+				element = reference(option, element, value);
+			}
+
+			long i;
+			for(i = 0; i < vector.size; i++) {
+
+				/*Apart from which NaN, which the kernels don't keep*/
+				bool bothNaN = vector.elements[i] != vector.elements[i] && element != element;
+
+				if(!bothNaN && toBits(vector.elements[i]) != toBits(element)) {
+
+					diverged("epochs", vector.size, i, 0, element, vector.elements[i]);
+					break;
+				}
+			}
+
+			/*Gives the readers a turn even with one CPU*/
+			sched_yield();
+		}
+
+		for(r = 0; r < 2; r++) {
+
+			__atomic_store_n(&readers[r].done, true, __ATOMIC_SEQ_CST);
+			pthread_join(threads[r], NULL);
+
+			if(readers[r].torn > 0) {
+
+				diverged("epochs", vector.size, -1, readers[r].snapshots, 0, readers[r].torn);
+			}
+		}
+		free(values);
+		epoch_free(epochs);
+	}
+	endTest("epochs", cases);
+}
+
+/*
+ * Restores a session from the snapshot and checks that it is the session
+ * that was written
+ * param written: The session that was written
+ * param elements: What its vector held, dense
+ * param restored: Filled with the restored session, which has to be freed
+ */
+static void checkRestored(struct Session *written, struct Vector *elements, struct Session *restored) {
+
+	init_session(restored, stdout, stdout);
+
+	if(!snapshot_restore(restored, CHECK_SNAP_PATH)) {
+
+		diverged("snapshot", elements->size, -1, 0, 1, 0);
+		return;
+	}
+	compareForms("snapshot", restored->vec, elements);
+
+	if(restored->storage != written->storage || restored->format != written->format || restored->line != written->line) {
+
+		diverged("snapshot", elements->size, -1, written->line, written->storage, restored->storage);
+	}
+
+	if((restored->vec->packed != NULL) != (written->vec->packed != NULL) || restored->lastLine == NULL || strcmp(restored->lastLine, written->lastLine) != 0) {
+
+		diverged("snapshot", elements->size, -1, 0, written->vec->packed != NULL, restored->vec->packed != NULL);
+	}
+}
+
+/*
+ * Writes snapshots of sessions with random vectors in every form, restores
+ * them, and checks that the same vector, storage, format and line come back.
+ * The restored vector is then changed, in place and by appending, which has to
+ * give the same results as the vector written, and leave the snapshot alone.
+ * param cases: Snapshots checked
+ */
+static void checkSnapshots(long cases) {
+
+	startTest();
+
+	long c;
+	for(c = 0; c < cases; c++) {
+
+		struct Session session;
+		init_session(&session, stdout, stdout);
+
+		Elem *buffer;
+		struct Vector vector = randomVector(&buffer, false);
+		long form = next()%3;
+
+		/*Mostly 0, so that it can be made sparse*/
+		long i;
+		for(i = 0; form == SNAP_SPARSE && i < vector.size; i++) {
+
+			vector.elements[i] = next()%(SPARSE_DENSITY*2) == 0 ? vector.elements[i] : 0;
+		}
+		append_vec(session.vec, vector.elements, vector.size);
+		free(buffer);
+
+		if(form == SNAP_SPARSE) {
+
+			sparsify(session.vec);
+		}
+		else if(form == SNAP_PACKED) {
+
+			session.storage = between(STORAGE_BF16, STORAGE_XOR);
+			pack_vec(session.vec, session.storage, NULL);
+		}
+		session.format = between(FORMAT_TEXT, FORMAT_BINARY);
+		session.line = between(0, 1000000);
+		session.lastLine = malloc(32);
+		checkAlloc(session.lastLine);
+		sprintf(session.lastLine, "a %ld * %ld", between(0, 99), between(0, 99));
+
+		struct Vector *elements = copy_vec(session.vec);
+
+		if(!snapshot_write(&session, CHECK_SNAP_PATH, session.line)) {
+
+			diverged("snapshot", elements->size, -1, 0, 1, 0);
+			dealloc_vec(elements);
+			free_session(&session);
+			continue;
+		}
+
+		struct Session restored;
+		checkRestored(&session, elements, &restored);
+
+		/*Copy on write, and the move out of the mapping an append makes*/
+		if(restored.vec->packed == NULL) {
+
+			struct Vector *expected = copy_vec(elements);
+			char option = CHECK_KERNELS[next()%4];
+			Elem value = randomElem(false);
+			value = option == '/' && value == 0 ? 1 : value;
+
+			kernel(option, restored.vec, value);
+			kernel(option, expected, value);
+			append_vec(restored.vec, &value, 1);
+			append_vec(expected, &value, 1);
+			compareForms("snapshot", restored.vec, expected);
+			dealloc_vec(expected);
+		}
+		free_session(&restored);
+
+		checkRestored(&session, elements, &restored);
+		free_session(&restored);
+
+		dealloc_vec(elements);
+		free_session(&session);
+	}
+	remove(CHECK_SNAP_PATH);
+	endTest("snapshot", cases);
+}
+
+/*
+ * Checks the kernels, magnitude(), optimized chains and threaded comparison
+ * against the scalar loops they replace, sparse and packed vectors against dense
+ * ones, placed copies against the vectors they copy, and the snapshots of a
+ * shared vector for mixed versions, and that snapshots restore the session
+ * they were written from. Each --seed checks
+ * different cases; a divergence is printed with the seed so it can be run again.
+ *
+ * Usage: vecalcCheck [--seed n] [--cases n]
+ */
+int main(int argc, char *argv[]) {
+
+	uint64_t seed = 1;
+	long cases = 200;
+
+	int i;
+	for(i = 1; i + 1 < argc; i += 2) {
+
+		if(strcmp(argv[i], "--seed") == 0) {
+
+			seed = strtoul(argv[i + 1], NULL, 10);
+		}
+		else if(strcmp(argv[i], "--cases") == 0 && atol(argv[i + 1]) > 0) {
+
+			cases = atol(argv[i + 1]);
+		}
+		else {
+
+			break;
+		}
+	}
+
+	if(i < argc) {
+
+		fprintf(stderr, "Usage: vecalcCheck [--seed n] [--cases n]\n");
+		return EXIT_FAILURE;
+	}
+
+	state = seed;
+	printf("seed %lu\n", (unsigned long)seed);
+
+	checkKernels(cases);
+	checkMagnitude(cases);
+	checkChains(cases);
+	checkDiff(cases/50 > 0 ? cases/50 : 1);
+	checkSparse(cases);
+	checkPacked(cases);
+	checkPlacement(cases/50 > 0 ? cases/50 : 1);
+	checkEpochs(cases/50 > 0 ? cases/50 : 1);
+	checkSnapshots(cases/10 > 0 ? cases/10 : 1);
+
+	if(totalDivergences > 0) {
+
+		printf("%ld divergences with seed %lu\n", totalDivergences, (unsigned long)seed);
+		return EXIT_FAILURE;
+	}
+
+return EXIT_SUCCESS;
+}
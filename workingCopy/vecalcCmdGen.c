@@ -1,49 +1,478 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vecalcCmdGen.c						//
+ * Synopsis	:	Generates reproducible workloads of vecalc commands	//
+ * 			as text or binary records				//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
 #include <stdlib.h>
 #include <stdio.h>
-#include <time.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vecalc.h" /*For MAXVECSIZE*/
+#include "vectorBin.h" /*For definition of a BinaryRecord*/
+#include "vectorIn.h" /*For MAX_INPUT_LENGTH*/
+
+/*The options a workload can be made of*/
+#define GEN_OPTIONS "a+-*/mpcrxbtk"
+
+/*Most values a single binary a record appends when growing the vector*/
+#define GEN_PAYLOAD_MAX 4096
+
+/*
+ * How the target size of the vector changes over the workload. flat holds it
+ * at --size, ramp grows it from zero to --size over all the lines, and saw
+ * grows it to --size and clears the vector four times over.
+ */
+enum Profile {
+
+	PROFILE_FLAT,
+	PROFILE_RAMP,
+	PROFILE_SAW
+};
+
+/*Everything that decides what a workload looks like*/
+struct Workload {
+
+	uint64_t seed;
+	long lines;
+	int weights[sizeof(GEN_OPTIONS) - 1];
+	int minTokens;
+	int maxTokens;
+	long size;
+	enum Profile profile;
+	bool binary;
+};
+
+/*
+ * What a line does to the size of the vector, so that a repeat of it can be
+ * followed. A line that clears the vector leaves it with appended elements,
+ * any other line adds appended elements to it.
+ */
+struct LineEffect {
+
+	bool cleared;
+	long appended;
+};
+
+/*State of the random number generator. Workloads only depend on the seed*/
+static uint64_t state;
+
+/*
+ * The next number from splitmix64, which gives the same sequence on every
+ * machine and C library, unlike rand()
+ * return: A random 64 bit number
+ */
+static uint64_t next() {
+
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+
+return z ^ (z >> 31);
+}
+
+/*
+ * A random number in a range
+ * param low: The smallest number
+ * param high: The largest number
+ * return: A number from low to high, inclusive
+ */
+static long between(long low, long high) {
+
+return low + (long)(next()%(uint64_t)(high - low + 1));
+}
+
+/*
+ * Picks an option by weight
+ * param work: The workload, with the weight of each option
+ * param allowRepeat: false if r can't be picked
+ * return: The option, or 0 if every allowed weight is zero
+ */
+static char pickOption(struct Workload *work, bool allowRepeat) {
+
+	long total = 0;
+
+	int i;
+	for(i = 0; GEN_OPTIONS[i] != '\0'; i++) {
+
+		if(GEN_OPTIONS[i] != 'r' || allowRepeat) {
+
+			total += work->weights[i];
+		}
+	}
+
+	if(total == 0) {
+
+		return 0;
+	}
+
+	long pick = between(0, total - 1);
+
+	for(i = 0; GEN_OPTIONS[i] != '\0'; i++) {
+
+		if(GEN_OPTIONS[i] == 'r' && !allowRepeat) {
+
+			continue;
+		}
+
+		if(pick < work->weights[i]) {
+
+			break;
+		}
+		pick -= work->weights[i];
+	}
+
+return GEN_OPTIONS[i];
+}
+
+/*
+ * The size the vector should be at a line of the workload
+ * param work: The workload
+ * param line: The line, counting from 0
+ * return: The target size
+ */
+static long targetSize(struct Workload *work, long line) {
+
+	long period = work->lines/4 > 0 ? work->lines/4 : 1;
+
+	switch(work->profile) {
+
+		case PROFILE_RAMP:	return work->size*(line + 1)/work->lines;
+
+		case PROFILE_SAW:	return work->size*(line%period + 1)/period;
+
+		default:		return work->size;
+	}
+}
+
+/*
+ * The value an option is given. * and / are kept small so the elements
+ * wander instead of running off to infinity, and never divide by zero.
+ * param option: The option
+ * return: The value
+ */
+static long valueFor(char option) {
+
+	switch(option) {
+
+		case '*':
+		case '/':	return between(1, 9);
+
+		case 'b':
+		case 't':
+		case 'k':	return between(1, 10);
+
+		case 'x':	return 0;
+
+		default:	return between(0, 99);
+	}
+}
+
+/*
+ * Writes one binary record
+ * param out: Where it is written
+ * param option: The option
+ * param value: Its value
+ * param payload: The number of values that follow it
+ */
+static void writeRecord(FILE *out, char option, float value, uint32_t payload) {
+
+	struct BinaryRecord rec;
+	memset(&rec, 0, sizeof(struct BinaryRecord));
+	rec.opcode = option;
+	rec.length = payload;
+	rec.operand.f = value;
+
+	fwrite(&rec, sizeof(struct BinaryRecord), 1, out);
+}
+
+/*
+ * Writes a whole workload
+ * param work: What the workload looks like
+ * param out: Where it is written
+ */
+static void generate(struct Workload *work, FILE *out) {
+
+	/*Size of the vector vecalc will have after each command*/
+	long size = 0;
+
+	/*What the last text line did, for when the next one repeats it*/
+	struct LineEffect last = {false, 0};
+
+	float payload[GEN_PAYLOAD_MAX];
+
+	long line;
+	for(line = 0; line < work->lines; line++) {
+
+		long target = targetSize(work, line);
+
+		if(target > MAXVECSIZE) {
+
+			target = MAXVECSIZE;
+		}
+
+		/*The saw clears the vector at the start of every tooth*/
+		if(work->profile == PROFILE_SAW && target < size) {
+
+			if(work->binary) {
+
+				writeRecord(out, 'c', 0, 0);
+			}
+			else {
+
+				fprintf(out, "c\n");
+			}
+			size = 0;
+			last.cleared = true;
+			last.appended = 0;
+		}
+
+		char text[MAX_INPUT_LENGTH];
+		int length = 0;
+		struct LineEffect effect = {false, 0};
+		int tokens = between(work->minTokens, work->maxTokens);
+
+		int t;
+		for(t = 0; t < tokens; t++) {
+
+			/*Growing to the target comes before the mix*/
+			if(size < target && work->binary) {
+
+				long count = target - size < GEN_PAYLOAD_MAX ? target - size : GEN_PAYLOAD_MAX;
+
+				long i;
+				for(i = 0; i < count; i++) {
+
+					payload[i] = between(0, 99);
+				}
+				writeRecord(out, 'a', 0, count);
+				fwrite(payload, sizeof(float), count, out);
+				size += count;
+				continue;
+			}
+
+			char option = size < target ? 'a' : pickOption(work, !work->binary && t == 0 && line > 0);
+
+			if(option == 0) {
+
+				break;
+			}
+
+			/*Appending to a full vector would only print a diagnostic*/
+			if(option == 'a' && size == MAXVECSIZE) {
+
+				continue;
+			}
+
+			char token[32];
+			int tokenLength;
+
+			if(option == 'r' || option == 'm' || option == 'p' || option == 'c') {
+
+				tokenLength = sprintf(token, "%c", option);
+			}
+			else {
+
+				tokenLength = sprintf(token, "%c %ld", option, valueFor(option));
+			}
+
+			/*Leave room for a space, the newline and the null terminator*/
+			if(!work->binary && length + tokenLength + 3 > MAX_INPUT_LENGTH) {
+
+				break;
+			}
+
+			if(option == 'a') {
+
+				size++;
+				effect.appended++;
+			}
+			else if(option == 'c') {
+
+				size = 0;
+				effect.cleared = true;
+				effect.appended = 0;
+			}
+			else if(option == 'r') {
+
+				/*The last line runs again before the rest of this one*/
+				size = last.cleared ? last.appended : size + last.appended;
+				effect = last;
+			}
+
+			if(work->binary) {
+
+				writeRecord(out, option, valueFor(option), 0);
+			}
+			else {
+
+				length += sprintf(text + length, "%s%s", length > 0 ? " " : "", token);
+			}
+		}
+
+		if(!work->binary && length > 0) {
+
+			fprintf(out, "%s\n", text);
+			last = effect;
+		}
+	}
+
+	if(work->binary) {
+
+		writeRecord(out, 'q', 0, 0);
+	}
+	else {
+
+		fprintf(out, "q\n");
+	}
+}
 
 /*
- * This program creates a text document that contains commands for the vecalc
- * execuatable according to the format specified in the fprintf statement. The
- * text document can then be redirected into vecalc to run vecalc.
+ * Reads the weights of the options from a list like "a:4,+:2,c:1". Options
+ * that aren't in the list keep their weight
+ * param work: The workload the weights are set in
+ * param list: The list
+ * return: false if the list has something that isn't an option and a weight
  */
-int main() {
+static bool parseMix(struct Workload *work, char *list) {
 
-	/*List of all the available commands in vecalc*/
-	char cmdsList[8] = {'a', '+', 'r', '*', 'm', '/', '-', 'c'};
+	char *item = strtok(list, ",");
 
-	/*Number of commands to print*/
-	int c = 200;
+	while(item != NULL) {
 
-	time_t t;
+		char *option = strchr(GEN_OPTIONS, item[0]);
 
-	srand(time(&t));
+		if(item[0] == '\0' || option == NULL || item[1] != ':' || atoi(item + 2) < 0) {
 
-	/*File for commands to be stored in*/
-	FILE *vecalcCmds;
-	vecalcCmds = fopen("vecalcCmds.txt", "w+");
+			return false;
+		}
+		work->weights[option - GEN_OPTIONS] = atoi(item + 2);
+		item = strtok(NULL, ",");
+	}
+
+return true;
+}
+
+/*
+ * Generates a workload of vecalc commands. The same arguments always give
+ * exactly the same workload, on any machine.
+ *
+ * Usage: vecalcCmdGen [--seed n] [--lines n] [--mix list] [--tokens min[-max]]
+ * [--size n] [--profile flat|ramp|saw] [--format text|binary] [--output path]
+ */
+int main(int argc, char *argv[]) {
+
+	struct Workload work;
+	memset(&work, 0, sizeof(struct Workload));
+	work.seed = 1;
+	work.lines = 800;
+	work.minTokens = 1;
+	work.maxTokens = 4;
+	work.profile = PROFILE_FLAT;
+
+	/*The options the original generator picked from, evenly*/
+	char *defaultMix = "a:1,+:1,r:1,*:1,m:1,/:1,-:1,c:1";
+	char mix[256];
+	strcpy(mix, defaultMix);
+	parseMix(&work, mix);
+
+	char *outputPath = NULL;
 
-	/*
-	 * rand() % x means generate random numbers between 1 and x
-	 */
 	int i;
-	for(i = 0; i < c; i++) {
+	for(i = 1; i < argc; i++) {
+
+		char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+		if(value == NULL) {
 
-		fprintf(vecalcCmds, "%c %d\n", cmdsList[rand() % 7], rand() % 100);
+			break;
+		}
+		else if(strcmp(argv[i], "--seed") == 0) {
+
+			work.seed = strtoul(value, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--lines") == 0 && atol(value) > 0) {
+
+			work.lines = atol(value);
+		}
+		else if(strcmp(argv[i], "--mix") == 0) {
+
+			if(!parseMix(&work, value)) {
+
+				break;
+			}
+		}
+		else if(strcmp(argv[i], "--tokens") == 0 && atoi(value) > 0) {
+
+			char *dash = strchr(value, '-');
+			work.minTokens = atoi(value);
+			work.maxTokens = dash != NULL ? atoi(dash + 1) : work.minTokens;
+
+			if(work.maxTokens < work.minTokens) {
+
+				break;
+			}
+		}
+		else if(strcmp(argv[i], "--size") == 0 && atol(value) >= 0) {
+
+			work.size = atol(value);
+		}
+		else if(strcmp(argv[i], "--profile") == 0 && strcmp(value, "flat") == 0) {
+
+			work.profile = PROFILE_FLAT;
+		}
+		else if(strcmp(argv[i], "--profile") == 0 && strcmp(value, "ramp") == 0) {
+
+			work.profile = PROFILE_RAMP;
+		}
+		else if(strcmp(argv[i], "--profile") == 0 && strcmp(value, "saw") == 0) {
+
+			work.profile = PROFILE_SAW;
+		}
+		else if(strcmp(argv[i], "--format") == 0 && (strcmp(value, "text") == 0 || strcmp(value, "binary") == 0)) {
+
+			work.binary = strcmp(value, "binary") == 0;
+		}
+		else if(strcmp(argv[i], "--output") == 0) {
+
+			outputPath = value;
+		}
+		else {
+
+			break;
+		}
+		i++;
 	}
-	for(i = 0; i < c; i++) {
 
-		fprintf(vecalcCmds, "%c %d %c %d\n", cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100);
+	if(i < argc) {
+
+		fprintf(stderr, "Usage: vecalcCmdGen [--seed n] [--lines n] [--mix a:1,+:1,...] [--tokens min[-max]] [--size n] [--profile flat|ramp|saw] [--format text|binary] [--output path]\n");
+		fprintf(stderr, "Options in the mix: %s\n", GEN_OPTIONS);
+		return EXIT_FAILURE;
 	}
-	for(i = 0; i < c; i++) {
 
-		fprintf(vecalcCmds, "%c %d %c %d %c %d\n", cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100);
+	FILE *out = outputPath == NULL ? stdout : fopen(outputPath, "wb");
+
+	if(out == NULL) {
+
+		fprintf(stderr, "Could not write %s\n", outputPath);
+		return EXIT_FAILURE;
 	}
-	for(i = 0; i < c; i++) {
 
-		fprintf(vecalcCmds, "%c %d %c %d %c %d %c %d\n", cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100, cmdsList[rand() % 7], rand() % 100);
+	state = work.seed;
+	generate(&work, out);
+
+	if(out != stdout) {
+
+		fclose(out);
 	}
-	fprintf(vecalcCmds, "q");
 
-return 0;
+return EXIT_SUCCESS;
 }
@@ -0,0 +1,307 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vecalcDrive.c						//
+ * Synopsis	:	Runs vecalc on a workload and reports how many lines	//
+ * 			and commands it got through a second			//
+ *==============================================================================//
+ */
+
+/*For clock_gettime()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*Local Headers*/
+#include "vectorBin.h" /*For definition of a BinaryRecord*/
+#include "vectorIn.h" /*For MAX_INPUT_LENGTH*/
+
+/*Most runs of a workload*/
+#define DRIVE_MAX_REPS 100
+
+/*The characters that are options of their own when they are a whole token*/
+#define DRIVE_OPTIONS "qecphmrfbtksxvda+-*/"
+
+/*The size of a workload, as vecalc sees it*/
+struct Counts {
+
+	long lines;
+	long ops;
+	bool binary;
+};
+
+/*
+ * Reads the monotonic clock
+ * return: The time in seconds
+ */
+static double now() {
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+return time.tv_sec + time.tv_nsec/1e9;
+}
+
+/*
+ * Orders two doubles from smallest to largest, for qsort()
+ * param a: A double
+ * param b: Another double
+ * return: Less than zero if a comes first, more than zero if b comes first
+ */
+static int ascending(const void *a, const void *b) {
+
+	double first = *(const double *)a;
+	double second = *(const double *)b;
+
+return (first > second) - (first < second);
+}
+
+/*
+ * Counts the lines of a text workload and the options run on them. A line that
+ * starts with r runs every option of the line before it again.
+ * param file: The workload
+ * param counts: Filled in with the counts
+ */
+static void countText(FILE *file, struct Counts *counts) {
+
+	char line[MAX_INPUT_LENGTH + 1];
+
+	/*Options run by the last line, which a repeat runs again*/
+	long last = 0;
+
+	while(fgets(line, sizeof(line), file) != NULL) {
+
+		long ops = 0;
+		bool first = true;
+
+		char *token = strtok(line, " \n");
+
+		/*vecalc stops at a blank line, the same as at a q*/
+		if(token == NULL) {
+
+			break;
+		}
+		counts->lines++;
+
+		while(token != NULL) {
+
+			if(first && strcmp(token, "r") == 0) {
+
+				ops += last;
+			}
+			else if(token[1] == '\0' && strchr(DRIVE_OPTIONS, token[0]) != NULL) {
+
+				ops++;
+			}
+			first = false;
+			token = strtok(NULL, " \n");
+		}
+		counts->ops += ops;
+		last = ops;
+	}
+}
+
+/*
+ * Counts the records of a binary workload. Every record is one option, and
+ * counts as one line.
+ * param file: The workload
+ * param counts: Filled in with the counts
+ */
+static void countBinary(FILE *file, struct Counts *counts) {
+
+	struct BinaryRecord rec;
+
+	while(fread(&rec, sizeof(struct BinaryRecord), 1, file) == 1) {
+
+		counts->lines++;
+		counts->ops++;
+
+		size_t width = (rec.flags & BIN_DOUBLE) ? sizeof(double) : sizeof(float);
+
+		if(rec.length > 0 && fseek(file, rec.length*width, SEEK_CUR) != 0) {
+
+			break;
+		}
+
+		if(rec.opcode == 'q' || rec.opcode == 'e') {
+
+			break;
+		}
+	}
+}
+
+/*
+ * Counts a workload, working out whether it is text or binary records from its
+ * first record, whose reserved bytes are zero
+ * param path: The path of the workload
+ * param counts: Filled in with the counts
+ * return: false if the workload couldn't be read
+ */
+static bool countWorkload(char *path, struct Counts *counts) {
+
+	FILE *file = fopen(path, "rb");
+
+	if(file == NULL) {
+
+		return false;
+	}
+
+	unsigned char head[sizeof(struct BinaryRecord)];
+	size_t have = fread(head, 1, sizeof(head), file);
+	rewind(file);
+
+	memset(counts, 0, sizeof(struct Counts));
+	counts->binary = have == sizeof(head) && head[1] <= BIN_DOUBLE && head[2] == 0 && head[3] == 0;
+
+	if(counts->binary) {
+
+		countBinary(file, counts);
+	}
+	else {
+
+		countText(file, counts);
+	}
+	fclose(file);
+
+return true;
+}
+
+/*
+ * Runs vecalc once with the workload as its input and its output thrown away
+ * param argv: The arguments vecalc is run with
+ * param path: The path of the workload
+ * return: The seconds it took, or a negative number if it didn't run
+ */
+static double runOnce(char **argv, char *path) {
+
+	double start = now();
+	pid_t pid = fork();
+
+	if(pid == 0) {
+
+		int in = open(path, O_RDONLY);
+		int out = open("/dev/null", O_WRONLY);
+
+		if(in < 0 || out < 0) {
+
+			_exit(127);
+		}
+		dup2(in, STDIN_FILENO);
+		dup2(out, STDOUT_FILENO);
+		dup2(out, STDERR_FILENO);
+
+		execv(argv[0], argv);
+		_exit(127);
+	}
+	else if(pid < 0) {
+
+		return -1;
+	}
+
+	int status;
+	waitpid(pid, &status, 0);
+
+	if(!WIFEXITED(status) || WEXITSTATUS(status) == 127) {
+
+		return -1;
+	}
+
+return now() - start;
+}
+
+/*
+ * Runs vecalc on a workload several times and reports the lines and options
+ * per second of the fastest and the median run. Arguments after the workload
+ * are given to vecalc, and --binary is added for a binary workload.
+ *
+ * Usage: vecalcDrive [--vecalc path] [--reps n] workload [flag...]
+ */
+int main(int argc, char *argv[]) {
+
+	char *vecalc = "./vecalc";
+	int reps = 5;
+
+	int i = 1;
+	while(i + 1 < argc && strncmp(argv[i], "--", 2) == 0) {
+
+		if(strcmp(argv[i], "--vecalc") == 0) {
+
+			vecalc = argv[i + 1];
+		}
+		else if(strcmp(argv[i], "--reps") == 0 && atoi(argv[i + 1]) > 0 && atoi(argv[i + 1]) <= DRIVE_MAX_REPS) {
+
+			reps = atoi(argv[i + 1]);
+		}
+		else {
+
+			break;
+		}
+		i += 2;
+	}
+
+	if(i >= argc || strncmp(argv[i], "--", 2) == 0) {
+
+		fprintf(stderr, "Usage: vecalcDrive [--vecalc path] [--reps 1-%d] workload [flag...]\n", DRIVE_MAX_REPS);
+		return EXIT_FAILURE;
+	}
+	char *path = argv[i++];
+
+	struct Counts counts;
+
+	if(!countWorkload(path, &counts)) {
+
+		fprintf(stderr, "Could not read %s\n", path);
+		return EXIT_FAILURE;
+	}
+
+	/*vecalc, --binary, the flags that were passed on and the null*/
+	char **args = malloc((argc + 3)*sizeof(char *));
+	int n = 0;
+	args[n++] = vecalc;
+
+	if(counts.binary) {
+
+		args[n++] = "--binary";
+	}
+
+	for(; i < argc; i++) {
+
+		args[n++] = argv[i];
+	}
+	args[n] = NULL;
+
+	printf("%s: %ld %s, %ld options\n", path, counts.lines, counts.binary ? "records" : "lines", counts.ops);
+
+	double seconds[DRIVE_MAX_REPS];
+
+	int r;
+	for(r = 0; r < reps; r++) {
+
+		seconds[r] = runOnce(args, path);
+
+		if(seconds[r] < 0) {
+
+			fprintf(stderr, "Could not run %s\n", vecalc);
+			free(args);
+			return EXIT_FAILURE;
+		}
+		printf("run %d: %.4f s\n", r + 1, seconds[r]);
+	}
+	qsort(seconds, reps, sizeof(double), ascending);
+
+	double median = seconds[reps/2];
+	printf("best:   %.4f s, %.0f lines/s, %.0f ops/s\n", seconds[0], counts.lines/seconds[0], counts.ops/seconds[0]);
+	printf("median: %.4f s, %.0f lines/s, %.0f ops/s\n", median, counts.lines/median, counts.ops/median);
+
+	free(args);
+
+return EXIT_SUCCESS;
+}
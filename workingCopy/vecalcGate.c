@@ -0,0 +1,405 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vecalcGate.c						//
+ * Synopsis	:	Compares benchmark results against a baseline and	//
+ * 			fails on a statistically significant slowdown		//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * A kernel is only a regression if it is slower with a one sided Mann-Whitney
+ * p-value under GATE_ALPHA, and its median is at least GATE_MIN_EFFECT slower.
+ * The test alone flags differences too small to matter once there are enough
+ * samples, and the effect size alone flags noise.
+ */
+#define GATE_ALPHA 0.01
+#define GATE_MIN_EFFECT 0.10
+
+/*Most samples read for one result, which is vecalcBench's BENCH_MAX_REPS*/
+#define GATE_MAX_SAMPLES 1000
+
+/*Most results read from one file*/
+#define GATE_MAX_RESULTS 512
+
+/*Longest line of a results file*/
+#define GATE_LINE_LENGTH 65536
+
+/*One kernel at one size, as vecalcBench writes it with --json*/
+struct Result {
+
+	char kernel[32];
+	long elements;
+	int count;
+	double samples[GATE_MAX_SAMPLES];
+};
+
+/*
+ * Orders two doubles from smallest to largest, for qsort()
+ * param a: A double
+ * param b: Another double
+ * return: Less than zero if a comes first, more than zero if b comes first
+ */
+static int ascending(const void *a, const void *b) {
+
+	double first = *(const double *)a;
+	double second = *(const double *)b;
+
+return (first > second) - (first < second);
+}
+
+/*
+ * Reads the results from a file written by vecalcBench --json, which has one
+ * result on each line. This isn't a JSON parser; it reads what vecalcBench
+ * writes and nothing else.
+ * param path: The file
+ * param results: Filled with the results
+ * return: The number of results, or -1 if the file couldn't be read
+ */
+static int readResults(char *path, struct Result *results) {
+
+	FILE *file = fopen(path, "r");
+
+	if(file == NULL) {
+
+		return -1;
+	}
+
+	char *line = malloc(GATE_LINE_LENGTH);
+
+	if(line == NULL) {
+
+		fclose(file);
+		return -1;
+	}
+
+	int count = 0;
+
+	while(count < GATE_MAX_RESULTS && fgets(line, GATE_LINE_LENGTH, file) != NULL) {
+
+		char *kernel = strstr(line, "\"kernel\":\"");
+		char *elements = strstr(line, "\"elements\":");
+		char *samples = strstr(line, "\"samples\":[");
+
+		if(kernel == NULL || elements == NULL || samples == NULL) {
+
+			continue;
+		}
+
+		struct Result *r = &results[count];
+		kernel += strlen("\"kernel\":\"");
+		size_t length = strcspn(kernel, "\"");
+
+		if(length >= sizeof(r->kernel)) {
+
+			length = sizeof(r->kernel) - 1;
+		}
+		memcpy(r->kernel, kernel, length);
+		r->kernel[length] = '\0';
+		r->elements = strtol(elements + strlen("\"elements\":"), NULL, 10);
+
+		char *next = samples + strlen("\"samples\":[");
+		r->count = 0;
+
+		while(*next != ']' && *next != '\0' && r->count < GATE_MAX_SAMPLES) {
+
+			char *end;
+			r->samples[r->count] = strtod(next, &end);
+
+			if(end == next) {
+
+				break;
+			}
+			r->count++;
+			next = *end == ',' ? end + 1 : end;
+		}
+
+		if(r->count > 0) {
+
+			qsort(r->samples, r->count, sizeof(double), ascending);
+			count++;
+		}
+	}
+	free(line);
+	fclose(file);
+
+return count;
+}
+
+/*
+ * The median of sorted samples
+ * param r: The result
+ * return: The median
+ */
+static double median(struct Result *r) {
+
+	int middle = r->count/2;
+
+return r->count%2 == 1 ? r->samples[middle] : (r->samples[middle - 1] + r->samples[middle])/2;
+}
+
+/*
+ * The probability that a standard normal variable is more than z, from
+ * Abramowitz and Stegun 26.2.17, which is accurate to 7.5e-8. C89 has no erfc()
+ * param z: The value
+ * return: The upper tail probability
+ */
+static double normalTail(double z) {
+
+	double x = z < 0 ? -z : z;
+	double t = 1/(1 + 0.2316419*x);
+	double poly = t*(0.319381530 + t*(-0.356563782 + t*(1.781477937 + t*(-1.821255978 + t*1.330274429))));
+	double tail = 0.3989422804014327*exp(-x*x/2)*poly;
+
+return z < 0 ? 1 - tail : tail;
+}
+
+/*
+ * One sided Mann-Whitney U test that the current samples tend to be larger
+ * (slower) than the baseline's, with the normal approximation and a correction
+ * for ties. Both sets of samples are sorted.
+ * param base: The baseline
+ * param current: The current result
+ * return: The p-value
+ */
+static double mannWhitney(struct Result *base, struct Result *current) {
+
+	double n1 = current->count;
+	double n2 = base->count;
+	double n = n1 + n2;
+
+	/*Rank both sets together, giving ties the average of their ranks*/
+	double rankSum = 0;
+	double ties = 0;
+
+	int i = 0;
+	int j = 0;
+
+	while(i < current->count || j < base->count) {
+
+		double value = i < current->count && (j >= base->count || current->samples[i] <= base->samples[j]) ? current->samples[i] : base->samples[j];
+
+		int inCurrent = 0;
+		int inBase = 0;
+
+		while(i < current->count && current->samples[i] == value) {
+
+			inCurrent++;
+			i++;
+		}
+
+		while(j < base->count && base->samples[j] == value) {
+
+			inBase++;
+			j++;
+		}
+
+		/*The ranks this group takes, counting from 1*/
+		double first = i + j - inCurrent - inBase + 1;
+		double last = i + j;
+		double tied = inCurrent + inBase;
+
+		rankSum += inCurrent*(first + last)/2;
+		ties += tied*tied*tied - tied;
+	}
+
+	double u = rankSum - n1*(n1 + 1)/2;
+	double mean = n1*n2/2;
+	double variance = n1*n2/12*((n + 1) - ties/(n*(n - 1)));
+
+	if(variance <= 0) {
+
+		return 1;
+	}
+
+	/*Continuity correction, then the upper tail of the normal distribution*/
+	double z = (u - mean - 0.5)/sqrt(variance);
+
+return normalTail(z);
+}
+
+/*
+ * Finds a result for the same kernel and size
+ * param results: The results to look in
+ * param count: The number of results
+ * param r: The result to find
+ * return: The matching result, or null
+ */
+static struct Result *find(struct Result *results, int count, struct Result *r) {
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		if(results[i].elements == r->elements && strcmp(results[i].kernel, r->kernel) == 0) {
+
+			return &results[i];
+		}
+	}
+
+return NULL;
+}
+
+/*
+ * Copies the current results over the baseline
+ * param from: The current results
+ * param to: The baseline
+ * return: true if it was copied
+ */
+static bool refresh(char *from, char *to) {
+
+	FILE *in = fopen(from, "rb");
+	FILE *out = in != NULL ? fopen(to, "wb") : NULL;
+
+	if(out == NULL) {
+
+		if(in != NULL) {
+
+			fclose(in);
+		}
+		return false;
+	}
+
+	char buffer[8192];
+	size_t length;
+
+	while((length = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+
+		fwrite(buffer, 1, length, out);
+	}
+	fclose(in);
+
+return fclose(out) == 0;
+}
+
+/*
+ * Compares the results of a benchmark against a baseline, kernel by kernel and
+ * size by size, and prints a table of the medians, the change and the p-value.
+ * Kernels and sizes that are only in one of the files are listed but don't
+ * fail the gate. With --refresh the results become the new baseline instead.
+ *
+ * Usage: vecalcGate [--alpha p] [--min-effect fraction] [--refresh] baseline results
+ * return: EXIT_FAILURE if any kernel regressed, or a file couldn't be read
+ */
+int main(int argc, char *argv[]) {
+
+	double alpha = GATE_ALPHA;
+	double minEffect = GATE_MIN_EFFECT;
+	bool refreshing = false;
+
+	int i = 1;
+	while(i < argc && strncmp(argv[i], "--", 2) == 0) {
+
+		if(strcmp(argv[i], "--refresh") == 0) {
+
+			refreshing = true;
+			i++;
+		}
+		else if(strcmp(argv[i], "--alpha") == 0 && i + 1 < argc && strtod(argv[i + 1], NULL) > 0) {
+
+			alpha = strtod(argv[i + 1], NULL);
+			i += 2;
+		}
+		else if(strcmp(argv[i], "--min-effect") == 0 && i + 1 < argc && strtod(argv[i + 1], NULL) >= 0) {
+
+			minEffect = strtod(argv[i + 1], NULL);
+			i += 2;
+		}
+		else {
+
+			break;
+		}
+	}
+
+	if(argc - i != 2) {
+
+		fprintf(stderr, "Usage: vecalcGate [--alpha p] [--min-effect fraction] [--refresh] baseline results\n");
+		return EXIT_FAILURE;
+	}
+	char *basePath = argv[i];
+	char *currentPath = argv[i + 1];
+
+	struct Result *base = malloc(2*GATE_MAX_RESULTS*sizeof(struct Result));
+
+	if(base == NULL) {
+
+		fprintf(stderr, "Call for memory allocation failed.\n");
+		return EXIT_FAILURE;
+	}
+	struct Result *current = base + GATE_MAX_RESULTS;
+
+	/*Only results that can be read become the baseline*/
+	if(refreshing) {
+
+		bool refreshed = readResults(currentPath, current) > 0 && refresh(currentPath, basePath);
+		free(base);
+
+		if(!refreshed) {
+
+			fprintf(stderr, "Could not make %s the baseline from %s\n", basePath, currentPath);
+			return EXIT_FAILURE;
+		}
+		printf("%s is the new baseline\n", basePath);
+		return EXIT_SUCCESS;
+	}
+
+	int baseCount = readResults(basePath, base);
+	int currentCount = readResults(currentPath, current);
+
+	if(baseCount < 0 || currentCount < 0) {
+
+		fprintf(stderr, "Could not read %s\n", baseCount < 0 ? basePath : currentPath);
+		free(base);
+		return EXIT_FAILURE;
+	}
+
+	printf("%-13s %10s %12s %12s %8s %9s  %s\n", "kernel", "elements", "base ns/el", "now ns/el", "change", "p", "verdict");
+
+	int regressions = 0;
+
+	for(i = 0; i < currentCount; i++) {
+
+		struct Result *now = &current[i];
+		struct Result *then = find(base, baseCount, now);
+
+		if(then == NULL) {
+
+			printf("%-13s %10ld %12s %12.4f %8s %9s  new\n", now->kernel, now->elements, "-", median(now), "-", "-");
+			continue;
+		}
+
+		double change = median(now)/median(then) - 1;
+		double p = mannWhitney(then, now);
+		const char *verdict = "ok";
+
+		if(p < alpha && change >= minEffect) {
+
+			verdict = "REGRESSION";
+			regressions++;
+		}
+		else if(mannWhitney(now, then) < alpha && -change >= minEffect) {
+
+			verdict = "faster";
+		}
+		printf("%-13s %10ld %12.4f %12.4f %+7.1f%% %9.2g  %s\n", now->kernel, now->elements, median(then), median(now), 100*change, p, verdict);
+	}
+
+	for(i = 0; i < baseCount; i++) {
+
+		if(find(current, currentCount, &base[i]) == NULL) {
+
+			printf("%-13s %10ld %12.4f %12s %8s %9s  missing\n", base[i].kernel, base[i].elements, median(&base[i]), "-", "-", "-");
+		}
+	}
+
+	printf("%d regressions (p < %g and at least %.0f%% slower)\n", regressions, alpha, 100*minEffect);
+	free(base);
+
+return regressions > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorAsync.c						//
+ * Synopsis	:	Asynchronous output. A writer thread writes out		//
+ * 			buffers of results while commands keep running		//
+ *==============================================================================//
+ */
+
+/*For fopencookie()*/
+#define _GNU_SOURCE
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vectorAsync.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+
+/*
+ * The buffers handed to the writer, used as a ring. The writer writes out
+ * buffers[head] while the next buffers after it are waiting or being filled.
+ * Only the thread that holds the output stream ever fills a buffer, since
+ * stdio locks the stream around each write.
+ */
+static char *buffers[ASYNC_BUFFERS];
+static size_t lengths[ASYNC_BUFFERS];
+static int head = 0;
+static int waiting = 0;
+
+static int outFd;
+static int errFd;
+static FILE *out = NULL;
+static FILE *err = NULL;
+
+static bool closing = false;
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notEmpty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t notFull = PTHREAD_COND_INITIALIZER;
+
+/*
+ * Writes all of a buffer to a file descriptor
+ * param fd: Where the buffer is written
+ * param buffer: The buffer
+ * param length: The number of bytes in buffer
+ */
+static void writeAll(int fd, const char *buffer, size_t length) {
+
+	while(length > 0) {
+
+		ssize_t n = write(fd, buffer, length);
+
+		if(n < 0) {
+
+			if(errno == EINTR) {
+
+				continue;
+			}
+			/*Nothing can be done about a reader that has gone away*/
+			return;
+		}
+		buffer += n;
+		length -= n;
+	}
+}
+
+/*
+ * Writer thread. Writes out buffers as they are handed over until the output
+ * stream is closed and there are none left.
+ * param arg: unused
+ * return: NULL
+ */
+static void *writeBuffers(void *arg) {
+
+	(void)arg;
+
+	pthread_mutex_lock(&lock);
+
+	while(1) {
+
+		while(waiting == 0 && !closing) {
+
+			pthread_cond_wait(&notEmpty, &lock);
+		}
+
+		if(waiting == 0) {
+
+			break;
+		}
+		pthread_mutex_unlock(&lock);
+
+		writeAll(outFd, buffers[head], lengths[head]);
+
+		pthread_mutex_lock(&lock);
+		head = (head + 1) % ASYNC_BUFFERS;
+		waiting--;
+		pthread_cond_broadcast(&notFull);
+	}
+	pthread_mutex_unlock(&lock);
+
+return NULL;
+}
+
+/*
+ * Write function of the output stream. Called by stdio whenever its own
+ * buffer is full or the stream is flushed, so each call is handed to the
+ * writer straight away.
+ * param cookie: unused
+ * param data: What was printed
+ * param size: The number of bytes printed
+ * return: size, since everything is always taken
+ */
+static ssize_t handOver(void *cookie, const char *data, size_t size) {
+
+	(void)cookie;
+	size_t left = size;
+
+	while(left > 0) {
+
+		pthread_mutex_lock(&lock);
+
+		/*Every buffer is waiting, so wait for the writer to catch up*/
+		while(waiting == ASYNC_BUFFERS) {
+
+			pthread_cond_wait(&notFull, &lock);
+		}
+		int next = (head + waiting) % ASYNC_BUFFERS;
+		pthread_mutex_unlock(&lock);
+
+		/*The writer doesn't touch a buffer until it is counted as waiting*/
+		size_t length = left < ASYNC_BUFFER_SIZE ? left : ASYNC_BUFFER_SIZE;
+		memcpy(buffers[next], data, length);
+		lengths[next] = length;
+		data += length;
+		left -= length;
+
+		pthread_mutex_lock(&lock);
+		waiting++;
+		pthread_cond_signal(&notEmpty);
+		pthread_mutex_unlock(&lock);
+	}
+
+return size;
+}
+
+/*
+ * Close function of the output stream. Waits for the writer to write out
+ * everything and stop.
+ * param cookie: unused
+ * return: 0
+ */
+static int closeOutput(void *cookie) {
+
+	(void)cookie;
+
+	pthread_mutex_lock(&lock);
+	closing = true;
+	pthread_cond_signal(&notEmpty);
+	pthread_mutex_unlock(&lock);
+
+	pthread_join(writer, NULL);
+
+	int i;
+	for(i = 0; i < ASYNC_BUFFERS; i++) {
+
+		free(buffers[i]);
+	}
+
+return 0;
+}
+
+/*
+ * Write function of the error stream. Errors are a flush point; all output
+ * printed before the error is written before it.
+ * param cookie: unused
+ * param data: The error message
+ * param size: The number of bytes in the message
+ * return: size
+ */
+static ssize_t writeError(void *cookie, const char *data, size_t size) {
+
+	(void)cookie;
+
+	asyncWait();
+	writeAll(errFd, data, size);
+
+return size;
+}
+
+/*
+ * Writes out everything at exit, however vecalc exits
+ */
+static void stopOutput(void) {
+
+	fclose(err);
+	fclose(out);
+}
+
+/*
+ * Starts the writer thread and replaces a session's output and error streams
+ * with ones that go through it
+ * param session: The session whose streams are replaced
+ * param outputFd: The file descriptor that output is written to
+ * param errorFd: The file descriptor that errors are written to
+ */
+void asyncOutput(struct Session *session, int outputFd, int errorFd) {
+
+	outFd = outputFd;
+	errFd = errorFd;
+
+	int i;
+	for(i = 0; i < ASYNC_BUFFERS; i++) {
+
+		buffers[i] = malloc(ASYNC_BUFFER_SIZE);
+		checkAlloc(buffers[i]);
+	}
+
+	cookie_io_functions_t outFunctions = {NULL, handOver, NULL, closeOutput};
+	cookie_io_functions_t errFunctions = {NULL, writeError, NULL, NULL};
+
+	out = fopencookie(NULL, "w", outFunctions);
+	err = fopencookie(NULL, "w", errFunctions);
+	checkAlloc(out);
+	checkAlloc(err);
+
+	/*stdio collects output a whole buffer at a time before handing it over*/
+	setvbuf(out, NULL, _IOFBF, ASYNC_BUFFER_SIZE);
+	setvbuf(err, NULL, _IONBF, 0);
+
+	pthread_create(&writer, NULL, writeBuffers, NULL);
+	atexit(stopOutput);
+
+	session->out = out;
+	session->err = err;
+}
+
+/*
+ * Waits until everything printed so far has been written
+ */
+void asyncWait(void) {
+
+	if(out == NULL) {
+
+		return;
+	}
+	fflush(out);
+
+	pthread_mutex_lock(&lock);
+
+	while(waiting > 0) {
+
+		pthread_cond_wait(&notFull, &lock);
+	}
+	pthread_mutex_unlock(&lock);
+}
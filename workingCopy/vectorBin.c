@@ -0,0 +1,293 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorBin.c						//
+ * Synopsis	:	Reads commands sent as binary records and runs them	//
+ * 			without any text parsing				//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h> /*For read()*/
+
+/*Local Headers*/
+#include "vectorBin.h"
+#include "vectorOpt.h"
+#include "vectorMem.h"
+#include "vectorSnap.h" /*For snapshot_due()*/
+
+/*
+ * The input buffer. It is kept as doubles so that payloads, which always
+ * start on a multiple of four bytes, can be used as Elems where they lie.
+ */
+static double block[BIN_BLOCK_SIZE/sizeof(double)];
+
+/*
+ * Fills the input buffer from a file descriptor
+ * param fd: The file descriptor to read from
+ * param have: The number of bytes already at the front of the buffer
+ * return: The number of bytes now in the buffer, or -1 on a read error
+ */
+static int fill(int fd, int have) {
+
+	ssize_t n;
+
+	do {
+
+		n = read(fd, (char *)block + have, BIN_BLOCK_SIZE - have);
+	} while(n < 0 && errno == EINTR);
+
+	if(n < 0) {
+
+		fprintf(stderr, "Error reading binary input: %s\n", strerror(errno));
+		return -1;
+	}
+
+return have + n;
+}
+
+/*
+ * Checks that a binary opcode is an option that can be run
+ * param opcode: The opcode from the record
+ * return: true if it is a valid option
+ */
+static bool validOpcode(uint8_t opcode) {
+
+	switch(opcode) {
+
+		case 'q':
+		case 'e':
+		case 'c':
+		case 'p':
+		case 'h':
+		case 'm':
+		case 'i':
+		case 'w':
+		case 'f':
+		case 'z':
+		case 'b':
+		case 't':
+		case 'k':
+		case 'x':
+		case 'v':
+		case 'd':
+		case 'a':
+		case '+':
+		case '-':
+		case '*':
+		case '/':	return true;
+	}
+
+return false;
+}
+
+/*
+ * Runs the commands decoded so far and empties the list
+ * param session: The session to run the commands against
+ * param cmds: The decoded commands
+ * param count: The number of decoded commands, set to zero after
+ * param flags: Settings that apply to running the commands
+ * return: false if one of the commands ended the session
+ */
+static bool flush(struct Session *session, struct Command *cmds, int *count, struct Flags *flags) {
+
+	int n = *count;
+	*count = 0;
+
+	if(flags->optimize) {
+
+		n = optimizeCommands(cmds, n, flags->showOptimized ? stderr : NULL);
+	}
+	bool running = runCommands(session, cmds, n);
+
+	/*Every record is a line, so periodic snapshots count records*/
+	if(running) {
+
+		snapshot_due(session, session->line);
+	}
+
+return running;
+}
+
+/*
+ * Reads binary records from a file descriptor until a q or e record or the
+ * end of the input and runs them against a session
+ * param session: The session to run the commands against
+ * param fd: The file descriptor to read records from
+ * param flags: Settings that apply to running the commands
+ * return: EXIT_SUCCESS, or EXIT_FAILURE if the input could not be read or ends
+ * part way through a record
+ */
+int binaryIn(struct Session *session, int fd, struct Flags *flags) {
+
+	/*A block can't hold more records than this*/
+	struct Command *cmds = malloc((BIN_BLOCK_SIZE/sizeof(struct BinaryRecord))*sizeof(struct Command));
+	checkAlloc(cmds);
+	int numCmds = 0;
+
+	/*Bytes in the buffer, and the position of the next record in it*/
+	int have = 0;
+	int pos = 0;
+
+	/*Converted values when a payload is sent as doubles*/
+	Elem converted[BIN_BLOCK_SIZE/sizeof(double)];
+
+	struct BinaryRecord rec;
+	int status = EXIT_SUCCESS;
+
+	/*Cleared when a q or e record is decoded or the input can't be read*/
+	bool reading = true;
+
+	/*Cleared once a command has ended the session*/
+	bool running = true;
+
+	while(reading && running) {
+
+		int filled = fill(fd, have);
+
+		if(filled < 0) {
+
+			status = EXIT_FAILURE;
+			break;
+		}
+		else if(filled == have) {
+
+			if(have > 0) {
+
+				fprintf(stderr, "Binary input ended part way through a record\n");
+				status = EXIT_FAILURE;
+			}
+			break;
+		}
+		have = filled;
+		pos = 0;
+
+		while(reading && running && have - pos >= (int)sizeof(struct BinaryRecord)) {
+
+			memcpy(&rec, (char *)block + pos, sizeof(struct BinaryRecord));
+			pos += sizeof(struct BinaryRecord);
+
+			/*Diagnostics give the number of the record as the line*/
+			session->line++;
+
+			Elem value = (rec.flags & BIN_DOUBLE) ? (Elem)rec.operand.d : rec.operand.f;
+
+			/*The reserved field is checked so that it can be given a use later*/
+			if(!validOpcode(rec.opcode) || rec.reserved != 0 || (rec.length > 0 && rec.opcode != 'a')) {
+
+				diagnose(&session->diag, DIAG_BAD_RECORD, session->line, session->err, "Invalid binary record: opcode 0x%02x length %u\n", rec.opcode, (unsigned)rec.length);
+
+				/*There is no way to find the next record after a payload*/
+				if(rec.length > 0) {
+
+					status = EXIT_FAILURE;
+					reading = false;
+				}
+				continue;
+			}
+
+			if(rec.length == 0) {
+
+				cmds[numCmds].option = rec.opcode;
+				cmds[numCmds].value = value;
+				/*Counts that are out of range are reported when they run*/
+				double count = (rec.flags & BIN_DOUBLE) ? rec.operand.d : rec.operand.f;
+				cmds[numCmds].range[0] = count >= 0 && count < 2147483647.0 ? (long)count : -1;
+				cmds[numCmds].range[1] = 0;
+				cmds[numCmds].reuse = false;
+				cmds[numCmds].line = session->line;
+				numCmds++;
+
+				/*Nothing after a quit will ever run*/
+				if(rec.opcode == 'q' || rec.opcode == 'e') {
+
+					reading = false;
+				}
+				continue;
+			}
+
+			/*
+			 * Everything before a payload has to run first so the
+			 * values are appended in the right order.
+			 */
+			running = flush(session, cmds, &numCmds, flags);
+
+			size_t width = (rec.flags & BIN_DOUBLE) ? sizeof(double) : sizeof(float);
+			uint32_t remaining = rec.length;
+
+			while(running && remaining > 0) {
+
+				/*Whole values in the buffer that belong to the payload*/
+				uint32_t count = (have - pos)/width;
+
+				if(count > remaining) {
+
+					count = remaining;
+				}
+
+				if(count == 0) {
+
+					/*Keep the partial value and read in more*/
+					memmove(block, (char *)block + pos, have - pos);
+					have -= pos;
+					pos = 0;
+
+					filled = fill(fd, have);
+
+					if(filled <= have) {
+
+						if(filled == have) {
+
+							fprintf(stderr, "Binary input ended part way through a payload\n");
+						}
+						status = EXIT_FAILURE;
+						reading = false;
+						break;
+					}
+					have = filled;
+					continue;
+				}
+
+				if(width == sizeof(float)) {
+
+					appendValues(session, (Elem *)((char *)block + pos), count, session->line);
+				}
+				else {
+
+					uint32_t i;
+					for(i = 0; i < count; i++) {
+
+						double d;
+						memcpy(&d, (char *)block + pos + i*width, sizeof(double));
+						converted[i] = d;
+					}
+					appendValues(session, converted, count, session->line);
+				}
+				pos += count*width;
+				remaining -= count;
+			}
+		}
+
+		if(running) {
+
+			running = flush(session, cmds, &numCmds, flags);
+		}
+
+		/*Move a partial record to the front for the next read*/
+		memmove(block, (char *)block + pos, have - pos);
+		have -= pos;
+	}
+
+	if(running) {
+
+		flush(session, cmds, &numCmds, flags);
+	}
+	free(cmds);
+
+return status;
+}
@@ -0,0 +1,825 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorCmd.c						//
+ * Synopsis	:	Converts options into commands and runs them against	//
+ * 			a session's vector					//
+ *==============================================================================//
+ */
+
+/*For strtok_r()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h> /*To check length of option*/
+#include <errno.h>
+
+/*Local Headers*/
+#include "vectorCmd.h"
+#include "vectorOps.h"
+#include "vectorOut.h"
+#include "vectorIn.h" /*For ensureDigit()*/
+#include "vectorMem.h"
+#include "vectorOpt.h"
+#include "vectorHash.h"
+#include "vectorDiff.h"
+#include "vectorSparse.h"
+#include "vectorSnap.h"
+#include "vectorProbe.h"
+
+/*
+ * Options that read the elements one at a time, which need a dense vector. b,
+ * t, s and k decode just the range they print instead, in printRange()
+ */
+#define DENSE_READERS "pxvd"
+
+/*
+ * Sets up a session with an empty vector
+ * param session: The session to initialise
+ * param out: Stream that results are printed to
+ * param err: Stream that errors are printed to
+ */
+void init_session(struct Session *session, FILE *out, FILE *err) {
+
+	session->vec = alloc_vec();
+	session->out = out;
+	session->err = err;
+	session->lastMagnitude = 0;
+	session->lastLine = NULL;
+	session->lastLineShared = false;
+	session->snapshotPath = SNAP_DEFAULT_NAME;
+	session->snapshotEvery = 0;
+	session->snapshotLast = 0;
+	session->format = FORMAT_TEXT;
+	session->storage = STORAGE_FLOAT;
+	session->line = 0;
+	memset(session->registers, 0, sizeof(session->registers));
+	memset(&session->tolerance, 0, sizeof(struct Tolerance));
+	session->showFirst = 10;
+	session->stats = NULL;
+	init_diag(&session->diag);
+}
+
+/*
+ * Applies the flags vecalc was run with to a session
+ * param session: The session the flags apply to
+ * param flags: The flags
+ */
+void configure_session(struct Session *session, struct Flags *flags) {
+
+	session->format = flags->format;
+	session->diag.quiet = flags->quiet;
+	session->diag.sample = flags->sample;
+	session->tolerance = flags->tolerance;
+	session->showFirst = flags->showFirst;
+
+	if(flags->snapshotPath != NULL) {
+
+		session->snapshotPath = flags->snapshotPath;
+	}
+
+	if(flags->reference != NULL) {
+
+		dealloc_vec(session->registers[0]);
+		session->registers[0] = copy_vec(flags->reference);
+	}
+
+	if(flags->stats && session->stats == NULL) {
+
+		session->stats = calloc(1, sizeof(struct Stats));
+		checkAlloc(session->stats);
+	}
+}
+
+/*
+ * Frees everything held by a session
+ * param session: The session to free. The session itself isn't freed
+ */
+void free_session(struct Session *session) {
+
+	dealloc_vec(session->vec);
+	session->vec = NULL;
+	free(session->lastLine);
+	session->lastLine = NULL;
+
+	int i;
+	for(i = 0; i < VEC_REGISTERS; i++) {
+
+		dealloc_vec(session->registers[i]);
+		session->registers[i] = NULL;
+	}
+	diagSummary(&session->diag, session->err);
+
+	if(session->stats != NULL) {
+
+		fprint_stats(session->err, session->stats, FORMAT_TEXT);
+		free_stats(session->stats);
+		free(session->stats);
+		session->stats = NULL;
+	}
+}
+
+/*
+ * Converts the argument of a ranged printing option
+ * param arg: The argument
+ * param number: Set to the argument if it is valid
+ * return: true if the argument is a whole number that isn't negative
+ */
+static bool wholeNumber(char *arg, long *number) {
+
+	char *end;
+	long value = strtol(arg, &end, 10);
+
+	if(*arg < '0' || *arg > '9' || *end != '\0') {
+
+		return false;
+	}
+	*number = value;
+
+return true;
+}
+
+/*
+ * Prints part of the session's vector for the ranged printing options
+ * param session: The session whose vector is printed
+ * param cmd: A b, t, s or k command
+ */
+static void printRange(struct Session *session, struct Command *cmd) {
+
+	long size = session->vec->size;
+	long first = 0;
+	long last = size;
+	long step = 1;
+
+	switch(cmd->option) {
+
+		case 'b':	last = cmd->range[0] < size ? cmd->range[0] : size;
+				break;
+
+		case 't':	first = cmd->range[0] < size ? size - cmd->range[0] : 0;
+				break;
+
+		case 's':	first = cmd->range[0] < size ? cmd->range[0] : size;
+				last = cmd->range[1] < size ? cmd->range[1] : size;
+				break;
+
+		case 'k':	step = cmd->range[0];
+				break;
+	}
+
+	/*Only reachable with binary input, where the range isn't checked*/
+	if(first < 0 || last < 0 || step <= 0) {
+
+		diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Bad argument - Usage [%c] [count]\n", cmd->option);
+	}
+	else if(size == 0 && session->format == FORMAT_TEXT) {
+
+		diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Nothing to print. Vector has zero size\n");
+	}
+	else if(session->vec->sparse != NULL || session->vec->packed != NULL) {
+
+		/*Only the elements in range are decoded, not the whole vector*/
+		int length = last > first ? last - first : 0;
+		Elem *window = malloc((length > 0 ? length : 1)*sizeof(Elem));
+		checkAlloc(window);
+
+		if(session->vec->sparse != NULL) {
+
+			sparse_fill(session->vec, first, first + length, window);
+		}
+		else {
+
+			packed_fill(session->vec, first, first + length, window);
+		}
+		fprint_window(session->out, window, first, last, step, session->format);
+		free(window);
+	}
+	else {
+
+		fprint_range(session->out, session->vec, first, last, step, session->format);
+	}
+}
+
+/*
+ * Saves the session's vector in a register for v, or compares it against one
+ * for d
+ * param session: The session
+ * param cmd: A v or d command, whose value is the register
+ */
+static void compareOrSave(struct Session *session, struct Command *cmd) {
+
+	int index = cmd->value;
+
+	if(index != cmd->value || index < 0 || index >= VEC_REGISTERS) {
+
+		diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Bad argument - Usage [%c] [register 0 to %d]\n", cmd->option, VEC_REGISTERS - 1);
+	}
+	else if(cmd->option == 'v') {
+
+		dealloc_vec(session->registers[index]);
+		session->registers[index] = copy_vec(session->vec);
+		pack_vec(session->registers[index], session->storage, NULL);
+	}
+	else if(session->registers[index] == NULL) {
+
+		diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Register %d is empty. Save a vector in it with v first\n", index);
+	}
+	else {
+
+		/*A packed register is compared as a dense copy*/
+		struct Vector *reference = session->registers[index];
+
+		if(reference->packed != NULL) {
+
+			reference = copy_vec(reference);
+		}
+
+		struct DiffResult result;
+		diff_vec(session->vec, reference, &session->tolerance, session->showFirst, &result);
+		fprint_diff(session->out, &result, session->vec->size, reference->size, session->format);
+
+		if(reference != session->registers[index]) {
+
+			dealloc_vec(reference);
+		}
+	}
+}
+
+/*
+ * Checks a list of options and their values and converts them to commands.
+ * Bad options and bad values are reported on the session's error stream and
+ * left out, exactly as if they had been skipped over.
+ * param session: The session that errors are reported to
+ * param options: The options, starting with the first one entered
+ * param count: The number of options
+ * param cmds: Filled with the parsed commands
+ * return: The number of commands placed in cmds
+ */
+int parseCommands(struct Session *session, char *options[], int count, struct Command *cmds) {
+
+	/*Number of commands that have been placed in cmds*/
+	int n = 0;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		char *option = options[i];
+
+		/*Any option should only be one character in length*/
+		if(strlen(option) > 1) {
+
+			diagnose(&session->diag, DIAG_INVALID_OPTION, session->line, session->err, "Invalid option: %s Type 'h' for usage\n", option);
+			continue;
+		}
+
+		cmds[n].option = *option;
+		cmds[n].value = 0;
+		cmds[n].range[0] = 0;
+		cmds[n].range[1] = 0;
+		cmds[n].reuse = false;
+		cmds[n].line = session->line;
+
+		switch(*option) {
+
+			/*Nothing after a quit will ever run, so stop here*/
+			case 'q':
+			case 'e':	n++;
+					return n;
+
+			case 'c':
+			case 'p':
+			case 'h':
+			case 'i':
+			case 'w':
+			case 'm':	n++;
+					break;
+
+			case 'f':
+			case 'v':
+			case 'd':
+			case 'z':
+			case 'a':
+			case '+':
+			case '-':
+			case '*':
+			case '/':	if(i + 1 < count && ensureDigit(options[i + 1])) {
+
+						cmds[n++].value = atof(options[++i]);
+					}
+					else {
+
+						if(*option == 'a') {
+
+							diagnose(&session->diag, DIAG_BAD_ARGUMENT, session->line, session->err, "Bad argument - Usage: [a] [value]\n");
+						}
+						else {
+
+							diagnose(&session->diag, DIAG_BAD_ARGUMENT, session->line, session->err, "Bad argument - Usage [%c] [value]\n", *option);
+						}
+						/*
+						 * The argument is invalid, so skip over it.
+						 */
+						i++;
+					}
+					break;
+
+			case 'b':
+			case 't':
+			case 'k':	if(i + 1 < count && wholeNumber(options[i + 1], &cmds[n].range[0])) {
+
+						n++;
+						i++;
+					}
+					else {
+
+						diagnose(&session->diag, DIAG_BAD_ARGUMENT, session->line, session->err, "Bad argument - Usage [%c] [count]\n", *option);
+						i++;
+					}
+					break;
+
+			case 's':	if(i + 2 < count && wholeNumber(options[i + 1], &cmds[n].range[0]) && wholeNumber(options[i + 2], &cmds[n].range[1])) {
+
+						n++;
+						i += 2;
+					}
+					else {
+
+						diagnose(&session->diag, DIAG_BAD_ARGUMENT, session->line, session->err, "Bad argument - Usage [s] [start] [end]\n");
+						/*Skip over whichever arguments were given*/
+						i++;
+
+						if(i + 1 < count && ensureDigit(options[i + 1])) {
+
+							i++;
+						}
+					}
+					break;
+
+			/*The tolerance is optional*/
+			case 'x':	if(i + 1 < count && ensureDigit(options[i + 1])) {
+
+						cmds[n].value = atof(options[++i]);
+					}
+					n++;
+					break;
+
+			case 'r':	if(i != 0) {
+
+						diagnose(&session->diag, DIAG_MISPLACED_REPEAT, session->line, session->err, "The r option can not follow any other option.\n");
+					}
+					break;
+
+			default:	diagnose(&session->diag, DIAG_INVALID_OPTION, session->line, session->err, "Invalid option: %s\n", option);
+					break;
+		}/*delimits case*/
+	}
+
+return n;
+}
+
+/*
+ * Makes sure the session has a vector, in case the c option was given. It is
+ * stored as z last said
+ * param session: The session
+ */
+static void sessionVector(struct Session *session) {
+
+	if(session->vec == NULL) {
+
+		session->vec = alloc_vec();
+		pack_vec(session->vec, session->storage, NULL);
+	}
+}
+
+/*
+ * Appends values to the session's vector as if each was given to the a option,
+ * stopping at the maximum size of a vector
+ * param session: The session whose vector is extended
+ * param values: The values to append
+ * param count: The number of values
+ * param line: The line the values came from, for diagnostics
+ */
+void appendValues(struct Session *session, Elem *values, int count, long line) {
+
+	sessionVector(session);
+
+	if(session->vec->size + count > MAXVECSIZE) {
+
+		diagnose(&session->diag, DIAG_VECTOR_FULL, line, session->err, "Vector is at maximum size and can not be extended\n");
+		count = MAXVECSIZE - session->vec->size;
+	}
+
+	/*
+	 * a settles the vector when it reaches a power of two, so the values go in
+	 * pieces that end on each power of two they pass
+	 */
+	while(count > 0) {
+
+		long next = 1;
+		while(next <= session->vec->size) {
+
+			next *= 2;
+		}
+
+		int piece = next - session->vec->size < count ? (int)(next - session->vec->size) : count;
+
+		append_vec(session->vec, values, piece);
+		settle_vec(session->vec, 'a', values[piece - 1]);
+
+		values += piece;
+		count -= piece;
+	}
+}
+
+/*
+ * Runs a single command on the session's vector
+ * param session: The session to run the command against
+ * param cmd: The command to run
+ * return: false if the command ends the session (q or e), true otherwise
+ */
+bool runCommand(struct Session *session, struct Command *cmd) {
+
+	/*Temporary vector when the extend_vec function is called*/
+	struct Vector *tempVec;
+
+	sessionVector(session);
+
+	/*
+	 * Options that read the elements one at a time run on a dense copy of a
+	 * sparse or packed vector, and the vector is put back after, so it stays
+	 * the way it was
+	 */
+	struct Vector *storedVec = NULL;
+
+	if((session->vec->sparse != NULL || session->vec->packed != NULL) && cmd->option != '\0' && strchr(DENSE_READERS, cmd->option) != NULL) {
+
+		storedVec = session->vec;
+		session->vec = copy_vec(storedVec);
+	}
+
+	switch(cmd->option) {
+
+		case 'q':
+		case 'e':	dealloc_vec(session->vec);
+				session->vec = NULL;
+				fflush(session->out);
+				return false;
+
+		case 'c':	dealloc_vec(session->vec);
+				session->vec = NULL;
+				break;
+
+		case 'p':	if(session->vec->size == 0 && session->format == FORMAT_TEXT) {
+
+					diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Nothing to print. Vector has zero size\n");
+				}
+				else {
+
+					fprint_vec_as(session->out, session->vec, session->format);
+				}
+				break;
+
+		case 'b':
+		case 't':
+		case 's':
+		case 'k':	printRange(session, cmd);
+				break;
+
+		case 'x':	if(cmd->value < 0) {
+
+					diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Bad argument - Usage [x] [tolerance]\n");
+				}
+				else if(cmd->value == 0) {
+
+					fprint_hash(session->out, checksum(session->vec), "checksum", session->format);
+				}
+				else {
+
+					fprint_hash(session->out, fingerprint(session->vec, cmd->value), "fingerprint", session->format);
+				}
+				break;
+
+		case 'v':
+		case 'd':	compareOrSave(session, cmd);
+				break;
+
+		case 'f':	if(cmd->value == FORMAT_TEXT || cmd->value == FORMAT_CSV || cmd->value == FORMAT_JSON || cmd->value == FORMAT_BINARY) {
+
+					session->format = cmd->value;
+				}
+				else {
+
+					diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Bad argument - Usage [f] [0 text, 1 csv, 2 json, 3 binary]\n");
+				}
+				break;
+
+		case 'h':	getHelp(session->out);
+				break;
+
+		case 'z':	if(cmd->value == STORAGE_FLOAT || cmd->value == STORAGE_BF16 || cmd->value == STORAGE_FP16 || cmd->value == STORAGE_XOR) {
+
+					struct PackReport report;
+					session->storage = cmd->value;
+					pack_vec(session->vec, session->storage, &report);
+					fprint_storage(session->out, &report, session->format);
+				}
+				else {
+
+					diagnose(&session->diag, DIAG_BAD_ARGUMENT, cmd->line, session->err, "Bad argument - Usage [z] [0 float, 1 bf16, 2 fp16, 3 lossless]\n");
+				}
+				break;
+
+		case 'a':	if(session->vec->size == MAXVECSIZE) {
+
+					diagnose(&session->diag, DIAG_VECTOR_FULL, cmd->line, session->err, "Vector is at maximum size and can not be extended");
+				}
+				else {
+
+					tempVec = session->vec;
+					session->vec = extend_vec(session->vec, cmd->value);
+					dealloc_vec(tempVec);
+				}
+				break;
+
+		/*
+		 * The messages the operations print for themselves are printed
+		 * here instead, so they go to the session's streams
+		 */
+		case '+':	if(session->vec->size == 0) {
+
+					diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Using scalar plus on a zero size vector has no effect\n");
+				}
+				else {
+
+					scalar_plus(session->vec, cmd->value);
+				}
+				break;
+
+		case '-':	if(session->vec->size == 0) {
+
+					diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Using scalar minus on a zero size vector has no effect\n");
+				}
+				else {
+
+					scalar_minus(session->vec, cmd->value);
+				}
+				break;
+
+		case '*':	if(session->vec->size == 0) {
+
+					diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Using scalar multiply on a zero size vector has no effect\n");
+				}
+				else {
+
+					scalar_mult(session->vec, cmd->value);
+				}
+				break;
+
+		case '/':	if(cmd->value == 0) {
+
+					diagnose(&session->diag, DIAG_DIVIDE_BY_ZERO, cmd->line, session->err, "Bad argument to divide - Divide by zero error\n");
+				}
+				else if(session->vec->size == 0) {
+
+					diagnose(&session->diag, DIAG_ZERO_SIZE, cmd->line, session->out, "Using scalar divide on a zero size vector has no effect\n");
+				}
+				else {
+
+					scalar_div(session->vec, cmd->value);
+				}
+				break;
+
+		case 'm':	if(!cmd->reuse) {
+
+					session->lastMagnitude = magnitude(session->vec);
+				}
+				fprint_magnitude(session->out, session->lastMagnitude, session->format);
+				break;
+
+		/*Timing starts here if vecalc wasn't run with --stats*/
+		case 'i':	if(session->stats == NULL) {
+
+					session->stats = calloc(1, sizeof(struct Stats));
+					checkAlloc(session->stats);
+					fprintf(session->err, "Statistics are kept from now on. Use i again to see them\n");
+				}
+				else {
+
+					fprint_stats(session->out, session->stats, session->format);
+				}
+				break;
+
+		case 'w':	if(!snapshot_write(session, session->snapshotPath, cmd->line)) {
+
+					diagnose(&session->diag, DIAG_SNAPSHOT, cmd->line, session->err, "Could not write a snapshot to %s: %s\n", session->snapshotPath, strerror(errno));
+				}
+				break;
+	}
+
+	if(storedVec != NULL) {
+
+		dealloc_vec(session->vec);
+		session->vec = storedVec;
+	}
+	else if(session->vec != NULL) {
+
+		settle_vec(session->vec, cmd->option, cmd->value);
+	}
+
+return true;
+}
+
+/*
+ * Runs a single command and counts how long it took in the session's
+ * statistics, along with the size of the vector it ran on
+ * param session: The session to run the command against
+ * param cmd: The command to run
+ * return: false if the command ends the session (q or e), true otherwise
+ */
+static bool timeCommand(struct Session *session, struct Command *cmd) {
+
+	long elements = session->vec != NULL ? session->vec->size : 0;
+
+	uint64_t start = statsClock();
+	bool running = runCommand(session, cmd);
+	statsRecord(session->stats, cmd->option, statsClock() - start, elements);
+
+return running;
+}
+
+/*
+ * Runs a list of commands in order, stopping early if one ends the session
+ * param session: The session to run the commands against
+ * param cmds: The list of commands
+ * param count: The number of commands in the list
+ * return: false if the session was ended, true otherwise
+ */
+bool runCommands(struct Session *session, struct Command *cmds, int count) {
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		VEC_PROBE2(command_start, cmds[i].option, session->vec != NULL ? session->vec->size : 0);
+
+		bool running = session->stats != NULL ? timeCommand(session, &cmds[i]) : runCommand(session, &cmds[i]);
+
+		VEC_PROBE2(command_end, cmds[i].option, session->vec != NULL ? session->vec->size : 0);
+
+		if(!running) {
+
+			return false;
+		}
+	}
+
+return true;
+}
+
+/*
+ * Keeps the options of a line as the session's last line, separated by spaces
+ * param session: The session
+ * param options: The options of the line
+ * param count: The number of options
+ */
+void rememberLine(struct Session *session, char *options[], int count) {
+
+	size_t length = 0;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		length += strlen(options[i]) + 1;
+	}
+
+	free(session->lastLine);
+	session->lastLine = calloc(length + 1, sizeof(char));
+	checkAlloc(session->lastLine);
+
+	for(i = 0; i < count; i++) {
+
+		strcat(session->lastLine, options[i]);
+		strcat(session->lastLine, i + 1 < count ? " " : "");
+	}
+}
+
+/*
+ * Converts one line of input into commands, in the same way a line typed at
+ * the vecalc prompt is checked
+ * param session: The session the line belongs to
+ * param line: The line of input. A trailing newline is ignored
+ * param optimize: true if the commands should be run through the optimizer
+ * param report: If not null, the optimizer reports what it eliminated here
+ * param cmds: Set to the list of commands, which must be freed by the caller
+ * return: The number of commands, or -1 for a blank line
+ */
+int parseLine(struct Session *session, char *line, bool optimize, FILE *report, struct Command **cmds) {
+
+	session->line++;
+
+	/*Leading spaces are skipped, just like strtok does for argv*/
+	line += strspn(line, " ");
+	size_t length = strcspn(line, "\n");
+
+	VEC_PROBE2(line_read, session->line, length);
+
+	/*
+	 * A blank line ends input that isn't coming from the terminal, the
+	 * same as it does for redirected input
+	 */
+	if(length == 0) {
+
+		*cmds = NULL;
+		return -1;
+	}
+
+	/*
+	 * The options that will actually run. For a repeat, this is the last
+	 * line with the new options added onto the end of it.
+	 */
+	char *options;
+	char *repeated = NULL;
+
+	if(line[0] == 'r' && (length == 1 || line[1] == ' ')) {
+
+		repeated = line + 1;
+	}
+
+	if(repeated != NULL && session->lastLine != NULL) {
+
+		options = malloc(strlen(session->lastLine) + length + 1);
+		checkAlloc(options);
+		strcpy(options, session->lastLine);
+		strncat(options, repeated, length - 1);
+	}
+	else {
+
+		options = malloc(length + 1);
+		checkAlloc(options);
+		memcpy(options, repeated != NULL ? repeated : line, length);
+		options[repeated != NULL ? length - 1 : length] = '\0';
+	}
+
+	free(session->lastLine);
+	session->lastLine = malloc(strlen(options) + 1);
+	checkAlloc(session->lastLine);
+	strcpy(session->lastLine, options);
+
+	/*Space delimited options, of which there are at most half the line*/
+	char **tokens = malloc((strlen(options)/2 + 1)*sizeof(char *));
+	checkAlloc(tokens);
+	int count = 0;
+	char *save;
+	char *token = strtok_r(options, " ", &save);
+
+	while(token != NULL) {
+
+		tokens[count++] = token;
+		token = strtok_r(NULL, " ", &save);
+	}
+
+	*cmds = malloc((count + 1)*sizeof(struct Command));
+	checkAlloc(*cmds);
+
+	int numCmds = parseCommands(session, tokens, count, *cmds);
+
+	if(optimize) {
+
+		numCmds = optimizeCommands(*cmds, numCmds, report);
+	}
+
+	free(tokens);
+	free(options);
+
+return numCmds;
+}
+
+/*
+ * Runs one line of input against a session, in the same way a line typed at
+ * the vecalc prompt is run
+ * param session: The session to run the line against
+ * param line: The line of input. A trailing newline is ignored
+ * param optimize: true if the line should be run through the optimizer
+ * param report: If not null, the optimizer reports what it eliminated here
+ * return: false if the line ended the session (q, e or a blank line)
+ */
+bool runLine(struct Session *session, char *line, bool optimize, FILE *report) {
+
+	struct Command *cmds;
+	int numCmds = parseLine(session, line, optimize, report, &cmds);
+
+	if(numCmds < 0) {
+
+		return false;
+	}
+	bool running = runCommands(session, cmds, numCmds);
+	free(cmds);
+
+	if(running) {
+
+		snapshot_due(session, session->line);
+	}
+
+return running;
+}
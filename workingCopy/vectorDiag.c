@@ -0,0 +1,312 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorDiag.c						//
+ * Synopsis	:	Counts diagnostics by type and input line, and prints	//
+ * 			them or a summary of them				//
+ *==============================================================================//
+ */
+
+/*For open_memstream()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vectorDiag.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+
+/*Names of the types of event, as they are printed in the summary*/
+static const char *typeNames[DIAG_TYPES] = {
+
+	"invalid option",
+	"bad argument",
+	"misplaced repeat",
+	"zero size vector",
+	"divide by zero",
+	"vector full",
+	"invalid binary record",
+	"snapshot not written"
+};
+
+/*
+ * Sets up diagnostics with nothing counted, printing every message
+ * param diag: The diagnostics to initialise
+ */
+void init_diag(struct Diagnostics *diag) {
+
+	memset(diag->totals, 0, sizeof(diag->totals));
+	diag->quiet = false;
+	diag->sample = 0;
+	diag->counts = NULL;
+	diag->capacity = 0;
+	diag->used = 0;
+	pthread_mutex_init(&diag->lock, NULL);
+	diag->hold = false;
+	diag->held = NULL;
+	diag->heldCount = 0;
+	diag->heldCapacity = 0;
+}
+
+/*
+ * Frees the counts held by diagnostics, and any events held back
+ * param diag: The diagnostics to free
+ */
+void free_diag(struct Diagnostics *diag) {
+
+	free(diag->counts);
+	diag->counts = NULL;
+	diag->capacity = 0;
+	diag->used = 0;
+
+	int i;
+	for(i = 0; i < diag->heldCount; i++) {
+
+		free(diag->held[i].message);
+	}
+	free(diag->held);
+	diag->held = NULL;
+	diag->heldCount = 0;
+	diag->heldCapacity = 0;
+}
+
+/*
+ * Finds the slot in the table for a type of event on a line
+ * param counts: The table
+ * param capacity: The number of slots in the table, a power of two
+ * param type: The type of event
+ * param line: The input line
+ * return: The slot holding the count, or the empty slot where it belongs
+ */
+static struct DiagCount *findCount(struct DiagCount *counts, int capacity, int type, long line) {
+
+	unsigned long hash = ((unsigned long)line*31 + type)*2654435761UL;
+	int i = hash & (capacity - 1);
+
+	while(counts[i].count != 0 && (counts[i].line != line || counts[i].type != type)) {
+
+		i = (i + 1) & (capacity - 1);
+	}
+
+return &counts[i];
+}
+
+/*
+ * Adds one to the count of a type of event on a line, growing the table when
+ * it is half full
+ * param diag: The diagnostics
+ * param type: The type of event
+ * param line: The input line
+ */
+static void count(struct Diagnostics *diag, int type, long line) {
+
+	if(2*(diag->used + 1) > diag->capacity) {
+
+		int capacity = diag->capacity == 0 ? 64 : 2*diag->capacity;
+		struct DiagCount *counts = calloc(capacity, sizeof(struct DiagCount));
+		checkAlloc(counts);
+
+		int i;
+		for(i = 0; i < diag->capacity; i++) {
+
+			if(diag->counts[i].count != 0) {
+
+				*findCount(counts, capacity, diag->counts[i].type, diag->counts[i].line) = diag->counts[i];
+			}
+		}
+		free(diag->counts);
+		diag->counts = counts;
+		diag->capacity = capacity;
+	}
+
+	struct DiagCount *slot = findCount(diag->counts, diag->capacity, type, line);
+
+	if(slot->count == 0) {
+
+		slot->line = line;
+		slot->type = type;
+		diag->used++;
+	}
+	slot->count++;
+}
+
+/*
+ * Counts an event and prints its message, unless the diagnostics are quiet and
+ * enough of this type have already been sampled
+ * param diag: The diagnostics that count the event
+ * param type: The type of event
+ * param line: The input line that caused the event
+ * param stream: Where the message is printed
+ * param format: printf style format of the message, followed by its arguments
+ */
+void diagnose(struct Diagnostics *diag, enum DiagType type, long line, FILE *stream, const char *format, ...) {
+
+	if(diag->hold) {
+
+		if(diag->heldCount == diag->heldCapacity) {
+
+			diag->heldCapacity = diag->heldCapacity == 0 ? 8 : 2*diag->heldCapacity;
+			diag->held = realloc(diag->held, diag->heldCapacity*sizeof(struct DiagEvent));
+			checkAlloc(diag->held);
+		}
+		struct DiagEvent *event = &diag->held[diag->heldCount++];
+		event->type = type;
+		event->line = line;
+		event->stream = stream;
+
+		/*The message is printed into memory, to be printed for real later*/
+		size_t length;
+		FILE *message = open_memstream(&event->message, &length);
+		checkAlloc(message);
+
+		va_list args;
+		va_start(args, format);
+		vfprintf(message, format, args);
+		va_end(args);
+		fclose(message);
+		return;
+	}
+
+	pthread_mutex_lock(&diag->lock);
+
+	diag->totals[type]++;
+	bool print = !diag->quiet || diag->totals[type] <= diag->sample;
+
+	/*Only quiet diagnostics are summarised, so only they need counting*/
+	if(diag->quiet) {
+
+		count(diag, type, line);
+	}
+	pthread_mutex_unlock(&diag->lock);
+
+	if(print) {
+
+		va_list args;
+		va_start(args, format);
+		vfprintf(stream, format, args);
+		va_end(args);
+	}
+}
+
+/*
+ * Hands over the events held back since the last call, leaving none held
+ * param diag: Diagnostics that hold
+ * param events: Filled with the events, or null if there are none
+ * return: The number of events
+ */
+int take_held(struct Diagnostics *diag, struct DiagEvent **events) {
+
+	int count = diag->heldCount;
+	*events = diag->held;
+	diag->held = NULL;
+	diag->heldCount = 0;
+	diag->heldCapacity = 0;
+
+return count;
+}
+
+/*
+ * Counts and prints held events as if they had just happened, then frees them
+ * param diag: The diagnostics that count the events
+ * param events: The events. May be null
+ * param count: The number of events
+ */
+void replay_diag(struct Diagnostics *diag, struct DiagEvent *events, int count) {
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		diagnose(diag, events[i].type, events[i].line, events[i].stream, "%s", events[i].message);
+		free(events[i].message);
+	}
+	free(events);
+}
+
+/*
+ * Orders counts from the most events to the fewest, then by line
+ * param a: A count
+ * param b: Another count
+ * return: Less than zero if a comes first, more than zero if b comes first
+ */
+static int byCount(const void *a, const void *b) {
+
+	const struct DiagCount *first = a;
+	const struct DiagCount *second = b;
+
+	if(first->count != second->count) {
+
+		return first->count > second->count ? -1 : 1;
+	}
+
+return first->line < second->line ? -1 : first->line > second->line;
+}
+
+/*
+ * Prints how many of each type of event happened and on which input lines most
+ * of them did, then clears the counts
+ * param diag: The diagnostics to summarise
+ * param stream: Where the summary is printed
+ */
+void diagSummary(struct Diagnostics *diag, FILE *stream) {
+
+	pthread_mutex_lock(&diag->lock);
+
+	long total = 0;
+
+	int type;
+	for(type = 0; type < DIAG_TYPES; type++) {
+
+		total += diag->totals[type];
+	}
+
+	if(total > 0 && diag->quiet) {
+
+		struct DiagCount *lines = malloc(diag->used*sizeof(struct DiagCount));
+		checkAlloc(lines);
+
+		fprintf(stream, "Diagnostics: %ld in total\n", total);
+
+		for(type = 0; type < DIAG_TYPES; type++) {
+
+			if(diag->totals[type] == 0) {
+
+				continue;
+			}
+			fprintf(stream, "  %s: %ld\n", typeNames[type], diag->totals[type]);
+
+			/*The lines with the most events of this type*/
+			int n = 0;
+
+			int i;
+			for(i = 0; i < diag->capacity; i++) {
+
+				if(diag->counts[i].count != 0 && diag->counts[i].type == type) {
+
+					lines[n++] = diag->counts[i];
+				}
+			}
+			qsort(lines, n, sizeof(struct DiagCount), byCount);
+
+			for(i = 0; i < n && i < DIAG_SUMMARY_LINES; i++) {
+
+				fprintf(stream, "    line %ld: %ld\n", lines[i].line, lines[i].count);
+			}
+
+			if(n > DIAG_SUMMARY_LINES) {
+
+				fprintf(stream, "    (%d more lines)\n", n - DIAG_SUMMARY_LINES);
+			}
+		}
+		free(lines);
+	}
+
+	memset(diag->totals, 0, sizeof(diag->totals));
+	free_diag(diag);
+	pthread_mutex_unlock(&diag->lock);
+}
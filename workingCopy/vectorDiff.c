@@ -0,0 +1,214 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorDiff.c						//
+ * Synopsis	:	Compares a vector against a reference vector, within	//
+ * 			a tolerance, splitting large vectors over threads	//
+ *==============================================================================//
+ */
+
+/*For sysconf()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h> /*For HUGE_VAL*/
+#include <unistd.h>
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vectorDiff.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorTune.h" /*For the size that is split over threads*/
+#include "vectorPlace.h" /*For pinning the threads*/
+
+/*A range of elements compared by one thread*/
+struct DiffPart {
+
+	Elem *elements;
+	Elem *reference;
+	long first;
+	long last;
+	struct Tolerance *tolerance;
+	int keep;
+	struct DiffResult result;
+	pthread_t thread;
+	bool threaded;
+};
+
+/*
+ * Maps the bits of a float onto integers in the same order as the floats, so
+ * that the distance between two of them is the number of floats apart they are
+ * param value: The float
+ * return: Its place in order
+ */
+static int64_t ordered(Elem value) {
+
+	union {
+
+		float f;
+		int32_t bits;
+	} u;
+	u.f = value;
+
+return u.bits < 0 ? (int64_t)INT32_MIN - u.bits : u.bits;
+}
+
+/*
+ * The absolute value of an element, as a double
+ * param value: The element
+ * return: Its absolute value
+ */
+static double absolute(Elem value) {
+
+return value < 0 ? -(double)value : value;
+}
+
+/*
+ * Compares a range of elements
+ * param arg: The DiffPart to compare
+ * return: NULL
+ */
+static void *diffPart(void *arg) {
+
+	struct DiffPart *part = arg;
+	struct DiffResult *result = &part->result;
+	struct Tolerance *tolerance = part->tolerance;
+
+	result->mismatches = 0;
+	result->maxError = 0;
+	result->maxErrorIndex = -1;
+	result->firstCount = 0;
+
+	long i;
+	for(i = part->first; i < part->last; i++) {
+
+		Elem a = part->elements[i];
+		Elem b = part->reference[i];
+
+		/*Same value, or both NaN*/
+		if(a == b || (a != a && b != b)) {
+
+			continue;
+		}
+
+		double error = a > b ? (double)a - b : (double)b - a;
+		double larger = absolute(a) > absolute(b) ? absolute(a) : absolute(b);
+
+		/*NaN against a number is as far apart as two elements can be*/
+		if(error != error) {
+
+			error = HUGE_VAL;
+		}
+
+		if(error > result->maxError) {
+
+			result->maxError = error;
+			result->maxErrorIndex = i;
+		}
+
+		int64_t ulps = ordered(a) - ordered(b);
+
+		/*Nothing is close to infinity or NaN except itself*/
+		if(error < HUGE_VAL && (error <= tolerance->absolute || error <= tolerance->relative*larger || (ulps < 0 ? -ulps : ulps) <= tolerance->ulps)) {
+
+			continue;
+		}
+
+		if(result->firstCount < part->keep) {
+
+			result->first[result->firstCount++] = i;
+		}
+		result->mismatches++;
+	}
+
+return NULL;
+}
+
+/*
+ * Compares two vectors element by element in a single pass
+ * param vector: The vector being checked
+ * param reference: The reference vector
+ * param tolerance: How far apart elements can be and still match
+ * param keep: The most mismatched indices to record
+ * param result: Filled with what was found
+ */
+void diff_vec(struct Vector *vector, struct Vector *reference, struct Tolerance *tolerance, int keep, struct DiffResult *result) {
+
+	long size = vector->size < reference->size ? vector->size : reference->size;
+
+	if(keep > DIFF_FIRST_MAX) {
+
+		keep = DIFF_FIRST_MAX;
+	}
+
+	/*Every thread compares at least diffThreadMin elements*/
+	long threads = tuning.diffThreadMin != TUNE_NEVER ? size/tuning.diffThreadMin : 1;
+	/*Known from loadTuning(), which saves asking the system every time*/
+	long cpus = tuning.threads > 0 ? tuning.threads : sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(threads > cpus) {
+
+		threads = cpus;
+	}
+
+	if(threads < 1) {
+
+		threads = 1;
+	}
+
+	struct DiffPart *parts = malloc(threads*sizeof(struct DiffPart));
+	checkAlloc(parts);
+
+	/*The first part runs on this thread*/
+	long t;
+	for(t = 0; t < threads; t++) {
+
+		parts[t].elements = vector->elements;
+		parts[t].reference = reference->elements;
+		parts[t].first = size*t/threads;
+		parts[t].last = size*(t + 1)/threads;
+		parts[t].tolerance = tolerance;
+		parts[t].keep = keep;
+
+		/*A part that can't get a thread is run here instead*/
+		parts[t].threaded = t > 0 && place_thread(&parts[t].thread, diffPart, &parts[t], t, threads) == 0;
+
+		if(t > 0 && !parts[t].threaded) {
+
+			diffPart(&parts[t]);
+		}
+	}
+	diffPart(&parts[0]);
+
+	/*The parts are in order, so their first mismatches are too*/
+	*result = parts[0].result;
+	result->compared = size;
+
+	for(t = 1; t < threads; t++) {
+
+		struct DiffResult *part = &parts[t].result;
+
+		if(parts[t].threaded) {
+
+			pthread_join(parts[t].thread, NULL);
+		}
+
+		int i;
+		for(i = 0; i < part->firstCount && result->firstCount < keep; i++) {
+
+			result->first[result->firstCount++] = part->first[i];
+		}
+		result->mismatches += part->mismatches;
+
+		if(part->maxError > result->maxError) {
+
+			result->maxError = part->maxError;
+			result->maxErrorIndex = part->maxErrorIndex;
+		}
+	}
+	free(parts);
+}
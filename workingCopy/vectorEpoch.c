@@ -0,0 +1,324 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorEpoch.c						//
+ * Synopsis	:	Versions of a vector that other threads can read	//
+ * 			without locks while one thread keeps changing it	//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*Local Headers*/
+#include "vectorEpoch.h"
+#include "vectorOps.h" /*For sweep()*/
+#include "vectorTune.h" /*For the size sweeps are split over threads at*/
+#include "vectorPlace.h" /*For place_copy()*/
+
+/*Where the epoch and buffer are in the state. The size is the low 32 bits*/
+#define EPOCH_SHIFT 40
+#define EPOCH_BUFFER_SHIFT 32
+
+/*
+ * Puts a version into one word, so readers see its parts together
+ * param epoch: The epoch, of which the low EPOCH_BITS are kept
+ * param buffer: The buffer
+ * param size: The number of elements
+ * return: The state
+ */
+static uint64_t pack(long epoch, int buffer, long size) {
+
+	uint64_t wrapped = (uint64_t)epoch & (((uint64_t)1 << EPOCH_BITS) - 1);
+
+return wrapped << EPOCH_SHIFT | (uint64_t)buffer << EPOCH_BUFFER_SHIFT | (uint32_t)size;
+}
+
+/*
+ * The buffer of a state
+ * param state: The state
+ * return: The buffer
+ */
+static int bufferOf(uint64_t state) {
+
+return (state >> EPOCH_BUFFER_SHIFT) & 0xff;
+}
+
+/*
+ * Checks if a reader holds a buffer
+ * param epochs: The versions
+ * param buffer: The buffer
+ * return: true if any slot names it
+ */
+static bool held(struct Epochs *epochs, int buffer) {
+
+	int r;
+	for(r = 0; r < EPOCH_READERS; r++) {
+
+		if(__atomic_load_n(&epochs->slots[r].buffer, __ATOMIC_SEQ_CST) == buffer + 1) {
+
+			return true;
+		}
+	}
+
+return false;
+}
+
+/*
+ * Finds a buffer that isn't current and no reader holds, with room for a
+ * version. One that already has the room is taken over one that has to grow.
+ * param epochs: The versions
+ * param capacity: Elements the version needs room for
+ * return: The buffer, or -1 if it couldn't grow
+ */
+static int spare(struct Epochs *epochs, long capacity) {
+
+	int grow = -1;
+
+	int b;
+	for(b = 0; b < EPOCH_BUFFERS; b++) {
+
+		if(b == epochs->current || held(epochs, b)) {
+
+			continue;
+		}
+
+		if(epochs->buffers[b].capacity >= capacity) {
+
+			return b;
+		}
+		grow = grow < 0 ? b : grow;
+	}
+
+	Elem *elements = realloc(epochs->buffers[grow].elements, capacity*sizeof(Elem));
+
+	if(elements == NULL) {
+
+		return -1;
+	}
+	epochs->buffers[grow].elements = elements;
+	epochs->buffers[grow].capacity = capacity;
+
+return grow;
+}
+
+/*
+ * Makes a buffer's first elements the current version, and points the vector
+ * at it
+ * param epochs: The versions
+ * param vector: The vector
+ * param buffer: The buffer
+ * param size: The number of elements in the version
+ */
+static void publish(struct Epochs *epochs, struct Vector *vector, int buffer, long size) {
+
+	epochs->epoch++;
+	epochs->current = buffer;
+	__atomic_store_n(&epochs->state, pack(epochs->epoch, buffer, size), __ATOMIC_SEQ_CST);
+
+	vector->elements = epochs->buffers[buffer].elements;
+	vector->size = size;
+}
+
+/*
+ * Starts keeping versions of a vector
+ * param vector: The vector, which must be dense
+ * param capacity: Elements there is room for in its memory
+ * return: The versions, or null if they couldn't be allocated
+ */
+struct Epochs *epoch_share(struct Vector *vector, long capacity) {
+
+	struct Epochs *epochs = calloc(1, sizeof(struct Epochs));
+
+	if(epochs == NULL) {
+
+		return NULL;
+	}
+	epochs->buffers[0].elements = vector->elements;
+	epochs->buffers[0].capacity = capacity;
+	epochs->state = pack(0, 0, vector->size);
+
+return epochs;
+}
+
+/*
+ * Frees every version, and the vector's elements with them
+ * param epochs: The versions. Null is ignored
+ */
+void epoch_free(struct Epochs *epochs) {
+
+	if(epochs == NULL) {
+
+		return;
+	}
+
+	int b;
+	for(b = 0; b < EPOCH_BUFFERS; b++) {
+
+		free(epochs->buffers[b].elements);
+	}
+	free(epochs);
+}
+
+/*
+ * Applies an operation to the vector as a new version. The elements are
+ * copied a block at a time and swept while the block is in cache, so the
+ * version costs about what sweeping in place does. A vector large enough to be
+ * split over threads is copied and swept whole instead, so it still is.
+ * param epochs: The versions
+ * param vector: The vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ * return: false if there wasn't memory for the new version
+ */
+bool epoch_sweep(struct Epochs *epochs, struct Vector *vector, char option, Elem value) {
+
+	int buffer = spare(epochs, vector->size);
+
+	if(buffer < 0) {
+
+		return false;
+	}
+
+	struct Vector block;
+	block.sparse = NULL;
+	block.packed = NULL;
+	block.elements = epochs->buffers[buffer].elements;
+
+	if(tuning.threadMin != TUNE_NEVER && vector->size >= tuning.threadMin) {
+
+		place_copy(block.elements, vector->elements, vector->size);
+		block.size = vector->size;
+		sweep(&block, option, value, PATH_AUTO);
+	}
+	else {
+
+		long first;
+		for(first = 0; first < vector->size; first += EPOCH_BLOCK) {
+
+			block.elements = epochs->buffers[buffer].elements + first;
+			block.size = vector->size - first < EPOCH_BLOCK ? vector->size - first : EPOCH_BLOCK;
+
+			memcpy(block.elements, vector->elements + first, block.size*sizeof(Elem));
+			sweep(&block, option, value, PATH_AUTO);
+		}
+	}
+	publish(epochs, vector, buffer, vector->size);
+
+return true;
+}
+
+/*
+ * Appends elements to the vector as a new version. Values that fit in the
+ * current buffer go on the end of it: readers of the versions before only read
+ * as far as their own size. Otherwise the vector moves to a buffer at least
+ * twice as large.
+ * param epochs: The versions
+ * param vector: The vector
+ * param values: The values
+ * param count: The number of values
+ * return: false if there wasn't memory for the new version
+ */
+bool epoch_append(struct Epochs *epochs, struct Vector *vector, const Elem *values, long count) {
+
+	long size = vector->size + count;
+	int buffer = epochs->current;
+
+	if(count == 0) {
+
+		return true;
+	}
+
+	if(size > epochs->buffers[buffer].capacity) {
+
+		long capacity = epochs->buffers[buffer].capacity*2;
+		buffer = spare(epochs, capacity > size ? capacity : size);
+
+		if(buffer < 0) {
+
+			return false;
+		}
+
+		if(vector->size > 0) {
+
+			memcpy(epochs->buffers[buffer].elements, vector->elements, vector->size*sizeof(Elem));
+		}
+	}
+	memcpy(epochs->buffers[buffer].elements + vector->size, values, count*sizeof(Elem));
+	publish(epochs, vector, buffer, size);
+
+return true;
+}
+
+/*
+ * Empties the vector as a new version. Appends after this write over the
+ * start of a buffer, so it can't be one that a reader holds a longer version
+ * of
+ * param epochs: The versions
+ * param vector: The vector
+ */
+void epoch_clear(struct Epochs *epochs, struct Vector *vector) {
+
+	publish(epochs, vector, spare(epochs, 0), 0);
+}
+
+/*
+ * Takes hold of the current version. The slot is set to the buffer before the
+ * state is read again: if the buffer is still current, the writer will see the
+ * slot before it looks for a buffer to reuse. If the version changed in
+ * between, the new one is tried.
+ * param epochs: The versions
+ * param snapshot: Filled with the elements and size of the version
+ * param epoch: Filled with its epoch
+ * return: The reader slot it is held with, or -1 if every slot is in use
+ */
+int epoch_enter(struct Epochs *epochs, struct Vector *snapshot, long *epoch) {
+
+	uint64_t state = __atomic_load_n(&epochs->state, __ATOMIC_SEQ_CST);
+
+	int r;
+	for(r = 0; r < EPOCH_READERS; r++) {
+
+		long idle = 0;
+
+		if(__atomic_compare_exchange_n(&epochs->slots[r].buffer, &idle, bufferOf(state) + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+
+			break;
+		}
+	}
+
+	if(r == EPOCH_READERS) {
+
+		return -1;
+	}
+
+	uint64_t again = __atomic_load_n(&epochs->state, __ATOMIC_SEQ_CST);
+
+	while(bufferOf(again) != bufferOf(state)) {
+
+		state = again;
+		__atomic_store_n(&epochs->slots[r].buffer, bufferOf(state) + 1, __ATOMIC_SEQ_CST);
+		again = __atomic_load_n(&epochs->state, __ATOMIC_SEQ_CST);
+	}
+
+	snapshot->elements = epochs->buffers[bufferOf(again)].elements;
+	snapshot->size = (uint32_t)again;
+	snapshot->sparse = NULL;
+	snapshot->packed = NULL;
+	*epoch = again >> EPOCH_SHIFT;
+
+return r;
+}
+
+/*
+ * Lets go of a version
+ * param epochs: The versions
+ * param reader: The reader slot from epoch_enter()
+ */
+void epoch_exit(struct Epochs *epochs, int reader) {
+
+	__atomic_store_n(&epochs->slots[reader].buffer, 0, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,314 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorHash.c						//
+ * Synopsis	:	XXH64 checksums and tolerance aware fingerprints of	//
+ * 			a vector						//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*Local Headers*/
+#include "vectorHash.h"
+
+/*The primes of XXH64*/
+#define PRIME1 11400714785074694791ULL
+#define PRIME2 14029467366897019727ULL
+#define PRIME3 1609587929392839161ULL
+#define PRIME4 9650029242287828579ULL
+#define PRIME5 2870177450012600261ULL
+
+/*Number of quantized elements hashed at a time for a fingerprint*/
+#define FINGERPRINT_CHUNK 1024
+
+/*
+ * Rotates a 64 bit value left
+ * param value: The value
+ * param bits: The number of bits to rotate by, between 1 and 63
+ * return: The rotated value
+ */
+static uint64_t rotate(uint64_t value, int bits) {
+
+return (value << bits) | (value >> (64 - bits));
+}
+
+/*
+ * Reads 8 bytes in little endian order, the same on any machine
+ * param bytes: The bytes
+ * return: The value
+ */
+static uint64_t read64(const unsigned char *bytes) {
+
+	uint64_t value = 0;
+
+	#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+	memcpy(&value, bytes, sizeof(uint64_t));
+
+	#else
+
+	int i;
+	for(i = 7; i >= 0; i--) {
+
+		value = (value << 8) | bytes[i];
+	}
+
+	#endif
+
+return value;
+}
+
+/*
+ * Reads 4 bytes in little endian order
+ * param bytes: The bytes
+ * return: The value
+ */
+static uint64_t read32(const unsigned char *bytes) {
+
+return (uint64_t)bytes[0] | (uint64_t)bytes[1] << 8 | (uint64_t)bytes[2] << 16 | (uint64_t)bytes[3] << 24;
+}
+
+/*
+ * Mixes 8 bytes of input into an accumulator
+ * param lane: The accumulator
+ * param input: The input
+ * return: The new accumulator
+ */
+static uint64_t round64(uint64_t lane, uint64_t input) {
+
+	lane += input*PRIME2;
+	lane = rotate(lane, 31);
+
+return lane*PRIME1;
+}
+
+/*
+ * Folds an accumulator into the hash once the input is done
+ * param hash: The hash so far
+ * param lane: The accumulator
+ * return: The new hash
+ */
+static uint64_t merge(uint64_t hash, uint64_t lane) {
+
+	hash ^= round64(0, lane);
+
+return hash*PRIME1 + PRIME4;
+}
+
+/*
+ * Consumes whole stripes of 32 bytes. The four lanes don't depend on each
+ * other, so the compiler and the processor work on all of them at once.
+ * param lanes: The accumulators
+ * param bytes: The stripes
+ * param count: The number of stripes
+ */
+static void stripes(uint64_t *lanes, const unsigned char *bytes, size_t count) {
+
+	uint64_t a = lanes[0];
+	uint64_t b = lanes[1];
+	uint64_t c = lanes[2];
+	uint64_t d = lanes[3];
+
+	size_t i;
+	for(i = 0; i < count; i++, bytes += 32) {
+
+		a = round64(a, read64(bytes));
+		b = round64(b, read64(bytes + 8));
+		c = round64(c, read64(bytes + 16));
+		d = round64(d, read64(bytes + 24));
+	}
+
+	lanes[0] = a;
+	lanes[1] = b;
+	lanes[2] = c;
+	lanes[3] = d;
+}
+
+/*
+ * Starts a hash
+ * param state: The state to start
+ * param seed: The seed
+ */
+void hashStart(struct HashState *state, uint64_t seed) {
+
+	state->lanes[0] = seed + PRIME1 + PRIME2;
+	state->lanes[1] = seed + PRIME2;
+	state->lanes[2] = seed;
+	state->lanes[3] = seed - PRIME1;
+	state->length = 0;
+	state->buffered = 0;
+}
+
+/*
+ * Adds bytes to a hash
+ * param state: The hash
+ * param data: The bytes
+ * param length: The number of bytes
+ */
+void hashAdd(struct HashState *state, const void *data, size_t length) {
+
+	const unsigned char *bytes = data;
+	state->length += length;
+
+	/*Finish off a stripe left over from last time*/
+	if(state->buffered > 0) {
+
+		size_t fill = 32 - state->buffered;
+
+		if(fill > length) {
+
+			fill = length;
+		}
+		memcpy(state->stripe + state->buffered, bytes, fill);
+		state->buffered += fill;
+		bytes += fill;
+		length -= fill;
+
+		if(state->buffered < 32) {
+
+			return;
+		}
+		stripes(state->lanes, state->stripe, 1);
+		state->buffered = 0;
+	}
+
+	stripes(state->lanes, bytes, length/32);
+	bytes += length - length%32;
+
+	memcpy(state->stripe, bytes, length%32);
+	state->buffered = length%32;
+}
+
+/*
+ * Finishes a hash
+ * param state: The hash
+ * return: The XXH64 hash of everything added
+ */
+uint64_t hashEnd(struct HashState *state) {
+
+	uint64_t hash;
+
+	if(state->length >= 32) {
+
+		hash = rotate(state->lanes[0], 1) + rotate(state->lanes[1], 7) + rotate(state->lanes[2], 12) + rotate(state->lanes[3], 18);
+		hash = merge(hash, state->lanes[0]);
+		hash = merge(hash, state->lanes[1]);
+		hash = merge(hash, state->lanes[2]);
+		hash = merge(hash, state->lanes[3]);
+	}
+	else {
+
+		/*lanes[2] is still the seed*/
+		hash = state->lanes[2] + PRIME5;
+	}
+	hash += state->length;
+
+	/*The bytes that didn't make up a whole stripe*/
+	const unsigned char *bytes = state->stripe;
+	int left = state->buffered;
+
+	while(left >= 8) {
+
+		hash ^= round64(0, read64(bytes));
+		hash = rotate(hash, 27)*PRIME1 + PRIME4;
+		bytes += 8;
+		left -= 8;
+	}
+
+	if(left >= 4) {
+
+		hash ^= read32(bytes)*PRIME1;
+		hash = rotate(hash, 23)*PRIME2 + PRIME3;
+		bytes += 4;
+		left -= 4;
+	}
+
+	while(left > 0) {
+
+		hash ^= *bytes*PRIME5;
+		hash = rotate(hash, 11)*PRIME1;
+		bytes++;
+		left--;
+	}
+
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME3;
+	hash ^= hash >> 32;
+
+return hash;
+}
+
+/*
+ * Hashes the raw bytes of a vector's elements with XXH64
+ * param vector: The vector to hash
+ * return: The checksum
+ */
+uint64_t checksum(struct Vector *vector) {
+
+	struct HashState state;
+	hashStart(&state, 0);
+	hashAdd(&state, vector->elements, vector->size*sizeof(Elem));
+
+return hashEnd(&state);
+}
+
+/*
+ * Hashes a vector's elements after rounding them to a multiple of a tolerance
+ * param vector: The vector to hash
+ * param tolerance: The tolerance
+ * return: The fingerprint
+ */
+uint64_t fingerprint(struct Vector *vector, double tolerance) {
+
+	/*Rounded values past this, infinity and NaN get values of their own*/
+	const double LIMIT = 4611686018427387904.0;
+
+	int64_t quantized[FINGERPRINT_CHUNK];
+	int n = 0;
+
+	struct HashState state;
+	hashStart(&state, 0);
+
+	int i;
+	for(i = 0; i < vector->size; i++) {
+
+		double scaled = vector->elements[i]/tolerance;
+
+		if(scaled != scaled) {
+
+			quantized[n] = INT64_MIN;
+		}
+		else if(scaled >= LIMIT) {
+
+			quantized[n] = INT64_MAX;
+		}
+		else if(scaled <= -LIMIT) {
+
+			quantized[n] = INT64_MIN + 1;
+		}
+		/*Round half away from zero. -0 rounds to 0 like anything small*/
+		else if(scaled < 0) {
+
+			quantized[n] = -(int64_t)(0.5 - scaled);
+		}
+		else {
+
+			quantized[n] = (int64_t)(scaled + 0.5);
+		}
+
+		if(++n == FINGERPRINT_CHUNK) {
+
+			hashAdd(&state, quantized, sizeof(quantized));
+			n = 0;
+		}
+	}
+	hashAdd(&state, quantized, n*sizeof(int64_t));
+
+return hashEnd(&state);
+}
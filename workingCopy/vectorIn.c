@@ -19,6 +19,167 @@
 /*Local Headers*/
 #include "vectorMem.h" /*For checkAlloc()*/
 #include "vectorIn.h" /*For userIn()*/
+#include "vectorOut.h" /*For formatByName()*/
+#include "vectorPlace.h" /*For placementByName()*/
+
+/*
+ * Takes any flags off the front of argv and shifts the remaining arguments
+ * down so that argv[1] is the first option
+ * param argv: The argument vector the program was run with
+ * param argc: The number of arguments in argv
+ * param flags: Filled in with the flags that were given
+ * return: The number of arguments left in argv
+ */
+int parseFlags(char *argv[], int argc, struct Flags *flags) {
+
+	memset(flags, 0, sizeof(struct Flags));
+	flags->socketPath = NULL;
+	flags->workers = sysconf(_SC_NPROCESSORS_ONLN);
+	flags->showFirst = 10;
+	flags->placement = -1;
+	flags->reference = NULL;
+	flags->snapshotPath = NULL;
+	flags->restorePath = NULL;
+
+	/*Number of flags found at the front of argv*/
+	int n = 0;
+
+	while(n + 1 < argc && strncmp(argv[n + 1], "--", 2) == 0) {
+
+		char *flag = argv[n + 1];
+
+		if(strcmp(flag, "--optimize") == 0) {
+
+			flags->optimize = true;
+		}
+		else if(strcmp(flag, "--show-optimized") == 0) {
+
+			flags->optimize = true;
+			flags->showOptimized = true;
+		}
+		else if(strcmp(flag, "--binary") == 0) {
+
+			flags->binary = true;
+		}
+		else if(strcmp(flag, "--pipeline") == 0) {
+
+			flags->pipeline = true;
+		}
+		else if(strcmp(flag, "--run") == 0) {
+
+			flags->run = true;
+		}
+		else if(strcmp(flag, "--async-output") == 0) {
+
+			flags->asyncOutput = true;
+		}
+		else if(strcmp(flag, "--stats") == 0) {
+
+			flags->stats = true;
+		}
+		else if(strcmp(flag, "--calibrate") == 0) {
+
+			flags->calibrate = true;
+		}
+		else if(strcmp(flag, "--quiet") == 0) {
+
+			flags->quiet = true;
+		}
+		/*Flags that take a value use up the next argument as well*/
+		else if(strcmp(flag, "--serve") == 0 && n + 2 < argc) {
+
+			flags->socketPath = argv[n + 2];
+			n++;
+		}
+		else if(strcmp(flag, "--format") == 0 && n + 2 < argc && formatByName(argv[n + 2]) >= 0) {
+
+			flags->format = formatByName(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--placement") == 0 && n + 2 < argc && placementByName(argv[n + 2]) >= 0) {
+
+			flags->placement = placementByName(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--sample") == 0 && n + 2 < argc && atol(argv[n + 2]) > 0) {
+
+			flags->quiet = true;
+			flags->sample = atol(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--abs-tol") == 0 && n + 2 < argc && ensureDigit(argv[n + 2])) {
+
+			flags->tolerance.absolute = atof(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--rel-tol") == 0 && n + 2 < argc && ensureDigit(argv[n + 2])) {
+
+			flags->tolerance.relative = atof(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--ulp-tol") == 0 && n + 2 < argc && atol(argv[n + 2]) > 0) {
+
+			flags->tolerance.ulps = atol(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--first") == 0 && n + 2 < argc && atoi(argv[n + 2]) >= 0 && ensureDigit(argv[n + 2])) {
+
+			flags->showFirst = atoi(argv[n + 2]) < DIFF_FIRST_MAX ? atoi(argv[n + 2]) : DIFF_FIRST_MAX;
+			n++;
+		}
+		else if(strcmp(flag, "--reference") == 0 && n + 2 < argc) {
+
+			dealloc_vec(flags->reference);
+			flags->reference = load_vec(argv[n + 2]);
+
+			if(flags->reference == NULL) {
+
+				fprintf(stderr, "Could not read a reference vector from %s\n", argv[n + 2]);
+				exit(EXIT_FAILURE);
+			}
+			n++;
+		}
+		else if(strcmp(flag, "--snapshot") == 0 && n + 2 < argc) {
+
+			flags->snapshotPath = argv[n + 2];
+			n++;
+		}
+		else if(strcmp(flag, "--snapshot-every") == 0 && n + 2 < argc && atol(argv[n + 2]) > 0) {
+
+			flags->snapshotEvery = atol(argv[n + 2]);
+			n++;
+		}
+		else if(strcmp(flag, "--restore") == 0 && n + 2 < argc) {
+
+			flags->restorePath = argv[n + 2];
+			n++;
+		}
+		else if(strcmp(flag, "--workers") == 0 && n + 2 < argc && atoi(argv[n + 2]) > 0) {
+
+			flags->workers = atoi(argv[n + 2]);
+			n++;
+		}
+		else {
+
+			fprintf(stderr, "Unknown flag: %s\n", flag);
+			fprintf(stderr, "Usage: vecalc [--optimize] [--show-optimized] [--binary] [--pipeline] [--async-output] [--stats] [--calibrate] [--placement local|interleave|chunk] [--quiet] [--sample n] [--reference path] [--abs-tol x] [--rel-tol x] [--ulp-tol n] [--first n] [--snapshot path] [--snapshot-every n] [--restore path] [--serve path | --run [script...]] [--workers n] [--format text|csv|json|binary] [option] [value]\n");
+			exit(EXIT_FAILURE);
+		}
+		n++;
+	}
+
+	/*
+	 * Move the options down over the flags. Everything after the options
+	 * is left alone since argv[argc] must stay null.
+	 */
+	int i;
+	for(i = 1; i + n <= argc; i++) {
+
+		argv[i] = argv[i + n];
+	}
+
+return argc - n;
+}
 
 /* 
  * gets new options from standard in and places them back in argv for
@@ -103,9 +264,16 @@ int refreshArgv(char *argv[], int maxArgc, int initialArgc, int currentArgc) {
 
 	while(nextArg != NULL) {
 
+		/*Leave room for the null that ends argv*/
+		if(j == MAX_OPTIONS - 1) {
+
+			fprintf(stderr, "Too many options to repeat. The rest of the line was ignored\n");
+			break;
+		}
+
 		if(argv[j] == NULL) {
 
-			argv[j] = calloc(strlen(nextArg), sizeof(char));
+			argv[j] = calloc(strlen(nextArg) + 1, sizeof(char));
 		}
 
 		/*
@@ -116,7 +284,7 @@ int refreshArgv(char *argv[], int maxArgc, int initialArgc, int currentArgc) {
 		else if(j >= initialArgc && j < maxArgc) {
 
 			free(argv[j]);	
-			argv[j] = calloc(strlen(nextArg), sizeof(char));
+			argv[j] = calloc(strlen(nextArg) + 1, sizeof(char));
 		}
 
 		/*
@@ -125,7 +293,7 @@ int refreshArgv(char *argv[], int maxArgc, int initialArgc, int currentArgc) {
 		 */
 		else if(j >= maxArgc) {
 
-			argv[j] = calloc(strlen(nextArg), sizeof(char));
+			argv[j] = calloc(strlen(nextArg) + 1, sizeof(char));
 		}
 
 		/*
@@ -151,6 +319,55 @@ int refreshArgv(char *argv[], int maxArgc, int initialArgc, int currentArgc) {
 return j;
 }
 
+/*
+ * Reads a vector from a file of numbers separated by white space
+ * param path: The path of the file
+ * return: The vector, or null if the file couldn't be read or has something
+ * in it that isn't a number
+ */
+struct Vector *load_vec(char *path) {
+
+	FILE *file = fopen(path, "r");
+
+	if(file == NULL) {
+
+		return NULL;
+	}
+
+	struct Vector *vector = alloc_vec();
+	Elem values[1024];
+	int count = 0;
+	char token[64];
+	bool valid = true;
+
+	while(valid && fscanf(file, "%63s", token) == 1) {
+
+		char *end;
+		values[count++] = strtod(token, &end);
+		valid = *end == '\0';
+
+		if(count == 1024) {
+
+			append_vec(vector, values, count);
+			count = 0;
+		}
+	}
+
+	if(count > 0) {
+
+		append_vec(vector, values, count);
+	}
+	fclose(file);
+
+	if(!valid) {
+
+		dealloc_vec(vector);
+		return NULL;
+	}
+
+return vector;
+}
+
 /*
  * Checks to see if the argument is a digit or not
  * param arg: The current argument that needs to be checked
@@ -242,7 +459,11 @@ char *userIn() {
 	 * If the user enters in more than the max input length, fgets buffers
 	 * the input and enters it on the next call for input from stdin.
 	 */	
-	fgets(newOptions, MAX_INPUT_LENGTH, stdin);
+	if(fgets(newOptions, MAX_INPUT_LENGTH, stdin) == NULL) {
+
+		/*Nothing was read, so the buffer holds whatever malloc left*/
+		newOptions[0] = '\0';
+	}
 
 	/*
 	 * EOF's on here-strings are always returned null by realloc.
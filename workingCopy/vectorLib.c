@@ -0,0 +1,453 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorLib.c						//
+ * Synopsis	:	The vector calculator as a library that programs can	//
+ * 			call in-process, without argv strings			//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+
+/*Local Headers*/
+#include "vectorLib.h"
+#include "vectorOps.h"
+#include "vectorOut.h" /*For magnitude()*/
+#include "vectorEpoch.h"
+
+/*
+ * The context behind the opaque pointer. The vector is a struct Vector so the
+ * same kernels the command line uses run on it directly.
+ */
+struct VecContext {
+
+	struct Vector vector;
+	/*Elements the memory behind the vector has room for*/
+	long capacity;
+	/*true if the memory is a buffer of the caller's, from vecalc_load()*/
+	bool borrowed;
+	/*The versions readers take snapshots of, once vecalc_share() is called*/
+	struct Epochs *epochs;
+};
+
+/*
+ * Makes a context with an empty vector
+ * return: The context, or null if it couldn't be allocated
+ */
+struct VecContext *vecalc_create(void) {
+
+return calloc(1, sizeof(struct VecContext));
+}
+
+/*
+ * Frees a context and the memory of its vector. A buffer given to vecalc_load()
+ * is the caller's and isn't freed.
+ * param context: The context. Null is ignored
+ */
+void vecalc_destroy(struct VecContext *context) {
+
+	if(context == NULL) {
+
+		return;
+	}
+
+	/*A shared vector's elements are one of its versions*/
+	if(context->epochs != NULL) {
+
+		epoch_free(context->epochs);
+	}
+	else if(!context->borrowed) {
+
+		free(context->vector.elements);
+	}
+	free(context);
+}
+
+/*
+ * The message for a status, for printing
+ * param status: The status
+ * return: A string that is never freed
+ */
+const char *vecalc_error(enum VecStatus status) {
+
+	switch(status) {
+
+		case VEC_OK:			return "No error";
+		case VEC_NO_MEMORY:		return "Call for memory allocation failed";
+		case VEC_BAD_ARGUMENT:		return "Bad argument";
+		case VEC_DIVIDE_BY_ZERO:	return "Divide by zero error";
+		case VEC_TOO_LARGE:		return "Vector too large";
+		case VEC_BUSY:			return "Too many snapshots held at once";
+	}
+
+return "Unknown error";
+}
+
+/*
+ * Runs one of the element-wise kernels. The kernels print a message for an
+ * empty vector, which a library must not, so they aren't called for one.
+ * param context: The context
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ * return: VEC_OK, VEC_DIVIDE_BY_ZERO, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+static enum VecStatus operate(struct VecContext *context, char option, Elem value) {
+
+	if(context == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	if(option == '/' && value == 0) {
+
+		return VEC_DIVIDE_BY_ZERO;
+	}
+
+	if(context->vector.size == 0) {
+
+		return VEC_OK;
+	}
+
+	/*Readers may be looking at the elements, so the result is a new version*/
+	if(context->epochs != NULL) {
+
+		return epoch_sweep(context->epochs, &context->vector, option, value) ? VEC_OK : VEC_NO_MEMORY;
+	}
+
+	switch(option) {
+
+		case '+':	scalar_plus(&context->vector, value); break;
+		case '-':	scalar_minus(&context->vector, value); break;
+		case '*':	scalar_mult(&context->vector, value); break;
+		case '/':	scalar_div(&context->vector, value); break;
+	}
+
+return VEC_OK;
+}
+
+/*
+ * Adds a value to every element, like the + option
+ * param context: The context
+ * param value: The value
+ * return: VEC_OK, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_plus(struct VecContext *context, Elem value) {
+
+return operate(context, '+', value);
+}
+
+/*
+ * Subtracts a value from every element, like the - option
+ * param context: The context
+ * param value: The value
+ * return: VEC_OK, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_minus(struct VecContext *context, Elem value) {
+
+return operate(context, '-', value);
+}
+
+/*
+ * Multiplies every element by a value, like the * option
+ * param context: The context
+ * param value: The value
+ * return: VEC_OK, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_mult(struct VecContext *context, Elem value) {
+
+return operate(context, '*', value);
+}
+
+/*
+ * Divides every element by a value, like the / option
+ * param context: The context
+ * param value: The value
+ * return: VEC_OK, VEC_DIVIDE_BY_ZERO, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_div(struct VecContext *context, Elem value) {
+
+return operate(context, '/', value);
+}
+
+/*
+ * Sums the elements, like the m option
+ * param context: The context
+ * param result: Set to the sum, which is 0 for an empty vector
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null context or result
+ */
+enum VecStatus vecalc_magnitude(struct VecContext *context, Elem *result) {
+
+	if(context == NULL || result == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+	*result = magnitude(&context->vector);
+
+return VEC_OK;
+}
+
+/*
+ * Appends elements, like the a option given many values. Memory of the
+ * context's own at least doubles when it grows, so appending one element at a
+ * time is not quadratic the way extend_vec() is.
+ * param context: The context
+ * param values: The values, which are copied. Can be null if the count is 0
+ * param count: The number of values
+ * return: VEC_OK, VEC_NO_MEMORY, VEC_BAD_ARGUMENT or VEC_TOO_LARGE
+ */
+enum VecStatus vecalc_append(struct VecContext *context, const Elem *values, long count) {
+
+	if(context == NULL || count < 0 || (values == NULL && count > 0)) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	long size = context->vector.size;
+
+	if(count > INT_MAX - size) {
+
+		return VEC_TOO_LARGE;
+	}
+
+	if(context->epochs != NULL) {
+
+		return epoch_append(context->epochs, &context->vector, values, count) ? VEC_OK : VEC_NO_MEMORY;
+	}
+
+	if(size + count > context->capacity) {
+
+		if(context->borrowed) {
+
+			return VEC_TOO_LARGE;
+		}
+
+		long capacity = context->capacity*2 > size + count ? context->capacity*2 : size + count;
+
+		if(capacity > INT_MAX) {
+
+			capacity = INT_MAX;
+		}
+
+		Elem *elements = realloc(context->vector.elements, capacity*sizeof(Elem));
+
+		if(elements == NULL) {
+
+			return VEC_NO_MEMORY;
+		}
+		context->vector.elements = elements;
+		context->capacity = capacity;
+	}
+
+	if(count > 0) {
+
+		memcpy(context->vector.elements + size, values, count*sizeof(Elem));
+	}
+	context->vector.size += count;
+
+return VEC_OK;
+}
+
+/*
+ * Empties the vector, like the c option
+ * param context: The context
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null context
+ */
+enum VecStatus vecalc_clear(struct VecContext *context) {
+
+	if(context == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	if(context->epochs != NULL) {
+
+		epoch_clear(context->epochs, &context->vector);
+		return VEC_OK;
+	}
+
+	/*The caller's buffer is let go of, and appends start on memory of our own*/
+	if(context->borrowed) {
+
+		context->vector.elements = NULL;
+		context->capacity = 0;
+		context->borrowed = false;
+	}
+	context->vector.size = 0;
+
+return VEC_OK;
+}
+
+/*
+ * Makes a buffer of the caller's the vector, without copying it
+ * param context: The context
+ * param buffer: The buffer
+ * param size: The number of elements already in the buffer
+ * param capacity: The most elements the buffer can hold
+ * return: VEC_OK, VEC_BAD_ARGUMENT or VEC_TOO_LARGE
+ */
+enum VecStatus vecalc_load(struct VecContext *context, Elem *buffer, long size, long capacity) {
+
+	/*Readers could be holding the vector it would replace*/
+	if(context == NULL || buffer == NULL || size < 0 || context->epochs != NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	if(size > capacity || size > INT_MAX) {
+
+		return VEC_TOO_LARGE;
+	}
+
+	if(!context->borrowed) {
+
+		free(context->vector.elements);
+	}
+	context->vector.elements = buffer;
+	context->vector.size = size;
+	context->capacity = capacity;
+	context->borrowed = true;
+
+return VEC_OK;
+}
+
+/*
+ * Copies the vector into a buffer of the caller's
+ * param context: The context
+ * param buffer: The buffer
+ * param capacity: The most elements the buffer can hold
+ * param size: Set to the number of elements in the vector
+ * return: VEC_OK, VEC_BAD_ARGUMENT or VEC_TOO_LARGE
+ */
+enum VecStatus vecalc_store(struct VecContext *context, Elem *buffer, long capacity, long *size) {
+
+	if(context == NULL || buffer == NULL || size == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+	*size = context->vector.size;
+
+	if(context->vector.size > capacity) {
+
+		return VEC_TOO_LARGE;
+	}
+
+	if(buffer != context->vector.elements && context->vector.size > 0) {
+
+		memcpy(buffer, context->vector.elements, context->vector.size*sizeof(Elem));
+	}
+
+return VEC_OK;
+}
+
+/*
+ * Gives the elements of the vector without copying them
+ * param context: The context
+ * param elements: Set to the elements
+ * param size: Set to the number of elements
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument
+ */
+enum VecStatus vecalc_view(struct VecContext *context, const Elem **elements, long *size) {
+
+	if(context == NULL || elements == NULL || size == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+	*elements = context->vector.elements;
+	*size = context->vector.size;
+
+return VEC_OK;
+}
+
+/*
+ * Lets other threads take snapshots of the vector while this one changes it.
+ * The vector's memory becomes the first version.
+ * param context: The context
+ * return: VEC_OK, VEC_NO_MEMORY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_share(struct VecContext *context) {
+
+	if(context == NULL || context->borrowed) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	if(context->epochs == NULL) {
+
+		context->epochs = epoch_share(&context->vector, context->capacity);
+	}
+
+return context->epochs != NULL ? VEC_OK : VEC_NO_MEMORY;
+}
+
+/*
+ * Takes a snapshot of a shared vector, from any thread, without locking
+ * param context: The context
+ * param snapshot: Filled with the snapshot
+ * return: VEC_OK, VEC_BUSY or VEC_BAD_ARGUMENT
+ */
+enum VecStatus vecalc_snapshot(struct VecContext *context, struct VecSnapshot *snapshot) {
+
+	if(context == NULL || snapshot == NULL || context->epochs == NULL) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	struct Vector version;
+	snapshot->reader = epoch_enter(context->epochs, &version, &snapshot->epoch);
+
+	if(snapshot->reader < 0) {
+
+		return VEC_BUSY;
+	}
+	snapshot->elements = version.elements;
+	snapshot->size = version.size;
+
+return VEC_OK;
+}
+
+/*
+ * Lets go of a snapshot
+ * param context: The context it was taken of
+ * param snapshot: The snapshot
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument or a snapshot that
+ * isn't held
+ */
+enum VecStatus vecalc_release(struct VecContext *context, struct VecSnapshot *snapshot) {
+
+	if(context == NULL || snapshot == NULL || context->epochs == NULL || snapshot->reader < 0) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+	epoch_exit(context->epochs, snapshot->reader);
+	snapshot->reader = -1;
+
+return VEC_OK;
+}
+
+/*
+ * Sums the elements of a snapshot, the way the m option sums the vector
+ * param snapshot: The snapshot
+ * param result: Set to the sum
+ * return: VEC_OK, or VEC_BAD_ARGUMENT for a null argument or a snapshot that
+ * isn't held
+ */
+enum VecStatus vecalc_snapshot_magnitude(const struct VecSnapshot *snapshot, Elem *result) {
+
+	if(snapshot == NULL || result == NULL || snapshot->reader < 0) {
+
+		return VEC_BAD_ARGUMENT;
+	}
+
+	struct Vector version;
+	version.elements = (Elem *)snapshot->elements;
+	version.size = snapshot->size;
+	version.sparse = NULL;
+	version.packed = NULL;
+	*result = magnitude(&version);
+
+return VEC_OK;
+}
@@ -10,13 +10,89 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h> /*For memcpy()*/
+#include <sys/mman.h> /*For munmap()*/
 
 /*Local Headers*/
 #include "vecalc.h" /*For definition of Vector*/
 #include "vectorMem.h" /*For checkAlloc() */
+#include "vectorSparse.h"
+#include "vectorPack.h"
+#include "vectorPlace.h" /*For place_copy()*/
+#include "vectorTune.h" /*For the placement*/
+#include "vectorProbe.h"
 
 /*
- * Extend an existing vecotr by 1 element
+ * Elements that were mapped from a file instead of allocated, which are
+ * unmapped instead of freed. Only the vector restored from a snapshot has
+ * them, so there is never more than one.
+ */
+static struct {
+
+	void *base;		/*The start of the mapping*/
+	size_t length;		/*Its length in bytes*/
+	Elem *elements;		/*The elements, somewhere in the mapping*/
+} mapping;
+
+/*
+ * Marks a vector's elements as mapped from a file, so they are unmapped when
+ * they are freed
+ * param base: The start of the mapping
+ * param length: Its length in bytes
+ * param elements: The elements, somewhere in the mapping
+ */
+void map_elements(void *base, size_t length, Elem *elements) {
+
+	mapping.base = base;
+	mapping.length = length;
+	mapping.elements = elements;
+}
+
+/*
+ * Frees the elements of a vector, whether they were allocated or mapped
+ * param elements: The elements. Null is ignored
+ */
+void free_elements(Elem *elements) {
+
+	if(elements != NULL && elements == mapping.elements) {
+
+		munmap(mapping.base, mapping.length);
+		mapping.elements = NULL;
+		return;
+	}
+	free(elements);
+}
+
+/*
+ * Resizes the elements of a vector, as realloc() does. Mapped elements are
+ * moved into memory of their own first
+ * param elements: The elements
+ * param size: The number of elements in them now
+ * param count: The number of elements there needs to be room for
+ * return: The elements, or null if there wasn't memory, which leaves them as
+ * they were
+ */
+Elem *resize_elements(Elem *elements, long size, long count) {
+
+	if(elements == NULL || elements != mapping.elements) {
+
+		return realloc(elements, count*sizeof(Elem));
+	}
+
+	Elem *moved = malloc(count*sizeof(Elem));
+
+	if(moved != NULL) {
+
+		memcpy(moved, elements, (size < count ? size : count)*sizeof(Elem));
+		free_elements(elements);
+	}
+
+return moved;
+}
+
+/*
+ * Extend an existing vecotr by 1 element. A sparse vector stays sparse, and
+ * only its listed elements are copied. A packed vector stays packed
  * param vector: The vector to be extened
  * param Elem: The value placed in the new spot
  * return: A vector (separate from the original) that is one element larger
@@ -26,22 +102,133 @@
  */
 struct Vector *extend_vec(struct Vector *inputVector, Elem value) {
 
+	VEC_PROBE2(vector_grow, inputVector->size, inputVector->size + 1);
+
 	/*Initialise the new vector*/
 	struct Vector *biggerVector = malloc(sizeof(struct Vector));
-	biggerVector->size = inputVector->size + 1;
-	biggerVector->elements = malloc(biggerVector->size*sizeof(Elem));
+	checkAlloc(biggerVector);
+	biggerVector->sparse = NULL;
+	biggerVector->packed = NULL;
+
+	if(inputVector->packed != NULL) {
 
-	/*Copy the elements from the input vector into the new vector*/
-	int i;
-	for(i = 0; i < inputVector->size; i++) {
+		biggerVector->size = inputVector->size;
+		biggerVector->elements = NULL;
+		biggerVector->packed = packed_copy(inputVector);
+		packed_append(biggerVector, &value, 1);
 
-		biggerVector->elements[i] = inputVector->elements[i];
+		return biggerVector;
 	}
+
+	if(inputVector->sparse != NULL) {
+
+		biggerVector->size = inputVector->size;
+		biggerVector->elements = NULL;
+		biggerVector->sparse = sparse_copy(inputVector);
+		sparse_append(biggerVector, &value, 1);
+
+		return biggerVector;
+	}
+	biggerVector->size = inputVector->size + 1;
+	biggerVector->elements = malloc(biggerVector->size*sizeof(Elem));
+	checkAlloc(biggerVector->elements);
+
+	/*
+	 * A plain copy, since this is done for every a. Placing the vector
+	 * again each time would start threads or bind pages for one element;
+	 * it is placed when it is copied or grown by append_vec() instead.
+	 */
+	memcpy(biggerVector->elements, inputVector->elements, inputVector->size*sizeof(Elem));
 	/*Add in the value for the additional element*/
 	biggerVector->elements[(biggerVector->size) -1] = value;
 
 	return biggerVector;
 }
+/*
+ * Extend an existing vector by many elements at once, in place. Only the
+ * values that aren't the background are added to a sparse vector, and a packed
+ * vector packs them
+ * param inputVector: The vector to be extended
+ * param values: The values placed in the new spots, in order
+ * param count: The number of values
+ * return: The same vector, now count elements larger
+ * precond: input vector is not null and the new size is at most MAXVECSIZE
+ */
+struct Vector *append_vec(struct Vector *inputVector, Elem *values, int count) {
+
+	VEC_PROBE2(vector_grow, inputVector->size, inputVector->size + count);
+
+	if(inputVector->sparse != NULL) {
+
+		sparse_append(inputVector, values, count);
+		return inputVector;
+	}
+
+	if(inputVector->packed != NULL) {
+
+		packed_append(inputVector, values, count);
+		return inputVector;
+	}
+
+	Elem *elements;
+
+	/*Outside of local placement, a new buffer is placed the way copies are*/
+	if(tuning.placement != PLACE_LOCAL && inputVector->size > 0) {
+
+		elements = malloc((inputVector->size + count)*sizeof(Elem));
+		checkAlloc(elements);
+		place_copy(elements, inputVector->elements, inputVector->size);
+		free_elements(inputVector->elements);
+	}
+	else {
+
+		elements = resize_elements(inputVector->elements, inputVector->size, inputVector->size + count);
+		checkAlloc(elements);
+	}
+
+	memcpy(elements + inputVector->size, values, count*sizeof(Elem));
+	inputVector->elements = elements;
+	inputVector->size += count;
+
+	return inputVector;
+}
+
+/*
+ * Make a copy of a vector. The copy is dense, even if the vector is sparse or
+ * packed
+ * param inputVector: The vector to copy
+ * return: A new vector with the same elements
+ * precond: input vector is not null
+ */
+struct Vector *copy_vec(struct Vector *inputVector) {
+
+	struct Vector *copy = alloc_vec();
+
+	if(inputVector->sparse != NULL) {
+
+		copy->elements = malloc(inputVector->size*sizeof(Elem));
+		checkAlloc(copy->elements);
+		sparse_fill(inputVector, 0, inputVector->size, copy->elements);
+		copy->size = inputVector->size;
+	}
+	else if(inputVector->packed != NULL) {
+
+		copy->elements = malloc((inputVector->size > 0 ? inputVector->size : 1)*sizeof(Elem));
+		checkAlloc(copy->elements);
+		packed_fill(inputVector, 0, inputVector->size, copy->elements);
+		copy->size = inputVector->size;
+	}
+	else if(inputVector->size > 0) {
+
+		copy->elements = malloc(inputVector->size*sizeof(Elem));
+		checkAlloc(copy->elements);
+		place_copy(copy->elements, inputVector->elements, inputVector->size);
+		copy->size = inputVector->size;
+	}
+
+return copy;
+}
+
 /*
  * Allocate memory for a new vector
  * return: A new vector with 0 size
@@ -63,7 +250,14 @@ return vector;
 
 void dealloc_vec(struct Vector *vector) {
 
-	free(vector->elements);
+	/*The vector is null after the c option*/
+	if(vector == NULL) {
+
+		return;
+	}
+	free_elements(vector->elements);
+	sparse_free(vector->sparse);
+	packed_free(vector->packed);
 	free(vector);
 }
 
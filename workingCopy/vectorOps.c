@@ -11,9 +11,216 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 /*Local Headers*/
 #include "vectorOps.h"
+#include "vectorProbe.h"
+#include "vectorTune.h" /*For the thresholds of each path*/
+#include "vectorSparse.h"
+#include "vectorPack.h"
+#include "vectorPlace.h" /*For the parts and the CPUs they run on*/
+
+#if defined(__GNUC__)
+
+/*
+ * Four elements at once. The alignment of an element lets a Lanes be read from
+ * anywhere in a vector, not only from 16 byte boundaries.
+ */
+typedef Elem Lanes __attribute__((vector_size(16), aligned(sizeof(Elem))));
+#define LANE_COUNT (int)(sizeof(Lanes)/sizeof(Elem))
+
+#endif
+
+/*A range of a vector for one thread of a threaded sweep*/
+struct SweepPart {
+
+	struct Vector part;
+	char option;
+	Elem value;
+	pthread_t thread;
+	bool threaded;
+};
+
+/*
+ * Applies an operation to every element with a scalar loop
+ * param elements: The elements
+ * param size: The number of elements
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+static void scalarLoop(Elem *elements, long size, char option, Elem value) {
+
+	long i;
+	switch(option) {
+
+		case '+':	for(i = 0; i < size; i++) elements[i] += value; break;
+		case '-':	for(i = 0; i < size; i++) elements[i] -= value; break;
+		case '*':	for(i = 0; i < size; i++) elements[i] *= value; break;
+		case '/':	for(i = 0; i < size; i++) elements[i] = elements[i] / value; break;
+	}
+}
+
+/*
+ * Applies an operation four elements at a time, and to the tail of fewer than
+ * four with the scalar loop. Each lane does exactly what the scalar loop does,
+ * so the results are the same bit for bit.
+ * param elements: The elements
+ * param size: The number of elements
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+static void simdLoop(Elem *elements, long size, char option, Elem value) {
+
+	#if defined(__GNUC__)
+
+	/*Set one lane at a time, since 0 + value would turn -0 into 0*/
+	Lanes broadcast;
+	int l;
+	for(l = 0; l < LANE_COUNT; l++) {
+
+		broadcast[l] = value;
+	}
+
+	long whole = size - size%LANE_COUNT;
+	Lanes *lanes = (Lanes *)elements;
+
+	long i;
+	switch(option) {
+
+		case '+':	for(i = 0; i < whole/LANE_COUNT; i++) lanes[i] += broadcast; break;
+		case '-':	for(i = 0; i < whole/LANE_COUNT; i++) lanes[i] -= broadcast; break;
+		case '*':	for(i = 0; i < whole/LANE_COUNT; i++) lanes[i] *= broadcast; break;
+		case '/':	for(i = 0; i < whole/LANE_COUNT; i++) lanes[i] = lanes[i] / broadcast; break;
+	}
+	scalarLoop(elements + whole, size - whole, option, value);
+
+	#else
+
+	scalarLoop(elements, size, option, value);
+
+	#endif
+}
+
+/*
+ * Sweeps one part of a threaded sweep, with SIMD if the part is large enough
+ * param arg: The SweepPart
+ * return: NULL
+ */
+static void *sweepPart(void *arg) {
+
+	struct SweepPart *part = arg;
+
+	sweep(&part->part, part->option, part->value, tuning.simdMin != TUNE_NEVER && part->part.size >= tuning.simdMin ? PATH_SIMD : PATH_SCALAR);
+
+return NULL;
+}
+
+/*
+ * Splits a sweep into contiguous parts, one for each thread. The first part
+ * runs on this thread, unless the placement pins threads, when it runs on the
+ * CPU that place_copy() first touched it from.
+ * param vector: The vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+static void threadLoop(struct Vector *vector, char option, Elem value) {
+
+	struct SweepPart parts[TUNE_MAX_THREADS];
+	int threads = place_parts();
+	bool pinned = tuning.placement != PLACE_LOCAL;
+
+	int t;
+	for(t = 0; t < threads; t++) {
+
+		long first = (long)vector->size*t/threads;
+		long last = (long)vector->size*(t + 1)/threads;
+
+		parts[t].part.elements = vector->elements + first;
+		parts[t].part.size = last - first;
+		parts[t].option = option;
+		parts[t].value = value;
+
+		/*A part that can't get a thread is run here instead*/
+		parts[t].threaded = (t > 0 || pinned) && place_thread(&parts[t].thread, sweepPart, &parts[t], t, threads) == 0;
+
+		if(t > 0 && !parts[t].threaded) {
+
+			sweepPart(&parts[t]);
+		}
+	}
+
+	if(!parts[0].threaded) {
+
+		sweepPart(&parts[0]);
+	}
+
+	for(t = 0; t < threads; t++) {
+
+		if(parts[t].threaded) {
+
+			pthread_join(parts[t].thread, NULL);
+		}
+	}
+}
+
+/*
+ * Applies an operation to every element of a vector, with a scalar loop, SIMD
+ * or threads
+ * param vector: The vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ * param path: The path to take, or PATH_AUTO for the fastest one for the size
+ * of the vector according to tuning
+ */
+void sweep(struct Vector *vector, char option, Elem value, enum Path path) {
+
+	if(path == PATH_AUTO) {
+
+		if(tuning.threadMin != TUNE_NEVER && vector->size >= tuning.threadMin) {
+
+			path = PATH_THREADS;
+		}
+		else if(tuning.simdMin != TUNE_NEVER && vector->size >= tuning.simdMin) {
+
+			path = PATH_SIMD;
+		}
+		else {
+
+			path = PATH_SCALAR;
+		}
+	}
+
+	switch(path) {
+
+		case PATH_THREADS:	threadLoop(vector, option, value); break;
+		case PATH_SIMD:		simdLoop(vector->elements, vector->size, option, value); break;
+		default:		scalarLoop(vector->elements, vector->size, option, value); break;
+	}
+}
+
+/*
+ * Applies an operation to every element of a vector, which only touches the
+ * listed elements of a sparse vector, and one block at a time of a packed one
+ * param vector: The vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+static void operate(struct Vector *vector, char option, Elem value) {
+
+	if(vector->sparse != NULL) {
+
+		sparse_sweep(vector, option, value);
+	}
+	else if(vector->packed != NULL) {
+
+		packed_sweep(vector, option, value);
+	}
+	else {
+
+		sweep(vector, option, value, PATH_AUTO);
+	}
+}
 
 /*
  * Adds a chosen value to each element of the vector
@@ -36,11 +243,10 @@ struct Vector *scalar_plus(struct Vector *vector, Elem addend) {
 	}
 	else {
 		
-		int i;
-		for(i = 0; i < vector->size; i++) {
+		VEC_PROBE2(kernel_entry, '+', vector->size);
 
-			vector->elements[i] += addend;
-		}
+		operate(vector, '+', addend);
+		VEC_PROBE2(kernel_exit, '+', vector->size);
 	}
 
 return vector;
@@ -67,11 +273,10 @@ struct Vector *scalar_minus(struct Vector *vector, Elem difference) {
 	}
 	else {
 
-		int i;
-		for(i = 0; i < vector->size; i++) {
+		VEC_PROBE2(kernel_entry, '-', vector->size);
 
-			vector->elements[i] -= difference;
-		}
+		operate(vector, '-', difference);
+		VEC_PROBE2(kernel_exit, '-', vector->size);
 	}	
 
 return vector;
@@ -97,11 +302,10 @@ struct Vector *scalar_mult(struct Vector *vector, Elem factor) {
 	}
 	else {
 		
-		int i;
-		for(i = 0; i < vector->size; i++) {
+		VEC_PROBE2(kernel_entry, '*', vector->size);
 
-			vector->elements[i] *= factor;
-		}
+		operate(vector, '*', factor);
+		VEC_PROBE2(kernel_exit, '*', vector->size);
 	}
 
 return vector;
@@ -128,11 +332,10 @@ struct Vector *scalar_div(struct Vector *vector, Elem divisor) {
 	}
 	else {
 
-		int i;
-		for(i = 0; i < vector->size; i++) {
+		VEC_PROBE2(kernel_entry, '/', vector->size);
 
-			vector->elements[i] = (vector->elements[i]) / (divisor);
-		}
+		operate(vector, '/', divisor);
+		VEC_PROBE2(kernel_exit, '/', vector->size);
 	}
 
 return vector;
@@ -147,11 +350,26 @@ float magnitude(struct Vector *vector) {
 
 	float magnitude = 0;
 
-	int i;
-	for(i = 0; i < vector->size; i++) {
+	VEC_PROBE2(kernel_entry, 'm', vector->size);
+
+	/*A sparse vector is summed in the time it takes to add up what it lists*/
+	if(vector->sparse != NULL) {
 
-		magnitude += vector->elements[i];
+		magnitude = sparse_magnitude(vector);
+	}
+	else if(vector->packed != NULL) {
+
+		magnitude = packed_magnitude(vector);
+	}
+	else {
+
+		int i;
+		for(i = 0; i < vector->size; i++) {
+
+			magnitude += vector->elements[i];
+		}
 	}
+	VEC_PROBE2(kernel_exit, 'm', vector->size);
 	
 return magnitude;
 }
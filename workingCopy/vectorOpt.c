@@ -0,0 +1,344 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorOpt.c						//
+ * Synopsis	:	Peephole optimizer that removes redundant work from a	//
+ * 			list of commands before it is run			//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+
+/*Local Headers*/
+#include "vectorOpt.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+
+/*
+ * Checks if a command adds or subtracts a value
+ * param cmd: The command to check
+ * return: true if it is + or -, false otherwise
+ */
+static bool isAdditive(struct Command *cmd) {
+
+return cmd->option == '+' || cmd->option == '-';
+}
+
+/*
+ * Checks if a command multiplies or divides by a value. Division by zero
+ * reports an error when it's run, so it is never folded into anything.
+ * param cmd: The command to check
+ * return: true if it is * or a / by something other than zero
+ */
+static bool isMultiplicative(struct Command *cmd) {
+
+return cmd->option == '*' || (cmd->option == '/' && cmd->value != 0);
+}
+
+/*
+ * Checks if a command changes the vector. z does too: bf16 and fp16 round
+ * the elements when they pack them
+ * param cmd: The command to check
+ * return: true if the vector can be different after the command is run
+ */
+static bool isMutation(struct Command *cmd) {
+
+	switch(cmd->option) {
+
+		case 'a':
+		case '+':
+		case '-':
+		case '*':
+		case '/':
+		case 'z':
+		case 'c':	return true;
+	}
+
+return false;
+}
+
+/*
+ * Checks if a command only changes the elements of the vector, and nothing
+ * else in the session, so it can be dropped if the vector is thrown away
+ * param cmd: The command to check
+ * return: true if it is a, +, -, * or /
+ */
+static bool isElementChange(struct Command *cmd) {
+
+return cmd->option == 'a' || isAdditive(cmd) || cmd->option == '*' || cmd->option == '/';
+}
+
+/*
+ * Checks if a command leaves every element exactly as it was. + 0 isn't one,
+ * since it turns -0 into +0, but - 0 and + -0 are
+ * param cmd: The command to check
+ * return: true if running the command has no effect on the vector
+ */
+static bool isNoOp(struct Command *cmd) {
+
+	if(isAdditive(cmd) && cmd->value == 0) {
+
+		uint32_t bits;
+		memcpy(&bits, &cmd->value, sizeof(bits));
+
+		/*The sign bit has to be set for +, and clear for -*/
+		return (cmd->option == '+') == ((bits & 0x80000000) != 0);
+	}
+	else if(isMultiplicative(cmd)) {
+
+		return cmd->value == 1;
+	}
+
+return false;
+}
+
+/*
+ * What a * or / multiplies the elements by, if that is a power of two of at
+ * least one. Scaling by one of those is exact until it overflows, and then it
+ * is an infinity however it was scaled, so two of them give the same bits
+ * together as they do one after the other.
+ * param cmd: The * or / command
+ * return: The power of two, or 0 if it isn't one
+ */
+static double scale(struct Command *cmd) {
+
+	uint32_t bits;
+	memcpy(&bits, &cmd->value, sizeof(bits));
+
+	/*A normal float with no bits set in its mantissa*/
+	if((bits & 0x007FFFFF) != 0 || (bits & 0x7F800000) == 0 || (bits & 0x7F800000) == 0x7F800000) {
+
+		return 0;
+	}
+	double value = cmd->option == '*' ? cmd->value : 1/(double)cmd->value;
+
+return value >= 1 || value <= -1 ? value : 0;
+}
+
+/*
+ * Folds the second of two neighbouring commands into the first. They are only
+ * folded when the folded command gives every element the same bits as the two
+ * did, so + and - are never folded (x + 1 - 1 isn't x when x is small), and
+ * * and / only when both scale by a power of two of at least one.
+ * param into: The earlier command, which holds the folded result
+ * param cmd: The later command
+ * return: true if the commands were folded, false if they couldn't be
+ */
+static bool fold(struct Command *into, struct Command *cmd) {
+
+	if(!isMultiplicative(into) || !isMultiplicative(cmd)) {
+
+		return false;
+	}
+
+	double value = scale(into)*scale(cmd);
+
+	/*The product has to be an Elem itself, or 0 * it would be NaN*/
+	if(value == 0 || value > FLT_MAX || value < -FLT_MAX) {
+
+		return false;
+	}
+	into->option = '*';
+	into->value = value;
+
+return true;
+}
+
+/*
+ * Narrows down the size the vector can be after a command
+ * param cmd: The command
+ * param least: The smallest size it can be, updated for the command
+ * param most: The largest size it can be, updated for the command
+ */
+static void trackSize(struct Command *cmd, long *least, long *most) {
+
+	if(cmd->option == 'c') {
+
+		*least = 0;
+		*most = 0;
+	}
+	else if(cmd->option == 'a') {
+
+		*least = *least < MAXVECSIZE ? *least + 1 : MAXVECSIZE;
+		*most = *most < MAXVECSIZE ? *most + 1 : MAXVECSIZE;
+	}
+}
+
+/*
+ * Checks if a command that changes the elements is sure not to print a
+ * diagnostic, so that dropping it doesn't change the error output. An append
+ * can find the vector full, and the others can find it empty.
+ * param cmd: The command to check
+ * param least: The smallest size the vector can be before it
+ * param most: The largest size the vector can be before it
+ * return: true if the command can't print anything
+ */
+static bool isQuiet(struct Command *cmd, long least, long most) {
+
+	if(cmd->option == 'a') {
+
+		return most < MAXVECSIZE;
+	}
+
+return least > 0 && (cmd->option != '/' || cmd->value != 0);
+}
+
+/*
+ * Peephole optimizer for a line of commands
+ * param cmds: The list of commands. It is optimized in place
+ * param count: The number of commands in the list
+ * param report: If not null, a line is printed here for every command that was
+ * eliminated or changed
+ * return: The number of commands left in the list
+ */
+int optimizeCommands(struct Command *cmds, int count, FILE *report) {
+
+	/*Number of commands kept so far. cmds[n - 1] is the last one kept*/
+	int n = 0;
+
+	/*
+	 * The size of the vector isn't known at the start of the line, only how
+	 * it changes. Nothing that could print a diagnostic is dropped or folded.
+	 */
+	long least = 0;
+	long most = MAXVECSIZE;
+
+	/*
+	 * First pass: fold constants and drop commands with no effect. Folding
+	 * can produce a command with no effect (* -1 * -1), so that is checked
+	 * after every fold as well. Only + - * and / are dropped or folded, so
+	 * what is known about the size stays the same for the commands kept.
+	 */
+	int i;
+	for(i = 0; i < count; i++) {
+
+		struct Command cmd = cmds[i];
+		bool quiet = isElementChange(&cmd) && isQuiet(&cmd, least, most);
+		trackSize(&cmd, &least, &most);
+
+		if(quiet && isNoOp(&cmd)) {
+
+			if(report != NULL) {
+
+				fprintf(report, "Optimizer: dropped '%c %g' (no effect)\n", cmd.option, cmd.value);
+			}
+			continue;
+		}
+
+		if(quiet && n > 0) {
+
+			struct Command before = cmds[n - 1];
+
+			if(fold(&cmds[n - 1], &cmd)) {
+
+				if(report != NULL) {
+
+					fprintf(report, "Optimizer: folded '%c %g' '%c %g' into '%c %g'\n", before.option, before.value, cmd.option, cmd.value, cmds[n - 1].option, cmds[n - 1].value);
+				}
+				if(isNoOp(&cmds[n - 1])) {
+
+					if(report != NULL) {
+
+						fprintf(report, "Optimizer: dropped '%c %g' (no effect)\n", cmds[n - 1].option, cmds[n - 1].value);
+					}
+					n--;
+				}
+				continue;
+			}
+		}
+		cmds[n++] = cmd;
+	}
+	count = n;
+
+	bool *quiet = malloc(count*sizeof(bool) + 1);
+	checkAlloc(quiet);
+	least = 0;
+	most = MAXVECSIZE;
+
+	for(i = 0; i < count; i++) {
+
+		quiet[i] = isElementChange(&cmds[i]) && isQuiet(&cmds[i], least, most);
+		trackSize(&cmds[i], &least, &most);
+	}
+
+	/*
+	 * Second pass, backwards: anything that changes the vector before a
+	 * c, q or e without being printed or queried in between is thrown
+	 * away, so there is no point in running it. One that could print a
+	 * diagnostic is kept, and so is everything before it, so it sees the
+	 * vector it would have without the optimizer.
+	 */
+	char discardedBy = 0;
+
+	for(i = count - 1; i >= 0; i--) {
+
+		char option = cmds[i].option;
+
+		if(option == 'c' || option == 'q' || option == 'e') {
+
+			discardedBy = option;
+		}
+		else if(discardedBy != 0 && quiet[i]) {
+
+			if(report != NULL) {
+
+				fprintf(report, "Optimizer: dropped '%c %g' (result discarded by '%c')\n", option, cmds[i].value, discardedBy);
+			}
+			cmds[i].option = 0;
+		}
+		/*
+		 * Options that only change the session, such as f, are kept, and
+		 * don't look at the vector. Any other option might.
+		 */
+		else if(option != 'f' && option != 'h') {
+
+			discardedBy = 0;
+		}
+	}
+	free(quiet);
+
+	/*Close the gaps left by the second pass*/
+	n = 0;
+	for(i = 0; i < count; i++) {
+
+		if(cmds[i].option != 0) {
+
+			cmds[n++] = cmds[i];
+		}
+	}
+	count = n;
+
+	/*
+	 * Third pass: a query repeated with no change to the vector in between
+	 * gives the same answer, so it re-uses the earlier one.
+	 */
+	bool queried = false;
+
+	for(i = 0; i < count; i++) {
+
+		if(cmds[i].option == 'm') {
+
+			if(queried) {
+
+				cmds[i].reuse = true;
+
+				if(report != NULL) {
+
+					fprintf(report, "Optimizer: re-using result of 'm' (no change since the last 'm')\n");
+				}
+			}
+			queried = true;
+		}
+		else if(isMutation(&cmds[i])) {
+
+			queried = false;
+		}
+	}
+
+return count;
+}
@@ -7,20 +7,155 @@
  *===============================================================================/
  */
 
+/*For fileno()*/
+#define _POSIX_C_SOURCE 200809L
+
 /*Standard Headers*/
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h> /*For write()*/
+#include <inttypes.h> /*For PRIx64*/
+#include <sys/uio.h> /*For writev()*/
 
 /*Local Headers*/
 #include "vectorOut.h"
 
 /*
- * Allocate memory for a new vector
- * return: A new vector with 0 size
+ * Print the vector to stdout
+ * Param vector: pointer to vector to be printed
+ * return: True if it can be printed, false otherwise
  */
 bool print_vec(struct Vector *vector) {
 
+return fprint_vec(stdout, vector);
+}
+
+/*
+ * Formats an element exactly the same as printf's "%f" does
+ * param buffer: Where the text is placed. It needs room for FORMAT_MAX_LENGTH
+ * characters
+ * param value: The element to format
+ * return: The number of characters placed in buffer, not including a null
+ * terminator, which isn't added
+ */
+int formatElem(char *buffer, Elem value) {
+
+	/*
+	 * A float has 24 significant bits and 10^6 = 2^6 * 15625 has 14, so
+	 * scaling to six decimal places is exact in a double. Rounding the
+	 * exact value to the nearest integer, ties to even, gives the same
+	 * digits as printf.
+	 */
+	double scaled = (double)value * 1000000.0;
+	double magnitude = scaled < 0 ? -scaled : scaled;
+
+	/*NaN, infinity, and values too big for 64 bits go through printf*/
+	if(!(magnitude < 9.0e18)) {
+
+		return sprintf(buffer, "%f", value);
+	}
+
+	/*
+	 * Adding and subtracting 2^52 rounds to an integer, ties to even.
+	 * Anything at least 2^52 is already an integer.
+	 */
+	const double TWO_52 = 4503599627370496.0;
+
+	if(magnitude < TWO_52) {
+
+		magnitude = (magnitude + TWO_52) - TWO_52;
+	}
+	uint64_t digits = magnitude;
+
+	/*printf keeps the sign of negative values that round to zero*/
+	union {
+
+		float f;
+		uint32_t bits;
+	} sign;
+	sign.f = value;
+
+	char reversed[24];
+	int n = 0;
+
+	/*The six decimal places, then the whole part*/
+	int i;
+	for(i = 0; i < 6; i++) {
+
+		reversed[n++] = '0' + digits % 10;
+		digits /= 10;
+	}
+	reversed[n++] = '.';
+
+	do {
+
+		reversed[n++] = '0' + digits % 10;
+		digits /= 10;
+	} while(digits > 0);
+
+	int length = 0;
+
+	if(sign.bits >> 31) {
+
+		buffer[length++] = '-';
+	}
+
+	while(n > 0) {
+
+		buffer[length++] = reversed[--n];
+	}
+
+return length;
+}
+
+/*
+ * Writes out formatted text. Streams that are backed by a file descriptor
+ * are flushed first and then written to directly, so that the text is in the
+ * right place and written with as few calls as possible.
+ * param stream: Where the text is written
+ * param buffer: The text
+ * param length: The number of characters in buffer
+ */
+void writeOut(FILE *stream, char *buffer, size_t length) {
+
+	int fd = fileno(stream);
+
+	if(fd < 0) {
+
+		fwrite(buffer, 1, length, stream);
+		return;
+	}
+	fflush(stream);
+
+	while(length > 0) {
+
+		ssize_t n = write(fd, buffer, length);
+
+		if(n < 0) {
+
+			if(errno == EINTR) {
+
+				continue;
+			}
+			return;
+		}
+		buffer += n;
+		length -= n;
+	}
+}
+
+/*
+ * Print the vector to a stream, one element per line
+ * param stream: Where the elements are printed
+ * param vector: pointer to vector to be printed
+ * return: True if it can be printed, false otherwise
+ */
+bool fprint_vec(FILE *stream, struct Vector *vector) {
+
 	if(vector == NULL) {
 
 		fprintf(stderr, "There is no vector to print\n");
@@ -28,38 +163,605 @@ bool print_vec(struct Vector *vector) {
 	}
 	else if(vector->size == 0) {
 
-		printf("Nothing to print. Vector has zero size\n");
+		fprintf(stream, "Nothing to print. Vector has zero size\n");
 		return EXIT_SUCCESS;
 	}
 	else {
 
+		return fprint_range(stream, vector, 0, vector->size, 1, FORMAT_TEXT);
+	}
+}	
+
+/*
+ * Formats an element so that it reads back as exactly the same float, for
+ * formats that are meant to be parsed again
+ * param buffer: Where the text is placed, with room for FORMAT_MAX_LENGTH
+ * param value: The element to format
+ * param json: true if infinity and NaN have to be written as null
+ * return: The number of characters placed in buffer
+ */
+static int formatExact(char *buffer, Elem value, bool json) {
+
+	/*Infinity and NaN are the only values where this isn't zero*/
+	if(json && value - value != 0) {
+
+		memcpy(buffer, "null", 4);
+		return 4;
+	}
+
+	/*Nine significant digits are always enough for a float*/
+	return sprintf(buffer, "%.9g", value);
+}
+
+/*
+ * Writes the raw elements of a vector after a BinaryFrame. Elements next to
+ * each other are written straight from the vector without copying them.
+ * param stream: Where the frame is written
+ * param kind: The kind of frame
+ * param elements: The first element to write
+ * param count: The number of elements
+ * param step: The distance between the elements that are written
+ */
+static void writeFrame(FILE *stream, char kind, Elem *elements, int count, int step) {
+
+	struct BinaryFrame frame;
+	memset(&frame, 0, sizeof(struct BinaryFrame));
+	frame.kind = kind;
+	frame.count = count;
+
+	if(step > 1) {
+
+		/*Gather the elements a buffer at a time*/
+		Elem gathered[PRINT_BUFFER_SIZE/sizeof(Elem)];
+		int length = 0;
+
+		writeOut(stream, (char *)&frame, sizeof(struct BinaryFrame));
+
 		int i;
-		for(i = 0; i < vector->size; i++) {
+		for(i = 0; i < count; i++) {
+
+			if(length == PRINT_BUFFER_SIZE/sizeof(Elem)) {
 
-			printf("%f\n", vector->elements[i]);
+				writeOut(stream, (char *)gathered, length*sizeof(Elem));
+				length = 0;
+			}
+			gathered[length++] = elements[(long)i*step];
 		}
+		writeOut(stream, (char *)gathered, length*sizeof(Elem));
+		return;
+	}
+
+	int fd = fileno(stream);
+
+	if(fd < 0) {
+
+		fwrite(&frame, sizeof(struct BinaryFrame), 1, stream);
+		fwrite(elements, sizeof(Elem), count, stream);
+		return;
+	}
+	fflush(stream);
+
+	struct iovec parts[2];
+	parts[0].iov_base = &frame;
+	parts[0].iov_len = sizeof(struct BinaryFrame);
+	parts[1].iov_base = elements;
+	parts[1].iov_len = count*sizeof(Elem);
+
+	/*Carry on from wherever a short write stopped*/
+	int part = 0;
+
+	while(part < 2) {
+
+		ssize_t n = writev(fd, parts + part, 2 - part);
+
+		if(n < 0) {
+
+			if(errno == EINTR) {
+
+				continue;
+			}
+			return;
+		}
+
+		while(part < 2 && (size_t)n >= parts[part].iov_len) {
+
+			n -= parts[part].iov_len;
+			part++;
+		}
+
+		if(part < 2) {
+
+			parts[part].iov_base = (char *)parts[part].iov_base + n;
+			parts[part].iov_len -= n;
+		}
+	}
+}
+
+/*
+ * The 8 byte field of a binary frame that holds a whole number
+ * param value: The number
+ * return: Its two's complement bits
+ */
+static uint64_t intField(long value) {
+
+return (uint64_t)(int64_t)value;
+}
+
+/*
+ * The 8 byte field of a binary frame that holds a number that isn't whole
+ * param value: The number
+ * return: Its bits as a double
+ */
+static uint64_t realField(double value) {
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(uint64_t));
+
+return bits;
+}
+
+/*
+ * Writes a BinaryFrame followed by 8 byte fields, least significant byte
+ * first whatever the host, so counts, indices and latencies too large for an
+ * Elem to hold exactly come out whole
+ * param stream: Where the frame is written
+ * param kind: The kind of frame
+ * param fields: The fields, from intField() and realField()
+ * param count: The number of fields
+ */
+static void writeFields(FILE *stream, char kind, uint64_t *fields, int count) {
+
+	struct BinaryFrame frame;
+	memset(&frame, 0, sizeof(struct BinaryFrame));
+	frame.kind = kind;
+	frame.count = count;
+	writeOut(stream, (char *)&frame, sizeof(struct BinaryFrame));
+
+	unsigned char bytes[8*(6 + DIFF_FIRST_MAX + 7*STATS_OPTIONS)];
+	int length = 0;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		int b;
+		for(b = 0; b < 8; b++) {
+
+			bytes[length++] = (fields[i] >> 8*b) & 0xFF;
+		}
+	}
+	writeOut(stream, (char *)bytes, length);
+}
+
+/*
+ * Print the vector to a stream in one of the output formats
+ * param stream: Where the elements are printed
+ * param vector: pointer to vector to be printed
+ * param format: The format to print in
+ * return: True if it can be printed, false otherwise
+ */
+bool fprint_vec_as(FILE *stream, struct Vector *vector, enum Format format) {
+
+	if(vector == NULL) {
+
+		fprintf(stderr, "There is no vector to print\n");
+		return EXIT_FAILURE;
+	}
+
+	if(format == FORMAT_TEXT) {
+
+		return fprint_vec(stream, vector);
+	}
+
+return fprint_range(stream, vector, 0, vector->size, 1, format);
+}
+
+/*
+ * Print part of the vector to a stream in one of the output formats. Only the
+ * elements that are printed are read.
+ * param stream: Where the elements are printed
+ * param vector: pointer to vector to be printed
+ * param first: Index of the first element to print
+ * param last: Index one past the last element that may be printed
+ * param step: The distance between printed elements
+ * param format: The format to print in
+ * return: True if it can be printed, false otherwise
+ */
+bool fprint_range(FILE *stream, struct Vector *vector, int first, int last, int step, enum Format format) {
+
+	if(vector == NULL) {
+
+		fprintf(stderr, "There is no vector to print\n");
+		return EXIT_FAILURE;
+	}
+
+return fprint_window(stream, vector->elements + first, first, last, step, format);
+}
+
+/*
+ * Print elements from first up to last, held in a buffer that starts at the
+ * element first instead of at the start of the vector
+ * param stream: Where the elements are printed
+ * param window: The elements, the first one at index 0
+ * param first: Index in the vector of the first element to print
+ * param last: Index one past the last element that may be printed
+ * param step: The distance between printed elements
+ * param format: The format to print in
+ * return: True if it can be printed, false otherwise
+ */
+bool fprint_window(FILE *stream, Elem *window, int first, int last, int step, enum Format format) {
+
+	/*Number of elements that will be printed*/
+	int count = first < last ? (last - first - 1)/step + 1 : 0;
+
+	if(format == FORMAT_BINARY) {
+
+		writeFrame(stream, 'p', window, count, step);
 		return EXIT_SUCCESS;
 	}
-}	
+
+	/*
+	 * Formatting into one large buffer is much faster than a printf for
+	 * every element
+	 */
+	char buffer[PRINT_BUFFER_SIZE];
+	size_t length = 0;
+	bool json = format == FORMAT_JSON;
+
+	if(json) {
+
+		buffer[length++] = '[';
+	}
+	else if(format == FORMAT_CSV) {
+
+		length += sprintf(buffer, "index,value\n");
+	}
+
+	int i;
+	for(i = first; count > 0; i += step, count--) {
+
+		/*Room for an index, a separator and the value*/
+		if(length > PRINT_BUFFER_SIZE - 2*FORMAT_MAX_LENGTH) {
+
+			writeOut(stream, buffer, length);
+			length = 0;
+		}
+
+		if(format == FORMAT_TEXT) {
+
+			length += formatElem(buffer + length, window[i - first]);
+			buffer[length++] = '\n';
+			continue;
+		}
+
+		if(json) {
+
+			if(i > first) {
+
+				buffer[length++] = ',';
+			}
+		}
+		else {
+
+			length += sprintf(buffer + length, "%d,", i);
+		}
+		length += formatExact(buffer + length, window[i - first], json);
+
+		if(!json) {
+
+			buffer[length++] = '\n';
+		}
+	}
+
+	if(json) {
+
+		buffer[length++] = ']';
+		buffer[length++] = '\n';
+	}
+	writeOut(stream, buffer, length);
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ * Print the result of a magnitude query in one of the output formats
+ * param stream: Where the magnitude is printed
+ * param magnitude: The magnitude
+ * param format: The format to print in
+ */
+void fprint_magnitude(FILE *stream, Elem magnitude, enum Format format) {
+
+	char value[FORMAT_MAX_LENGTH + 1];
+
+	switch(format) {
+
+		case FORMAT_TEXT:	fprintf(stream, "Magnitude: %f\n", magnitude);
+					break;
+
+		case FORMAT_CSV:	value[formatExact(value, magnitude, false)] = '\0';
+					fprintf(stream, "magnitude\n%s\n", value);
+					break;
+
+		case FORMAT_JSON:	value[formatExact(value, magnitude, true)] = '\0';
+					fprintf(stream, "{\"magnitude\":%s}\n", value);
+					break;
+
+		case FORMAT_BINARY:	writeFrame(stream, 'm', &magnitude, 1, 1);
+					break;
+	}
+}
+
+/*
+ * Print a checksum or fingerprint in one of the output formats
+ * param stream: Where the checksum is printed
+ * param hash: The checksum or fingerprint
+ * param name: "checksum" or "fingerprint"
+ * param format: The format to print in
+ */
+void fprint_hash(FILE *stream, uint64_t hash, const char *name, enum Format format) {
+
+	switch(format) {
+
+		case FORMAT_TEXT:	fprintf(stream, "%c%s: %016" PRIx64 "\n", name[0] - 'a' + 'A', name + 1, hash);
+					break;
+
+		case FORMAT_CSV:	fprintf(stream, "%s\n%016" PRIx64 "\n", name, hash);
+					break;
+
+		case FORMAT_JSON:	fprintf(stream, "{\"%s\":\"%016" PRIx64 "\"}\n", name, hash);
+					break;
+
+		case FORMAT_BINARY:	writeFields(stream, 'x', &hash, 1);
+					break;
+	}
+}
 
 /*
- * Prints a help page for usage of vecalc to a file in the CWD
- */
-void getHelp() {
-
-	printf("Vecalc is a program that can perform operations on a vector (1 dimensional array)\n");
-	printf("Usage: <Option> [Value]\n");
-	printf("Options:\n");
-	printf("q : quit; Same functionality as e (end)\n");
-	printf("c : clear; Delete the current vector and start a new one\n");
-	printf("p : print; Output the contents of the vector to the console \n");
-	printf("h : help; Output the list of commands and the usage\n");
-	printf("m : magnitude; Output the magnitude to the console\n");
-	printf("r [option] [value] : repeat; repeat the last command given with a new set of commands. Repeat can not be preceeded by any other command\n");
-	printf("a <value> : append; extend the vector by one element and fill the element with the value \n");
-	printf("+ <value> : scalar plus;  add [value] to each element of the vector\n");
-	printf("- <value> : scalar minus; subtract [value] from each element of the vector\n");
-	printf("* <value> : scalar multiply; multiply [value] to each element of the vector\n");
-	printf("/ <value> : scalar divide; divide [value] from each element of the vector\n");
-	printf("e : end; terminate the vecalc program\n");
+ * Print how a vector is stored in one of the output formats. The ratio is how
+ * many times smaller it is than an Elem for each element.
+ * param stream: Where the report is printed
+ * param report: The report
+ * param format: The format to print in
+ */
+void fprint_storage(FILE *stream, struct PackReport *report, enum Format format) {
+
+	const char *names[] = {"float", "bf16", "fp16", "lossless"};
+	const char *name = names[report->storage];
+	double ratio = report->bytes > 0 ? (double)report->elements*sizeof(Elem)/report->bytes : 1;
+	uint64_t fields[8];
+
+	switch(format) {
+
+		case FORMAT_TEXT:	fprintf(stream, "Storage: %s, %ld elements in %ld bytes, %.2fx smaller\n", name, report->elements, report->bytes, ratio);
+					fprintf(stream, "Precision: %d bits, max relative error %g, %ld overflowed, %ld became 0\n", report->bits, report->maxError, report->overflows, report->underflows);
+					break;
+
+		case FORMAT_CSV:	fprintf(stream, "storage,elements,bytes,ratio,bits,max_error,overflows,underflows\n");
+					fprintf(stream, "%s,%ld,%ld,%.4f,%d,%g,%ld,%ld\n", name, report->elements, report->bytes, ratio, report->bits, report->maxError, report->overflows, report->underflows);
+					break;
+
+		case FORMAT_JSON:	fprintf(stream, "{\"storage\":\"%s\",\"elements\":%ld,\"bytes\":%ld,\"ratio\":%.4f,\"bits\":%d,\"maxError\":%g,\"overflows\":%ld,\"underflows\":%ld}\n", name, report->elements, report->bytes, ratio, report->bits, report->maxError, report->overflows, report->underflows);
+					break;
+
+		case FORMAT_BINARY:	fields[0] = intField(report->storage);
+					fields[1] = intField(report->elements);
+					fields[2] = intField(report->bytes);
+					fields[3] = realField(ratio);
+					fields[4] = intField(report->bits);
+					fields[5] = realField(report->maxError);
+					fields[6] = intField(report->overflows);
+					fields[7] = intField(report->underflows);
+					writeFields(stream, 'z', fields, 8);
+					break;
+	}
+}
+
+/*
+ * Print the result of comparing the vector against a reference in one of the
+ * output formats
+ * param stream: Where the result is printed
+ * param result: What the comparison found
+ * param size: The size of the vector
+ * param referenceSize: The size of the reference vector
+ * param format: The format to print in
+ */
+void fprint_diff(FILE *stream, struct DiffResult *result, int size, int referenceSize, enum Format format) {
+
+	char maxError[FORMAT_MAX_LENGTH + 1];
+	maxError[formatExact(maxError, result->maxError, format == FORMAT_JSON)] = '\0';
+
+	uint64_t fields[6 + DIFF_FIRST_MAX];
+
+	int i;
+	switch(format) {
+
+		case FORMAT_TEXT:	fprintf(stream, "Diff: %ld of %ld elements differ, max error %s", result->mismatches, result->compared, maxError);
+
+					if(result->maxErrorIndex >= 0) {
+
+						fprintf(stream, " at index %ld", result->maxErrorIndex);
+					}
+					fprintf(stream, "\n");
+
+					if(size != referenceSize) {
+
+						fprintf(stream, "Sizes differ: %d and %d in the reference\n", size, referenceSize);
+					}
+
+					if(result->firstCount > 0) {
+
+						fprintf(stream, "First differences at:");
+
+						for(i = 0; i < result->firstCount; i++) {
+
+							fprintf(stream, " %ld", result->first[i]);
+						}
+						fprintf(stream, "\n");
+					}
+					break;
+
+		case FORMAT_CSV:	fprintf(stream, "compared,mismatches,max_error,max_error_index,size,reference_size,first\n");
+					fprintf(stream, "%ld,%ld,%s,%ld,%d,%d,", result->compared, result->mismatches, maxError, result->maxErrorIndex, size, referenceSize);
+
+					for(i = 0; i < result->firstCount; i++) {
+
+						fprintf(stream, i > 0 ? " %ld" : "%ld", result->first[i]);
+					}
+					fprintf(stream, "\n");
+					break;
+
+		case FORMAT_JSON:	fprintf(stream, "{\"compared\":%ld,\"mismatches\":%ld,\"maxError\":%s,\"maxErrorIndex\":%ld,\"size\":%d,\"referenceSize\":%d,\"first\":[", result->compared, result->mismatches, maxError, result->maxErrorIndex, size, referenceSize);
+
+					for(i = 0; i < result->firstCount; i++) {
+
+						fprintf(stream, i > 0 ? ",%ld" : "%ld", result->first[i]);
+					}
+					fprintf(stream, "]}\n");
+					break;
+
+		case FORMAT_BINARY:	fields[0] = intField(result->compared);
+					fields[1] = intField(result->mismatches);
+					fields[2] = realField(result->maxError);
+					fields[3] = intField(result->maxErrorIndex);
+					fields[4] = intField(size);
+					fields[5] = intField(referenceSize);
+
+					for(i = 0; i < result->firstCount; i++) {
+
+						fields[6 + i] = intField(result->first[i]);
+					}
+					writeFields(stream, 'd', fields, 6 + result->firstCount);
+					break;
+	}
+}
+
+/*
+ * Print the count, median, 99th and 99.9th percentile and largest latency of
+ * every option that has been run, and the elements they touched, in one of the
+ * output formats
+ * param stream: Where the statistics are printed
+ * param stats: The statistics
+ * param format: The format to print in
+ */
+void fprint_stats(FILE *stream, struct Stats *stats, enum Format format) {
+
+	/*Seven fields for each option that has a histogram*/
+	uint64_t fields[7*STATS_OPTIONS];
+	int n = 0;
+
+	switch(format) {
+
+		case FORMAT_TEXT:	fprintf(stream, "Statistics (%s):\n%-6s %10s %12s %12s %12s %12s %14s\n", STATS_UNIT, "option", "count", "p50", "p99", "p999", "max", "elements");
+					break;
+
+		case FORMAT_CSV:	fprintf(stream, "option,count,p50,p99,p999,max,elements\n");
+					break;
+
+		case FORMAT_JSON:	fprintf(stream, "{\"unit\":\"%s\",\"options\":[", STATS_UNIT);
+					break;
+
+		default:		break;
+	}
+
+	int i;
+	for(i = 0; i < STATS_OPTIONS; i++) {
+
+		struct Histogram *h = stats->options[i];
+
+		if(h == NULL) {
+
+			continue;
+		}
+
+		unsigned long p50 = statsPercentile(h, 0.5);
+		unsigned long p99 = statsPercentile(h, 0.99);
+		unsigned long p999 = statsPercentile(h, 0.999);
+		unsigned long max = h->max;
+		unsigned long elements = h->elements;
+
+		switch(format) {
+
+			case FORMAT_TEXT:	fprintf(stream, "%-6c %10ld %12lu %12lu %12lu %12lu %14lu\n", i, h->count, p50, p99, p999, max, elements);
+						break;
+
+			case FORMAT_CSV:	fprintf(stream, "%c,%ld,%lu,%lu,%lu,%lu,%lu\n", i, h->count, p50, p99, p999, max, elements);
+						break;
+
+			case FORMAT_JSON:	fprintf(stream, "%s{\"option\":\"%c\",\"count\":%ld,\"p50\":%lu,\"p99\":%lu,\"p999\":%lu,\"max\":%lu,\"elements\":%lu}", n > 0 ? "," : "", i, h->count, p50, p99, p999, max, elements);
+						break;
+
+			case FORMAT_BINARY:	fields[n] = intField(i);
+						fields[n + 1] = intField(h->count);
+						fields[n + 2] = p50;
+						fields[n + 3] = p99;
+						fields[n + 4] = p999;
+						fields[n + 5] = max;
+						fields[n + 6] = elements;
+						break;
+		}
+		n += 7;
+	}
+
+	if(format == FORMAT_JSON) {
+
+		fprintf(stream, "]}\n");
+	}
+	else if(format == FORMAT_BINARY) {
+
+		writeFields(stream, 'i', fields, n);
+	}
+}
+
+/*
+ * Looks up an output format by name
+ * param name: The name of the format; text, csv, json or binary
+ * return: The format, or -1 if there is no format with that name
+ */
+int formatByName(char *name) {
+
+	const char *names[] = {"text", "csv", "json", "binary"};
+
+	int i;
+	for(i = 0; i < 4; i++) {
+
+		if(strcmp(name, names[i]) == 0) {
+
+			return i;
+		}
+	}
+
+return -1;
+}
+
+/*
+ * Prints a help page for usage of vecalc
+ * param stream: Where the help page is printed
+ */
+void getHelp(FILE *stream) {
+
+	fprintf(stream, "Vecalc is a program that can perform operations on a vector (1 dimensional array)\n");
+	fprintf(stream, "Usage: <Option> [Value]\n");
+	fprintf(stream, "Options:\n");
+	fprintf(stream, "q : quit; Same functionality as e (end)\n");
+	fprintf(stream, "c : clear; Delete the current vector and start a new one\n");
+	fprintf(stream, "p : print; Output the contents of the vector to the console \n");
+	fprintf(stream, "h : help; Output the list of commands and the usage\n");
+	fprintf(stream, "m : magnitude; Output the magnitude to the console\n");
+	fprintf(stream, "r [option] [value] : repeat; repeat the last command given with a new set of commands. Repeat can not be preceeded by any other command\n");
+	fprintf(stream, "a <value> : append; extend the vector by one element and fill the element with the value \n");
+	fprintf(stream, "+ <value> : scalar plus;  add [value] to each element of the vector\n");
+	fprintf(stream, "- <value> : scalar minus; subtract [value] from each element of the vector\n");
+	fprintf(stream, "* <value> : scalar multiply; multiply [value] to each element of the vector\n");
+	fprintf(stream, "/ <value> : scalar divide; divide [value] from each element of the vector\n");
+	fprintf(stream, "b <n> : beginning; print the first n elements of the vector\n");
+	fprintf(stream, "t <n> : tail; print the last n elements of the vector\n");
+	fprintf(stream, "s <start> <end> : slice; print the elements from index start up to, but not including, end\n");
+	fprintf(stream, "k <n> : skip; print every n-th element of the vector, starting with the first\n");
+	fprintf(stream, "x [tolerance] : checksum; print a hash of the vector, or with a tolerance, a fingerprint that ignores differences much smaller than it\n");
+	fprintf(stream, "v <register> : save; save a copy of the vector in a register, 0 to 9\n");
+	fprintf(stream, "d <register> : diff; compare the vector against the one saved in a register\n");
+	fprintf(stream, "i : statistics; print how many times each option has run and how long it took\n");
+	fprintf(stream, "z <storage> : storage; keep the vector and saved registers as 0 float, 1 bf16, 2 fp16 or 3 lossless compressed blocks, and print the memory and precision\n");
+	fprintf(stream, "w : snapshot; write the vector, storage, format and last line to the snapshot file, which vecalc --restore carries on from\n");
+	fprintf(stream, "f <value> : format; print results as 0 text, 1 csv, 2 json or 3 binary from now on\n");
+	fprintf(stream, "e : end; terminate the vecalc program\n");
 }
@@ -0,0 +1,790 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPack.c						//
+ * Synopsis	:	Vectors stored in compressed blocks, as 16 bit floats	//
+ * 			or losslessly, to fit more of them in memory		//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*Local Headers*/
+#include "vectorPack.h"
+#include "vectorOps.h" /*For sweep()*/
+#include "vectorSparse.h" /*For densify()*/
+#include "vectorTune.h" /*For the SIMD threshold*/
+#include "vectorMem.h" /*For checkAlloc() and free_elements()*/
+
+/*
+ * Most bytes a block of STORAGE_XOR can take: the first element whole, then
+ * 2 control bits, 5 of leading zeros, 5 of length and 32 of XOR for each other
+ */
+#define PACK_XOR_WORST (4 + ((PACK_BLOCK - 1)*44 + 7)/8)
+
+/*A bit stream, written and read most significant bit first*/
+struct Bits {
+
+	unsigned char *data;
+	long length;		/*Bytes written, or read*/
+	long limit;		/*Bytes there are to read*/
+	uint64_t buffer;	/*Bits not yet written, or not yet read*/
+	int buffered;
+};
+
+/*
+ * The bits of an element
+ * param value: The element
+ * return: Its bits
+ */
+static uint32_t toBits(Elem value) {
+
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(Elem));
+
+return bits;
+}
+
+/*
+ * Makes an element from its bits
+ * param bits: The bits
+ * return: The element
+ */
+static Elem fromBits(uint32_t bits) {
+
+	Elem value;
+	memcpy(&value, &bits, sizeof(Elem));
+
+return value;
+}
+
+/*
+ * Rounds an element to bfloat16, to nearest with ties to even. NaN stays NaN
+ * param value: The element
+ * return: The top 16 bits of the rounded element
+ */
+static uint16_t toBf16(Elem value) {
+
+	uint32_t bits = toBits(value);
+
+	if((bits & 0x7FFFFFFF) > 0x7F800000) {
+
+		return bits >> 16 | 0x0040;
+	}
+
+return (bits + 0x7FFF + (bits >> 16 & 1)) >> 16;
+}
+
+/*
+ * An element from bfloat16
+ * param half: The top 16 bits of the element
+ * return: The element
+ */
+static Elem fromBf16(uint16_t half) {
+
+return fromBits((uint32_t)half << 16);
+}
+
+/*
+ * Rounds an element to IEEE half precision, to nearest with ties to even.
+ * Anything from 65520 up becomes infinity, and anything from 2^-25 down
+ * becomes 0. NaN stays NaN
+ * param value: The element
+ * return: The half
+ */
+static uint16_t toFp16(Elem value) {
+
+	uint32_t bits = toBits(value);
+	uint16_t sign = bits >> 16 & 0x8000;
+	uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	if(magnitude >= 0x7F800000) {
+
+		return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x0200 : 0);
+	}
+
+	if(magnitude >= 0x477FF000) {
+
+		return sign | 0x7C00;
+	}
+
+	/*Below 2^-14 the half is a denormal, in steps of 2^-24*/
+	if(magnitude < 0x38800000) {
+
+		if(magnitude <= 0x33000000) {
+
+			return sign;
+		}
+
+		int shift = 126 - (magnitude >> 23);
+		uint32_t mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+
+		if(rest > halfway || (rest == halfway && (half & 1))) {
+
+			half++;
+		}
+		return sign | half;
+	}
+
+	/*Take 15 from the exponent's bias, and keep 10 bits of the mantissa*/
+	uint32_t half = (magnitude >> 13) - ((uint32_t)(127 - 15) << 10);
+	uint32_t rest = magnitude & 0x1FFF;
+
+	if(rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+
+		half++;
+	}
+
+return sign | half;
+}
+
+/*
+ * An element from IEEE half precision
+ * param half: The half
+ * return: The element, which is exactly the half
+ */
+static Elem fromFp16(uint16_t half) {
+
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = half >> 10 & 0x1F;
+	uint32_t mantissa = half & 0x03FF;
+
+	if(exponent == 0x1F) {
+
+		return fromBits(sign | 0x7F800000 | mantissa << 13);
+	}
+
+	if(exponent == 0) {
+
+		if(mantissa == 0) {
+
+			return fromBits(sign);
+		}
+
+		/*A denormal half is a normal Elem*/
+		exponent = 127 - 14;
+
+		while(!(mantissa & 0x0400)) {
+
+			mantissa <<= 1;
+			exponent--;
+		}
+		return fromBits(sign | exponent << 23 | (mantissa & 0x03FF) << 13);
+	}
+
+return fromBits(sign | (exponent + 127 - 15) << 23 | mantissa << 13);
+}
+
+/*
+ * Rounds an element the way a storage keeps it
+ * param storage: The storage
+ * param value: The element
+ * return: The element as it is after being packed and unpacked
+ */
+Elem storage_round(enum Storage storage, Elem value) {
+
+	switch(storage) {
+
+		case STORAGE_BF16:	return fromBf16(toBf16(value));
+		case STORAGE_FP16:	return fromFp16(toFp16(value));
+		default:		return value;
+	}
+}
+
+/*
+ * Writes the low bits of a number to a bit stream
+ * param bits: The stream
+ * param value: The number
+ * param count: How many of its bits, at most 32
+ */
+static void putBits(struct Bits *bits, uint32_t value, int count) {
+
+	bits->buffer = bits->buffer << count | value;
+	bits->buffered += count;
+
+	while(bits->buffered >= 8) {
+
+		bits->buffered -= 8;
+		bits->data[bits->length++] = bits->buffer >> bits->buffered;
+	}
+}
+
+/*
+ * Reads bits from a bit stream. Past the end it reads 0
+ * param bits: The stream
+ * param count: How many bits, at most 32
+ * return: The bits, as the low bits of a number
+ */
+static uint32_t getBits(struct Bits *bits, int count) {
+
+	while(bits->buffered < count) {
+
+		bits->buffer = bits->buffer << 8 | (bits->length < bits->limit ? bits->data[bits->length] : 0);
+		bits->length++;
+		bits->buffered += 8;
+	}
+	bits->buffered -= count;
+
+return (bits->buffer >> bits->buffered) & (((uint64_t)1 << count) - 1);
+}
+
+/*
+ * Encodes elements losslessly, the way Gorilla encodes floats. Each element is
+ * XORed with the one before, which leaves few bits set when they are close. A
+ * 0 bit stands for the same element again. Otherwise the bits between the
+ * first and last set bit of the XOR are kept, after "10" if they fit between
+ * those of the XOR before, or after "11", 5 bits of leading zeros and 5 bits
+ * of their number less one.
+ * param values: The elements
+ * param count: The number of elements
+ * param data: Filled with the encoding, PACK_XOR_WORST bytes at most
+ * return: The length of the encoding
+ */
+static long encodeXor(Elem *values, int count, unsigned char *data) {
+
+	struct Bits bits = {NULL, 0, 0, 0, 0};
+	bits.data = data;
+
+	uint32_t previous = 0;
+	int leading = -1;
+	int trailing = 0;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		uint32_t current = toBits(values[i]);
+		uint32_t xor = current ^ previous;
+		previous = current;
+
+		if(i == 0) {
+
+			putBits(&bits, current, 32);
+			continue;
+		}
+
+		if(xor == 0) {
+
+			putBits(&bits, 0, 1);
+			continue;
+		}
+
+		int lead = 0;
+		int trail = 0;
+
+		while(!(xor & 0x80000000u >> lead)) {
+
+			lead++;
+		}
+
+		while(!(xor & 1u << trail)) {
+
+			trail++;
+		}
+
+		if(leading >= 0 && lead >= leading && trail >= trailing) {
+
+			putBits(&bits, 2, 2);
+			putBits(&bits, xor >> trailing, 32 - leading - trailing);
+		}
+		else {
+
+			putBits(&bits, 3, 2);
+			putBits(&bits, lead, 5);
+			putBits(&bits, 32 - lead - trail - 1, 5);
+			putBits(&bits, xor >> trail, 32 - lead - trail);
+			leading = lead;
+			trailing = trail;
+		}
+	}
+
+	/*The last bits, padded with 0 to a whole byte*/
+	if(bits.buffered > 0) {
+
+		putBits(&bits, 0, 8 - bits.buffered);
+	}
+
+return bits.length;
+}
+
+/*
+ * Decodes elements encoded by encodeXor()
+ * param data: The encoding
+ * param length: Its length
+ * param count: The number of elements
+ * param values: Filled with the elements
+ */
+static void decodeXor(unsigned char *data, long length, int count, Elem *values) {
+
+	struct Bits bits = {NULL, 0, 0, 0, 0};
+	bits.data = data;
+	bits.limit = length;
+
+	uint32_t previous = 0;
+	int leading = 0;
+	int trailing = 0;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		if(i == 0) {
+
+			previous = getBits(&bits, 32);
+		}
+		else if(getBits(&bits, 1) == 1) {
+
+			if(getBits(&bits, 1) == 1) {
+
+				leading = getBits(&bits, 5);
+				trailing = 32 - leading - (getBits(&bits, 5) + 1);
+			}
+			previous ^= getBits(&bits, 32 - leading - trailing) << trailing;
+		}
+		values[i] = fromBits(previous);
+	}
+}
+
+/*
+ * Encodes a block
+ * param storage: The storage
+ * param values: The elements of the block
+ * param count: The number of elements
+ * param bytes: Set to the length of the block
+ * return: The block
+ */
+static unsigned char *encodeBlock(enum Storage storage, Elem *values, int count, int *bytes) {
+
+	unsigned char *block;
+
+	if(storage == STORAGE_XOR) {
+
+		unsigned char scratch[PACK_XOR_WORST];
+		*bytes = encodeXor(values, count, scratch);
+		block = malloc(*bytes > 0 ? *bytes : 1);
+		checkAlloc(block);
+		memcpy(block, scratch, *bytes);
+
+		return block;
+	}
+
+	*bytes = count*sizeof(uint16_t);
+	block = malloc(*bytes > 0 ? *bytes : 1);
+	checkAlloc(block);
+
+	uint16_t half;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		half = storage == STORAGE_BF16 ? toBf16(values[i]) : toFp16(values[i]);
+		memcpy(block + i*sizeof(uint16_t), &half, sizeof(uint16_t));
+	}
+
+return block;
+}
+
+/*
+ * Decodes a block
+ * param storage: The storage
+ * param block: The block
+ * param bytes: The length of the block
+ * param count: The number of elements in it
+ * param values: Filled with the elements
+ */
+static void decodeBlock(enum Storage storage, unsigned char *block, int bytes, int count, Elem *values) {
+
+	if(storage == STORAGE_XOR) {
+
+		decodeXor(block, bytes, count, values);
+		return;
+	}
+
+	uint16_t half;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		memcpy(&half, block + i*sizeof(uint16_t), sizeof(uint16_t));
+		values[i] = storage == STORAGE_BF16 ? fromBf16(half) : fromFp16(half);
+	}
+}
+
+/*
+ * The number of elements in a block of a vector
+ * param vector: The vector
+ * param block: The block
+ * return: PACK_BLOCK, or fewer for the last block
+ */
+static int blockSize(struct Vector *vector, int block) {
+
+	long left = vector->size - (long)block*PACK_BLOCK;
+
+return left < PACK_BLOCK ? left : PACK_BLOCK;
+}
+
+/*
+ * Makes room for more blocks
+ * param packed: The blocks
+ * param count: Blocks there will be
+ */
+static void reserve(struct Packed *packed, int count) {
+
+	if(count <= packed->capacity) {
+
+		return;
+	}
+
+	int capacity = packed->capacity*2 > count ? packed->capacity*2 : count;
+
+	packed->blocks = realloc(packed->blocks, capacity*sizeof(unsigned char *));
+	packed->bytes = realloc(packed->bytes, capacity*sizeof(int));
+	checkAlloc(packed->blocks);
+	checkAlloc(packed->bytes);
+	packed->capacity = capacity;
+}
+
+/*
+ * Encodes a block of a vector again, after its elements changed
+ * param packed: The blocks
+ * param block: The block
+ * param values: The elements of the block
+ * param count: The number of elements
+ */
+static void replaceBlock(struct Packed *packed, int block, Elem *values, int count) {
+
+	/*Fixed width blocks are the same length, so they're written over*/
+	if(packed->storage != STORAGE_XOR && packed->bytes[block] == (int)(count*sizeof(uint16_t))) {
+
+		int bytes;
+		unsigned char *encoded = encodeBlock(packed->storage, values, count, &bytes);
+		memcpy(packed->blocks[block], encoded, bytes);
+		free(encoded);
+		return;
+	}
+	free(packed->blocks[block]);
+	packed->blocks[block] = encodeBlock(packed->storage, values, count, &packed->bytes[block]);
+}
+
+/*
+ * Works out what packing a vector cost and saved
+ * param vector: The vector, packed
+ * param storage: The storage
+ * param original: Its elements before they were packed, or null if nothing
+ * was lost
+ * param report: Filled with the report
+ */
+static void fillReport(struct Vector *vector, enum Storage storage, Elem *original, struct PackReport *report) {
+
+	memset(report, 0, sizeof(struct PackReport));
+	report->storage = storage;
+	report->elements = vector->size;
+
+	switch(storage) {
+
+		case STORAGE_BF16:	report->bits = 8; break;
+		case STORAGE_FP16:	report->bits = 11; break;
+		default:		report->bits = 24; break;
+	}
+
+	if(vector->packed == NULL) {
+
+		report->bytes = vector->size*sizeof(Elem);
+	}
+	else {
+
+		report->bytes = vector->packed->count*(sizeof(unsigned char *) + sizeof(int));
+
+		int b;
+		for(b = 0; b < vector->packed->count; b++) {
+
+			report->bytes += vector->packed->bytes[b];
+		}
+	}
+
+	if(original == NULL) {
+
+		return;
+	}
+
+	long i;
+	for(i = 0; i < vector->size; i++) {
+
+		double before = original[i];
+		double after = storage_round(storage, original[i]);
+
+		/*NaN and infinities are kept as they are*/
+		if(before - before != 0) {
+
+			continue;
+		}
+
+		if(after - after != 0) {
+
+			report->overflows++;
+		}
+		else if(after == 0 && before != 0) {
+
+			report->underflows++;
+		}
+		else if(before != 0) {
+
+			double error = (after - before)/before;
+			error = error < 0 ? -error : error;
+
+			if(error > report->maxError) {
+
+				report->maxError = error;
+			}
+		}
+	}
+}
+
+/*
+ * Stores a vector in a storage, from whatever form it is in now
+ * param vector: The vector
+ * param storage: The storage
+ * param report: Filled with what it cost and saved. Can be null
+ */
+void pack_vec(struct Vector *vector, enum Storage storage, struct PackReport *report) {
+
+	bool lossy = storage == STORAGE_BF16 || storage == STORAGE_FP16;
+
+	/*Already stored that way, so nothing more is lost*/
+	if(vector->packed != NULL && vector->packed->storage == storage) {
+
+		if(report != NULL) {
+
+			fillReport(vector, storage, NULL, report);
+		}
+		return;
+	}
+
+	unpack_vec(vector);
+	densify(vector);
+
+	if(storage == STORAGE_FLOAT) {
+
+		if(report != NULL) {
+
+			fillReport(vector, storage, NULL, report);
+		}
+		return;
+	}
+
+	struct Packed *packed = calloc(1, sizeof(struct Packed));
+	checkAlloc(packed);
+	packed->storage = storage;
+	vector->packed = packed;
+	reserve(packed, (vector->size + PACK_BLOCK - 1)/PACK_BLOCK);
+
+	int b;
+	for(b = 0; (long)b*PACK_BLOCK < vector->size; b++) {
+
+		packed->blocks[b] = encodeBlock(storage, vector->elements + (long)b*PACK_BLOCK, blockSize(vector, b), &packed->bytes[b]);
+		packed->count++;
+	}
+
+	if(report != NULL) {
+
+		fillReport(vector, storage, lossy ? vector->elements : NULL, report);
+	}
+	free_elements(vector->elements);
+	vector->elements = NULL;
+}
+
+/*
+ * Makes a packed vector dense. A vector that isn't packed is left alone
+ * param vector: The vector
+ */
+void unpack_vec(struct Vector *vector) {
+
+	if(vector->packed == NULL) {
+
+		return;
+	}
+
+	vector->elements = malloc((vector->size > 0 ? vector->size : 1)*sizeof(Elem));
+	checkAlloc(vector->elements);
+	packed_fill(vector, 0, vector->size, vector->elements);
+
+	packed_free(vector->packed);
+	vector->packed = NULL;
+}
+
+/*
+ * Writes out the elements of a packed vector from first up to last. Only the
+ * blocks that hold them are decoded
+ * param vector: The packed vector
+ * param first: Index of the first element
+ * param last: Index one past the last element
+ * param elements: Filled with the elements, the first one at index 0
+ */
+void packed_fill(struct Vector *vector, int first, int last, Elem *elements) {
+
+	struct Packed *packed = vector->packed;
+
+	/*Blocks only partly in range are decoded here and the part is copied*/
+	Elem decoded[PACK_BLOCK];
+
+	int b;
+	for(b = first/PACK_BLOCK; first < last && (long)b*PACK_BLOCK < last; b++) {
+
+		int start = b*PACK_BLOCK;
+		int count = blockSize(vector, b);
+		int from = start > first ? start : first;
+		int to = start + count < last ? start + count : last;
+
+		if(from == start && to == start + count) {
+
+			decodeBlock(packed->storage, packed->blocks[b], packed->bytes[b], count, elements + (start - first));
+		}
+		else {
+
+			decodeBlock(packed->storage, packed->blocks[b], packed->bytes[b], count, decoded);
+			memcpy(elements + (from - first), decoded + (from - start), (to - from)*sizeof(Elem));
+		}
+	}
+}
+
+/*
+ * Applies an operation to a packed vector. Each block is decoded, swept with
+ * the same loops as a dense vector and encoded again, so only one block is
+ * ever dense. Blocks are too small to be worth threads.
+ * param vector: The packed vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+void packed_sweep(struct Vector *vector, char option, Elem value) {
+
+	struct Packed *packed = vector->packed;
+	Elem elements[PACK_BLOCK];
+
+	struct Vector block;
+	block.elements = elements;
+	block.sparse = NULL;
+	block.packed = NULL;
+
+	int b;
+	for(b = 0; b < packed->count; b++) {
+
+		block.size = blockSize(vector, b);
+		decodeBlock(packed->storage, packed->blocks[b], packed->bytes[b], block.size, elements);
+		sweep(&block, option, value, tuning.simdMin != TUNE_NEVER && block.size >= tuning.simdMin ? PATH_SIMD : PATH_SCALAR);
+		replaceBlock(packed, b, elements, block.size);
+	}
+}
+
+/*
+ * Sums a packed vector in order
+ * param vector: The packed vector
+ * return: The sum
+ */
+Elem packed_magnitude(struct Vector *vector) {
+
+	struct Packed *packed = vector->packed;
+	Elem elements[PACK_BLOCK];
+	Elem magnitude = 0;
+
+	int b;
+	for(b = 0; b < packed->count; b++) {
+
+		int count = blockSize(vector, b);
+		decodeBlock(packed->storage, packed->blocks[b], packed->bytes[b], count, elements);
+
+		int i;
+		for(i = 0; i < count; i++) {
+
+			magnitude += elements[i];
+		}
+	}
+
+return magnitude;
+}
+
+/*
+ * Appends elements to a packed vector. A last block that isn't full is decoded
+ * and encoded again with the new elements.
+ * param vector: The packed vector
+ * param values: The values
+ * param count: The number of values
+ */
+void packed_append(struct Vector *vector, Elem *values, int count) {
+
+	struct Packed *packed = vector->packed;
+	Elem elements[PACK_BLOCK];
+
+	while(count > 0) {
+
+		int used = vector->size%PACK_BLOCK;
+		int adding = PACK_BLOCK - used < count ? PACK_BLOCK - used : count;
+
+		if(used > 0) {
+
+			int last = packed->count - 1;
+			decodeBlock(packed->storage, packed->blocks[last], packed->bytes[last], used, elements);
+			memcpy(elements + used, values, adding*sizeof(Elem));
+			replaceBlock(packed, last, elements, used + adding);
+		}
+		else {
+
+			reserve(packed, packed->count + 1);
+			packed->blocks[packed->count] = encodeBlock(packed->storage, values, adding, &packed->bytes[packed->count]);
+			packed->count++;
+		}
+		vector->size += adding;
+		values += adding;
+		count -= adding;
+	}
+}
+
+/*
+ * Copies the blocks of a packed vector
+ * param vector: The packed vector
+ * return: A copy of its blocks
+ */
+struct Packed *packed_copy(struct Vector *vector) {
+
+	struct Packed *copy = calloc(1, sizeof(struct Packed));
+	checkAlloc(copy);
+	copy->storage = vector->packed->storage;
+	reserve(copy, vector->packed->count);
+
+	int b;
+	for(b = 0; b < vector->packed->count; b++) {
+
+		copy->bytes[b] = vector->packed->bytes[b];
+		copy->blocks[b] = malloc(copy->bytes[b] > 0 ? copy->bytes[b] : 1);
+		checkAlloc(copy->blocks[b]);
+		memcpy(copy->blocks[b], vector->packed->blocks[b], copy->bytes[b]);
+	}
+	copy->count = vector->packed->count;
+
+return copy;
+}
+
+/*
+ * Frees the blocks of a packed vector
+ * param packed: The blocks. Null is ignored
+ */
+void packed_free(struct Packed *packed) {
+
+	if(packed == NULL) {
+
+		return;
+	}
+
+	int b;
+	for(b = 0; b < packed->count; b++) {
+
+		free(packed->blocks[b]);
+	}
+	free(packed->blocks);
+	free(packed->bytes);
+	free(packed);
+}
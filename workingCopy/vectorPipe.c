@@ -0,0 +1,316 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPipe.c						//
+ * Synopsis	:	Pipelined input. A reader thread parses lines into a	//
+ * 			ring of commands while the main thread runs them	//
+ *==============================================================================//
+ */
+
+/*For fileno() and semaphores*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h> /*For isatty()*/
+#include <pthread.h>
+#include <semaphore.h>
+
+/*Local Headers*/
+#include "vectorPipe.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorSnap.h" /*For snapshot_due()*/
+
+/*
+ * A command in the ring. The first command of a line carries what parsing the
+ * line printed, which is printed by the main thread just before the command
+ * runs, so it comes out in the same place as it does without the pipeline.
+ */
+struct Slot {
+
+	/*The command. Its option is 0 for a line with nothing to run, or at the end*/
+	struct Command cmd;
+	bool end;
+	/*Diagnostics held back while the line was parsed*/
+	struct DiagEvent *events;
+	int eventCount;
+	/*What the optimizer eliminated from the line, or null*/
+	char *report;
+};
+
+/*
+ * A single producer, single consumer ring of parsed commands. head is only
+ * touched by the reader and tail only by the main thread. The semaphores
+ * count the free and filled slots, which is what makes the reader wait when
+ * the ring is full and the main thread wait when it is empty.
+ */
+struct Pipeline {
+
+	struct Slot ring[PIPE_RING_SIZE];
+	unsigned int head;
+	unsigned int tail;
+	sem_t free;
+	sem_t filled;
+
+	/*
+	 * Lines are parsed against a session of the reader's own, so the main
+	 * thread's session is never touched by it
+	 */
+	struct Session parser;
+	FILE *in;
+	char *initial;
+	struct Flags *flags;
+};
+
+/*
+ * Places a command in the ring, waiting for a free slot if it is full
+ * param pipe: The pipeline
+ * param slot: The command to place in the ring
+ */
+static void push(struct Pipeline *pipe, struct Slot *slot) {
+
+	sem_wait(&pipe->free);
+	pipe->ring[pipe->head % PIPE_RING_SIZE] = *slot;
+	pipe->head++;
+	sem_post(&pipe->filled);
+}
+
+/*
+ * Takes the next command out of the ring, waiting for one if it is empty
+ * param pipe: The pipeline
+ * param slot: Filled with the next command
+ */
+static void pop(struct Pipeline *pipe, struct Slot *slot) {
+
+	sem_wait(&pipe->filled);
+	*slot = pipe->ring[pipe->tail % PIPE_RING_SIZE];
+	pipe->tail++;
+	sem_post(&pipe->free);
+}
+
+/*
+ * Parses a line and places its commands in the ring
+ * param pipe: The pipeline
+ * param line: The line of input
+ * return: false if there is no more input to read after this line
+ */
+static bool pushLine(struct Pipeline *pipe, char *line) {
+
+	struct Slot slot;
+	memset(&slot, 0, sizeof(struct Slot));
+
+	FILE *report = NULL;
+	size_t reportLength;
+
+	if(pipe->flags->showOptimized) {
+
+		report = open_memstream(&slot.report, &reportLength);
+		checkAlloc(report);
+	}
+
+	struct Command *cmds;
+	int numCmds = parseLine(&pipe->parser, line, pipe->flags->optimize, report, &cmds);
+
+	if(report != NULL) {
+
+		fclose(report);
+	}
+	slot.eventCount = take_held(&pipe->parser.diag, &slot.events);
+
+	/*Blank lines are only the end of the input when it isn't a terminal*/
+	if(numCmds < 0) {
+
+		free(slot.report);
+		return isatty(fileno(pipe->in)) == 1;
+	}
+
+	/*A line with nothing to run still has to have what it printed printed*/
+	if(numCmds == 0 && (slot.eventCount > 0 || slot.report != NULL)) {
+
+		slot.cmd.line = pipe->parser.line;
+		push(pipe, &slot);
+	}
+
+	int i;
+	for(i = 0; i < numCmds; i++) {
+
+		slot.cmd = cmds[i];
+		push(pipe, &slot);
+
+		/*Only the first command carries them*/
+		slot.events = NULL;
+		slot.eventCount = 0;
+		slot.report = NULL;
+	}
+
+	/*parseLine() stops at a q or e, so it can only be the last command*/
+	bool more = numCmds == 0 || (cmds[numCmds - 1].option != 'q' && cmds[numCmds - 1].option != 'e');
+	free(cmds);
+
+return more;
+}
+
+/*
+ * Reader thread. Parses the initial options and then every line of input,
+ * ending the ring with a slot marked as the end.
+ * param arg: The pipeline
+ * return: NULL
+ */
+static void *reader(void *arg) {
+
+	struct Pipeline *pipe = arg;
+	char line[MAX_INPUT_LENGTH];
+	bool more = true;
+
+	if(pipe->initial != NULL) {
+
+		/*
+		 * The initial options are on the line the session is on, and
+		 * the first line read after them, as they are without the
+		 * pipeline. parseLine() moves on a line, so it is moved back.
+		 */
+		pipe->parser.line--;
+		more = pushLine(pipe, pipe->initial);
+	}
+
+	while(more && fgets(line, MAX_INPUT_LENGTH, pipe->in) != NULL) {
+
+		more = pushLine(pipe, line);
+	}
+
+	/*
+	 * If a q or e was the last command, the main thread stops before it
+	 * gets here, but the q or e has freed a slot for this.
+	 */
+	struct Slot end;
+	memset(&end, 0, sizeof(struct Slot));
+	end.end = true;
+	push(pipe, &end);
+
+return NULL;
+}
+
+/*
+ * Reads lines from a stream on a separate thread and runs them against a
+ * session as they are parsed
+ * param session: The session to run the commands against
+ * param in: The stream to read lines from
+ * param argv: The options vecalc was run with, which are run first
+ * param argc: The number of options vecalc was run with, including argv[0]
+ * param flags: Settings that apply to running the commands
+ * return: EXIT_SUCCESS, or EXIT_FAILURE if the reader couldn't be started
+ */
+int pipelineIn(struct Session *session, FILE *in, char *argv[], int argc, struct Flags *flags) {
+
+	struct Pipeline *pipe = malloc(sizeof(struct Pipeline));
+	checkAlloc(pipe);
+
+	pipe->head = 0;
+	pipe->tail = 0;
+	sem_init(&pipe->free, 0, PIPE_RING_SIZE);
+	sem_init(&pipe->filled, 0, 0);
+	pipe->in = in;
+	pipe->flags = flags;
+	pipe->initial = NULL;
+
+	/*
+	 * Parsing only needs the line, the last line for r, and somewhere to
+	 * hold diagnostics. Everything else about the parser stays empty.
+	 */
+	memset(&pipe->parser, 0, sizeof(struct Session));
+	pipe->parser.out = session->out;
+	pipe->parser.err = session->err;
+	pipe->parser.line = session->line;
+	init_diag(&pipe->parser.diag);
+	pipe->parser.diag.hold = true;
+
+	if(session->lastLine != NULL) {
+
+		pipe->parser.lastLine = malloc(strlen(session->lastLine) + 1);
+		checkAlloc(pipe->parser.lastLine);
+		strcpy(pipe->parser.lastLine, session->lastLine);
+	}
+
+	/*The initial options are run as if they were the first line*/
+	if(argc > 1) {
+
+		size_t length = 0;
+
+		int i;
+		for(i = 1; i < argc; i++) {
+
+			length += strlen(argv[i]) + 1;
+		}
+		pipe->initial = calloc(length + 1, sizeof(char));
+		checkAlloc(pipe->initial);
+
+		for(i = 1; i < argc; i++) {
+
+			strcat(pipe->initial, argv[i]);
+			strcat(pipe->initial, " ");
+		}
+	}
+
+	/*The reader is lines ahead, so the last line it parsed isn't the one running*/
+	session->lastLineShared = true;
+
+	pthread_t thread;
+	int error = pthread_create(&thread, NULL, reader, pipe);
+
+	if(error != 0) {
+
+		fprintf(session->err, "Could not start the pipeline: %s\n", strerror(error));
+	}
+
+	/*
+	 * The session's vector is only ever touched by this thread. Commands go
+	 * through runCommands() one at a time, so they are timed and probed as
+	 * they are without the pipeline
+	 */
+	struct Slot slot;
+	long ran = session->line;
+	bool running = error == 0;
+
+	while(running) {
+
+		pop(pipe, &slot);
+
+		/*A line has finished once a command from another, or the end, comes out*/
+		if(slot.cmd.line != ran || slot.end) {
+
+			snapshot_due(session, ran);
+			ran = slot.cmd.line;
+		}
+		replay_diag(&session->diag, slot.events, slot.eventCount);
+
+		if(slot.report != NULL) {
+
+			fputs(slot.report, stderr);
+			free(slot.report);
+		}
+		running = !slot.end && (slot.cmd.option == 0 || runCommands(session, &slot.cmd, 1));
+	}
+
+	if(error == 0) {
+
+		/*The reader stops at the same command that stopped the commands here*/
+		pthread_join(thread, NULL);
+	}
+	session->lastLineShared = false;
+
+	/*The session carries on from the last line parsed, as it does without the pipeline*/
+	session->line = pipe->parser.line;
+	free(session->lastLine);
+	session->lastLine = pipe->parser.lastLine;
+	free_diag(&pipe->parser.diag);
+
+	sem_destroy(&pipe->free);
+	sem_destroy(&pipe->filled);
+	free(pipe->initial);
+	free(pipe);
+
+return error == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
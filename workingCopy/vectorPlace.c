@@ -0,0 +1,363 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorPlace.c						//
+ * Synopsis	:	Which NUMA node the elements of large vectors are put	//
+ * 			on, and which CPUs the threads that sweep them run on	//
+ *==============================================================================//
+ */
+
+/*For pthread_attr_setaffinity_np(), sched_getaffinity() and syscall()*/
+#define _GNU_SOURCE
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <malloc.h> /*For mallopt()*/
+#include <sys/syscall.h> /*For SYS_mbind*/
+
+/*Local Headers*/
+#include "vectorPlace.h"
+#include "vectorTune.h" /*For the placement and the thread threshold*/
+
+/*
+ * Buffers smaller than this are left where they are put: they are a few pages
+ * at most, and are swept on one thread
+ */
+#define PLACE_MIN_BYTES 65536
+
+/*The policy of mbind() that spreads pages over nodes, from <linux/mempolicy.h>*/
+#define PLACE_MPOL_INTERLEAVE 3
+#define PLACE_MPOL_MF_MOVE 2
+
+/*A range of a buffer copied by one thread*/
+struct CopyPart {
+
+	Elem *to;
+	Elem *from;
+	long count;
+	pthread_t thread;
+	bool threaded;
+};
+
+static struct Topology host;
+static pthread_once_t hostOnce = PTHREAD_ONCE_INIT;
+static pthread_once_t freshOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * Reads a list of CPUs, such as 0-3,8,10-11, and adds those this process can
+ * run on to the topology
+ * param list: The list
+ * param node: The node they are on
+ * param allowed: The CPUs this process can run on
+ */
+static void addCpus(char *list, int node, cpu_set_t *allowed) {
+
+	char *next = list;
+
+	while(*next != '\0' && *next != '\n') {
+
+		char *end;
+		long first = strtol(next, &end, 10);
+		long last = first;
+
+		if(end == next) {
+
+			return;
+		}
+
+		if(*end == '-') {
+
+			next = end + 1;
+			last = strtol(next, &end, 10);
+		}
+
+		long cpu;
+		for(cpu = first; cpu <= last && host.cpuCount < PLACE_MAX_CPUS; cpu++) {
+
+			if(cpu < CPU_SETSIZE && CPU_ISSET(cpu, allowed)) {
+
+				host.cpus[host.cpuCount] = cpu;
+				host.nodeOf[host.cpuCount++] = node;
+			}
+		}
+		next = *end == ',' ? end + 1 : end;
+	}
+}
+
+/*
+ * Reads the nodes from sysfs, and the CPUs on each that this process can run
+ * on. Nodes without any of those CPUs are still nodes that memory can be put
+ * on. Without sysfs the host is one node.
+ */
+static void readTopology(void) {
+
+	cpu_set_t allowed;
+
+	if(sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) {
+
+		CPU_ZERO(&allowed);
+		CPU_SET(0, &allowed);
+	}
+
+	int node;
+	for(node = 0; node < PLACE_MAX_NODES; node++) {
+
+		char path[64];
+		char list[4096];
+		sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+
+		FILE *file = fopen(path, "r");
+
+		if(file == NULL) {
+
+			continue;
+		}
+
+		if(fgets(list, sizeof(list), file) != NULL) {
+
+			addCpus(list, node, &allowed);
+		}
+		fclose(file);
+		host.nodeIds[host.nodes++] = node;
+	}
+
+	if(host.cpuCount == 0) {
+
+		host.nodes = 1;
+		host.nodeIds[0] = 0;
+
+		int cpu;
+		for(cpu = 0; cpu < CPU_SETSIZE && host.cpuCount < PLACE_MAX_CPUS; cpu++) {
+
+			if(CPU_ISSET(cpu, &allowed)) {
+
+				host.cpus[host.cpuCount] = cpu;
+				host.nodeOf[host.cpuCount++] = 0;
+			}
+		}
+	}
+}
+
+/*
+ * The topology of the host, which is read the first time it is asked for
+ * return: The topology
+ */
+const struct Topology *topology(void) {
+
+	pthread_once(&hostOnce, readTopology);
+
+return &host;
+}
+
+/*
+ * Looks up a placement by name
+ * param name: local, interleave or chunk
+ * return: The placement, or -1 if there isn't one by that name
+ */
+int placementByName(const char *name) {
+
+	int i;
+	for(i = PLACE_LOCAL; i <= PLACE_CHUNK; i++) {
+
+		if(strcmp(name, placementName(i)) == 0) {
+
+			return i;
+		}
+	}
+
+return -1;
+}
+
+/*
+ * The name of a placement
+ * param placement: The placement
+ * return: local, interleave or chunk
+ */
+const char *placementName(enum Placement placement) {
+
+	const char *names[] = {"local", "interleave", "chunk"};
+
+return names[placement];
+}
+
+/*
+ * The number of parts a threaded sweep is split into
+ * return: The number of parts
+ */
+int place_parts(void) {
+
+	int parts = tuning.threads > 1 ? tuning.threads : 2;
+
+return parts < TUNE_MAX_THREADS ? parts : TUNE_MAX_THREADS;
+}
+
+/*
+ * Starts a thread for one part of some work, pinned unless the placement is
+ * local. Part t of n goes to the CPU t/n of the way through the list of CPUs,
+ * which keeps neighbouring parts, and the memory they first touch, on a node.
+ * param thread: Filled with the thread
+ * param run: What the thread runs
+ * param arg: The argument it is given
+ * param part: The part
+ * param parts: The number of parts
+ * return: 0, or the error from pthread_create()
+ */
+int place_thread(pthread_t *thread, void *(*run)(void *), void *arg, int part, int parts) {
+
+	if(tuning.placement == PLACE_LOCAL) {
+
+		return pthread_create(thread, NULL, run, arg);
+	}
+
+	const struct Topology *cpus = topology();
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpus->cpus[(long)part*cpus->cpuCount/parts], &set);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &set);
+
+	int error = pthread_create(thread, &attr, run, arg);
+	pthread_attr_destroy(&attr);
+
+	/*A thread that can't be pinned still does its part*/
+	if(error == EINVAL) {
+
+		error = pthread_create(thread, NULL, run, arg);
+	}
+
+return error;
+}
+
+/*
+ * Makes malloc() map fresh pages for every large buffer. Otherwise it reuses
+ * pages freed from the heap, which were put on a node by whoever touched them
+ * first, and first touch decides nothing.
+ */
+static void freshPages(void) {
+
+	#ifdef M_MMAP_THRESHOLD
+
+	mallopt(M_MMAP_THRESHOLD, PLACE_MIN_BYTES);
+
+	#endif
+}
+
+/*
+ * Spreads the whole pages of a buffer over every node, moving any that are
+ * already on one
+ * param buffer: The buffer
+ * param bytes: Its length
+ */
+static void interleave(void *buffer, long bytes) {
+
+	#ifdef SYS_mbind
+
+	long page = sysconf(_SC_PAGESIZE);
+	unsigned long first = ((unsigned long)buffer + page - 1)/page*page;
+	unsigned long last = ((unsigned long)buffer + bytes)/page*page;
+	unsigned long mask[PLACE_MAX_NODES/(8*sizeof(unsigned long)) + 1];
+	memset(mask, 0, sizeof(mask));
+
+	const struct Topology *nodes = topology();
+
+	int n;
+	for(n = 0; n < nodes->nodes; n++) {
+
+		mask[nodes->nodeIds[n]/(8*sizeof(unsigned long))] |= 1UL << nodes->nodeIds[n]%(8*sizeof(unsigned long));
+	}
+
+	if(nodes->nodes > 1 && last > first) {
+
+		syscall(SYS_mbind, first, last - first, PLACE_MPOL_INTERLEAVE, mask, PLACE_MAX_NODES + 1, PLACE_MPOL_MF_MOVE);
+	}
+
+	#else
+
+	(void)buffer;
+	(void)bytes;
+
+	#endif
+}
+
+/*
+ * Copies one part of a buffer
+ * param arg: The CopyPart
+ * return: NULL
+ */
+static void *copyPart(void *arg) {
+
+	struct CopyPart *part = arg;
+	memcpy(part->to, part->from, part->count*sizeof(Elem));
+
+return NULL;
+}
+
+/*
+ * Copies elements into a new buffer, putting its pages where the placement
+ * says. With chunk, a buffer large enough for the sweeps to split over threads
+ * is copied in the parts threadLoop() splits it into, on the CPUs it runs them
+ * on, so each part's pages are first touched on the node that sweeps them.
+ * param to: The new buffer
+ * param from: The elements copied into it
+ * param count: The number of elements
+ */
+void place_copy(Elem *to, Elem *from, long count) {
+
+	bool large = count*(long)sizeof(Elem) >= PLACE_MIN_BYTES;
+
+	if(tuning.placement == PLACE_LOCAL || !large) {
+
+		memcpy(to, from, count*sizeof(Elem));
+		return;
+	}
+	pthread_once(&freshOnce, freshPages);
+
+	bool threaded = tuning.threadMin != TUNE_NEVER && count >= tuning.threadMin;
+
+	if(tuning.placement == PLACE_INTERLEAVE || !threaded) {
+
+		if(tuning.placement == PLACE_INTERLEAVE) {
+
+			interleave(to, count*sizeof(Elem));
+		}
+		memcpy(to, from, count*sizeof(Elem));
+		return;
+	}
+
+	struct CopyPart parts[TUNE_MAX_THREADS];
+	int n = place_parts();
+
+	int t;
+	for(t = 0; t < n; t++) {
+
+		long first = count*t/n;
+		long last = count*(t + 1)/n;
+
+		parts[t].to = to + first;
+		parts[t].from = from + first;
+		parts[t].count = last - first;
+		parts[t].threaded = place_thread(&parts[t].thread, copyPart, &parts[t], t, n) == 0;
+
+		if(!parts[t].threaded) {
+
+			copyPart(&parts[t]);
+		}
+	}
+
+	for(t = 0; t < n; t++) {
+
+		if(parts[t].threaded) {
+
+			pthread_join(parts[t].thread, NULL);
+		}
+	}
+}
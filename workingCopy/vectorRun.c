@@ -0,0 +1,353 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorRun.c						//
+ * Synopsis	:	Runs many independent scripts on a work stealing pool	//
+ * 			of threads and prints their output in order		//
+ *==============================================================================//
+ */
+
+/*For open_memstream()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+/*Local Headers*/
+#include "vectorRun.h"
+#include "vectorCmd.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorPlace.h" /*For pinning the workers*/
+
+/*A script and the output it produced*/
+struct Script {
+
+	char *path;
+	char *out;
+	size_t outLength;
+	char *err;
+	size_t errLength;
+	bool opened;
+	bool done;
+};
+
+/*
+ * The scripts a worker has left to run, as the range [first, last). The
+ * worker takes scripts from the front of its own range, and a worker that has
+ * run out steals the back half of someone else's.
+ */
+struct Queue {
+
+	int first;
+	int last;
+	pthread_mutex_t lock;
+};
+
+/*Everything shared between the workers and the thread printing the output*/
+struct Pool {
+
+	struct Script *scripts;
+	struct Queue *queues;
+	int workers;
+	struct Flags *flags;
+	pthread_mutex_t doneLock;
+	pthread_cond_t doneReady;
+};
+
+/*A worker's view of the pool*/
+struct Worker {
+
+	struct Pool *pool;
+	int id;
+	pthread_t thread;
+	bool started;
+};
+
+/*
+ * Runs a script into its own output buffers
+ * param script: The script to run
+ * param flags: Settings that apply to every script
+ */
+static void runScript(struct Script *script, struct Flags *flags) {
+
+	struct Session session;
+	FILE *out = open_memstream(&script->out, &script->outLength);
+	FILE *err = open_memstream(&script->err, &script->errLength);
+	checkAlloc(out);
+	checkAlloc(err);
+
+	FILE *in = fopen(script->path, "r");
+	script->opened = in != NULL;
+
+	if(in == NULL) {
+
+		fprintf(err, "Could not open script: %s\n", script->path);
+	}
+	else {
+
+		init_session(&session, out, err);
+		configure_session(&session, flags);
+
+		/*The same as running vecalc with the script redirected into it*/
+		char line[MAX_INPUT_LENGTH];
+		bool running = true;
+
+		while(running && fgets(line, MAX_INPUT_LENGTH, in) != NULL) {
+
+			running = runLine(&session, line, flags->optimize, flags->showOptimized ? err : NULL);
+		}
+
+		free_session(&session);
+		fclose(in);
+	}
+	fclose(out);
+	fclose(err);
+}
+
+/*
+ * Takes the next script for a worker to run, stealing one if it has none
+ * param pool: The pool of workers
+ * param id: The worker
+ * return: The index of the script, or -1 if there are none left anywhere
+ */
+static int take(struct Pool *pool, int id) {
+
+	struct Queue *own = &pool->queues[id];
+	int next = -1;
+
+	pthread_mutex_lock(&own->lock);
+
+	if(own->first < own->last) {
+
+		next = own->first++;
+	}
+	pthread_mutex_unlock(&own->lock);
+
+	/*Look through the other workers for one with scripts left*/
+	int i;
+	for(i = 1; next < 0 && i < pool->workers; i++) {
+
+		struct Queue *victim = &pool->queues[(id + i) % pool->workers];
+		int first = 0;
+		int last = 0;
+
+		pthread_mutex_lock(&victim->lock);
+
+		if(victim->first < victim->last) {
+
+			/*Take the back half, leaving the victim the front*/
+			int middle = victim->first + (victim->last - victim->first)/2;
+			first = middle;
+			last = victim->last;
+			victim->last = middle;
+		}
+		pthread_mutex_unlock(&victim->lock);
+
+		if(first < last) {
+
+			pthread_mutex_lock(&own->lock);
+			own->first = first + 1;
+			own->last = last;
+			pthread_mutex_unlock(&own->lock);
+			next = first;
+		}
+	}
+
+return next;
+}
+
+/*
+ * Worker thread. Runs scripts until there are none left.
+ * param arg: The worker
+ * return: NULL
+ */
+static void *worker(void *arg) {
+
+	struct Worker *self = arg;
+	struct Pool *pool = self->pool;
+	int next;
+
+	while((next = take(pool, self->id)) >= 0) {
+
+		runScript(&pool->scripts[next], pool->flags);
+
+		pthread_mutex_lock(&pool->doneLock);
+		pool->scripts[next].done = true;
+		pthread_cond_broadcast(&pool->doneReady);
+		pthread_mutex_unlock(&pool->doneLock);
+	}
+
+return NULL;
+}
+
+/*
+ * Reads the paths of scripts from stdin, one per line
+ * param count: Set to the number of paths read
+ * return: The list of paths, each of which is dynamically allocated
+ */
+static char **readPaths(int *count) {
+
+	int size = 64;
+	char **paths = malloc(size*sizeof(char *));
+	checkAlloc(paths);
+	*count = 0;
+
+	char line[4096];
+
+	while(fgets(line, sizeof(line), stdin) != NULL) {
+
+		line[strcspn(line, "\n")] = '\0';
+
+		if(line[0] == '\0') {
+
+			continue;
+		}
+
+		if(*count == size) {
+
+			size *= 2;
+			paths = realloc(paths, size*sizeof(char *));
+			checkAlloc(paths);
+		}
+		paths[*count] = malloc(strlen(line) + 1);
+		checkAlloc(paths[*count]);
+		strcpy(paths[*count], line);
+		(*count)++;
+	}
+
+return paths;
+}
+
+/*
+ * Runs every script as if it was redirected into its own vecalc, spread over
+ * a pool of worker threads
+ * param paths: The paths of the scripts
+ * param count: The number of scripts. If it is zero, the paths are read from
+ * stdin, one per line
+ * param workers: The number of worker threads
+ * param flags: Settings that apply to every script
+ * return: EXIT_SUCCESS if every script could be opened, EXIT_FAILURE otherwise
+ */
+int runScripts(char *paths[], int count, int workers, struct Flags *flags) {
+
+	char **listed = NULL;
+
+	if(count == 0) {
+
+		listed = readPaths(&count);
+		paths = listed;
+	}
+
+	if(workers > count) {
+
+		workers = count > 0 ? count : 1;
+	}
+
+	struct Pool pool;
+	pool.scripts = calloc(count > 0 ? count : 1, sizeof(struct Script));
+	pool.queues = malloc(workers*sizeof(struct Queue));
+	struct Worker *threads = malloc(workers*sizeof(struct Worker));
+	checkAlloc(pool.scripts);
+	checkAlloc(pool.queues);
+	checkAlloc(threads);
+	pool.workers = workers;
+	pool.flags = flags;
+	pthread_mutex_init(&pool.doneLock, NULL);
+	pthread_cond_init(&pool.doneReady, NULL);
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		pool.scripts[i].path = paths[i];
+	}
+
+	/*Every worker starts with an equal, contiguous share of the scripts*/
+	for(i = 0; i < workers; i++) {
+
+		pool.queues[i].first = (long)count*i/workers;
+		pool.queues[i].last = (long)count*(i + 1)/workers;
+		pthread_mutex_init(&pool.queues[i].lock, NULL);
+
+		threads[i].pool = &pool;
+		threads[i].id = i;
+	}
+
+	/*
+	 * The other workers steal the scripts of one that couldn't be started.
+	 * If none could, they are all run here before any are printed.
+	 */
+	int started = 0;
+
+	for(i = 0; i < workers; i++) {
+
+		int error = place_thread(&threads[i].thread, worker, &threads[i], i, workers);
+		threads[i].started = error == 0;
+		started += threads[i].started;
+
+		if(error != 0) {
+
+			fprintf(stderr, "Could not start worker %d: %s\n", i, strerror(error));
+		}
+	}
+
+	if(started == 0) {
+
+		worker(&threads[0]);
+	}
+
+	/*Print each script's output as soon as it and every script before it is done*/
+	int status = EXIT_SUCCESS;
+
+	for(i = 0; i < count; i++) {
+
+		struct Script *script = &pool.scripts[i];
+
+		pthread_mutex_lock(&pool.doneLock);
+
+		while(!script->done) {
+
+			pthread_cond_wait(&pool.doneReady, &pool.doneLock);
+		}
+		pthread_mutex_unlock(&pool.doneLock);
+
+		fwrite(script->out, 1, script->outLength, stdout);
+		fwrite(script->err, 1, script->errLength, stderr);
+		free(script->out);
+		free(script->err);
+
+		if(!script->opened) {
+
+			status = EXIT_FAILURE;
+		}
+	}
+	fflush(stdout);
+
+	for(i = 0; i < workers; i++) {
+
+		if(threads[i].started) {
+
+			pthread_join(threads[i].thread, NULL);
+		}
+		pthread_mutex_destroy(&pool.queues[i].lock);
+	}
+	pthread_mutex_destroy(&pool.doneLock);
+	pthread_cond_destroy(&pool.doneReady);
+	free(threads);
+	free(pool.queues);
+	free(pool.scripts);
+
+	if(listed != NULL) {
+
+		for(i = 0; i < count; i++) {
+
+			free(listed[i]);
+		}
+		free(listed);
+	}
+
+return status;
+}
@@ -0,0 +1,473 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorServe.c						//
+ * Synopsis	:	Runs vecalc as a server on a Unix domain socket. An	//
+ * 			epoll loop hands connections with new input to a pool	//
+ * 			of worker threads, each connection having its own	//
+ * 			session							//
+ *==============================================================================//
+ */
+
+/*For accept4(), epoll, fopencookie() and sigaction()*/
+#define _GNU_SOURCE
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/time.h> /*For the send timeout*/
+
+/*Local Headers*/
+#include "vectorServe.h"
+#include "vectorCmd.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorPlace.h" /*For pinning the workers*/
+
+/*Number of events taken from epoll at a time*/
+#define SERVE_EVENTS 64
+
+/*
+ * Seconds a write to a client may block before the client is dropped, so a
+ * client that stops reading can't hold a worker
+ */
+#define SERVE_SEND_TIMEOUT 5
+
+/*
+ * A client connection. Input is collected in line until a whole line has
+ * arrived, the same as fgets does with MAX_INPUT_LENGTH for stdin.
+ */
+struct Connection {
+
+	int fd;
+	struct Session session;
+	char line[MAX_INPUT_LENGTH];
+	int have;
+	/*Set once a write to the client fails or times out*/
+	bool stalled;
+	/*Next connection in the queue of connections waiting for a worker*/
+	struct Connection *next;
+};
+
+/*
+ * The epoll instance. A connection is registered with EPOLLONESHOT, so while
+ * a worker has it, no other worker can be handed it.
+ */
+static int epollFd;
+
+/*Settings that apply to every session*/
+static struct Flags *serveFlags;
+
+/*Connections with new input, waiting for a worker*/
+static struct Connection *queueHead = NULL;
+static struct Connection *queueTail = NULL;
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queueReady = PTHREAD_COND_INITIALIZER;
+
+/*Set by the signal handler to stop the server*/
+static volatile sig_atomic_t stopping = 0;
+
+/*
+ * Signal handler for SIGINT and SIGTERM
+ * param signum: The signal that was caught
+ */
+static void stop(int signum) {
+
+	(void)signum;
+	stopping = 1;
+}
+
+/*
+ * Writes output to a client for its session's stream. A send blocks for at
+ * most SERVE_SEND_TIMEOUT, and once one fails or times out nothing more is
+ * sent, so a client that stops reading costs a worker one timeout
+ * param cookie: The connection
+ * param buffer: The output
+ * param size: The number of bytes of output
+ * return: size, or -1 once the client has stalled
+ */
+static ssize_t clientWrite(void *cookie, const char *buffer, size_t size) {
+
+	struct Connection *conn = cookie;
+	size_t sent = 0;
+
+	while(!conn->stalled && sent < size) {
+
+		ssize_t n = send(conn->fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+
+		if(n > 0) {
+
+			sent += n;
+		}
+		else if(n < 0 && errno == EINTR) {
+
+			continue;
+		}
+		else {
+
+			conn->stalled = true;
+		}
+	}
+
+return conn->stalled ? -1 : (ssize_t)size;
+}
+
+/*
+ * Closes a connection and frees its session. The session is freed first, so
+ * the summary of its diagnostics and statistics reaches the client
+ * param conn: The connection to close
+ */
+static void closeConnection(struct Connection *conn) {
+
+	free_session(&conn->session);
+	fclose(conn->session.out);
+	close(conn->fd);
+	free(conn);
+}
+
+/*
+ * Runs every whole line that has arrived on a connection
+ * param conn: The connection whose input is run
+ * param final: true if the client has closed its end, so that whatever is left
+ * is the last line
+ * return: false if the session has ended
+ */
+static bool runInput(struct Connection *conn, bool final) {
+
+	bool running = true;
+	int start = 0;
+
+	/*A client that stalled is dropped, so the rest of its input isn't run*/
+	while(running && start < conn->have && !conn->stalled) {
+
+		char *newline = memchr(conn->line + start, '\n', conn->have - start);
+		int end;
+
+		if(newline != NULL) {
+
+			end = newline - conn->line;
+		}
+		/*A line that fills the buffer is run in pieces, as fgets does*/
+		else if(final || conn->have == MAX_INPUT_LENGTH - 1) {
+
+			end = conn->have;
+		}
+		else {
+
+			break;
+		}
+
+		conn->line[end] = '\0';
+		running = runLine(&conn->session, conn->line + start, serveFlags->optimize, serveFlags->showOptimized ? conn->session.err : NULL);
+		start = end + 1;
+	}
+
+	if(start > conn->have) {
+
+		start = conn->have;
+	}
+	memmove(conn->line, conn->line + start, conn->have - start);
+	conn->have -= start;
+
+return running;
+}
+
+/*
+ * Reads everything that has arrived on a connection and runs it
+ * param conn: The connection to handle
+ * return: false if the connection should be closed
+ */
+static bool handle(struct Connection *conn) {
+
+	bool open = true;
+
+	while(open && !conn->stalled) {
+
+		ssize_t n = recv(conn->fd, conn->line + conn->have, MAX_INPUT_LENGTH - 1 - conn->have, MSG_DONTWAIT);
+
+		if(n > 0) {
+
+			conn->have += n;
+			open = runInput(conn, false);
+		}
+		else if(n == 0) {
+
+			runInput(conn, true);
+			open = false;
+		}
+		else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+
+			break;
+		}
+		else if(errno != EINTR) {
+
+			open = false;
+		}
+	}
+	fflush(conn->session.out);
+
+	if(conn->stalled) {
+
+		open = false;
+	}
+
+return open;
+}
+
+/*
+ * Worker thread. Takes connections from the queue and handles them until the
+ * server is stopped.
+ * param arg: unused
+ * return: NULL
+ */
+static void *worker(void *arg) {
+
+	(void)arg;
+
+	while(1) {
+
+		pthread_mutex_lock(&queueLock);
+
+		while(queueHead == NULL && !stopping) {
+
+			pthread_cond_wait(&queueReady, &queueLock);
+		}
+
+		if(queueHead == NULL) {
+
+			pthread_mutex_unlock(&queueLock);
+			return NULL;
+		}
+
+		struct Connection *conn = queueHead;
+		queueHead = conn->next;
+
+		if(queueHead == NULL) {
+
+			queueTail = NULL;
+		}
+		pthread_mutex_unlock(&queueLock);
+
+		if(handle(conn)) {
+
+			/*Ask epoll for the connection again when more arrives*/
+			struct epoll_event event;
+			event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+			event.data.ptr = conn;
+
+			if(epoll_ctl(epollFd, EPOLL_CTL_MOD, conn->fd, &event) < 0) {
+
+				closeConnection(conn);
+			}
+		}
+		else {
+
+			closeConnection(conn);
+		}
+	}
+}
+
+/*
+ * Accepts every connection waiting on the listening socket
+ * param listenFd: The listening socket
+ */
+static void acceptAll(int listenFd) {
+
+	while(1) {
+
+		int fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+
+		if(fd < 0) {
+
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+
+				fprintf(stderr, "Error accepting connection: %s\n", strerror(errno));
+			}
+			return;
+		}
+
+		struct timeval timeout;
+		timeout.tv_sec = SERVE_SEND_TIMEOUT;
+		timeout.tv_usec = 0;
+
+		if(setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(struct timeval)) < 0) {
+
+			close(fd);
+			continue;
+		}
+
+		struct Connection *conn = calloc(1, sizeof(struct Connection));
+		checkAlloc(conn);
+		conn->fd = fd;
+
+		/*
+		 * Writes to the client block for up to SERVE_SEND_TIMEOUT, reads
+		 * don't. Results and errors both go back to the client.
+		 */
+		cookie_io_functions_t io = {NULL, clientWrite, NULL, NULL};
+		FILE *out = fopencookie(conn, "w", io);
+
+		if(out == NULL) {
+
+			close(fd);
+			free(conn);
+			continue;
+		}
+		init_session(&conn->session, out, out);
+		configure_session(&conn->session, serveFlags);
+
+		struct epoll_event event;
+		event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+		event.data.ptr = conn;
+
+		if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+
+			closeConnection(conn);
+		}
+	}
+}
+
+/*
+ * Listens on a Unix domain socket and runs the lines sent on each connection
+ * against that connection's own session
+ * param path: The path of the socket. Any existing file there is replaced
+ * param workers: The number of worker threads that run commands
+ * param flags: Settings that apply to every session
+ * return: EXIT_SUCCESS once the server is stopped, EXIT_FAILURE if it could not
+ * be started
+ */
+int serve(char *path, int workers, struct Flags *flags) {
+
+	serveFlags = flags;
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(struct sockaddr_un));
+	address.sun_family = AF_UNIX;
+
+	if(strlen(path) >= sizeof(address.sun_path)) {
+
+		fprintf(stderr, "Socket path is too long: %s\n", path);
+		return EXIT_FAILURE;
+	}
+	strcpy(address.sun_path, path);
+
+	int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	unlink(path);
+
+	if(listenFd < 0 || bind(listenFd, (struct sockaddr *)&address, sizeof(struct sockaddr_un)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+
+		fprintf(stderr, "Could not listen on %s: %s\n", path, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+
+	if(epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+
+		fprintf(stderr, "Could not set up epoll: %s\n", strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	/*Stop on SIGINT or SIGTERM, and don't die when a client goes away*/
+	struct sigaction action;
+	memset(&action, 0, sizeof(struct sigaction));
+	action.sa_handler = stop;
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	pthread_t *threads = malloc(workers*sizeof(pthread_t));
+	checkAlloc(threads);
+	bool *started = malloc(workers*sizeof(bool));
+	checkAlloc(started);
+	int running = 0;
+
+	int i;
+	for(i = 0; i < workers; i++) {
+
+		int error = place_thread(&threads[i], worker, NULL, i, workers);
+		started[i] = error == 0;
+		running += started[i];
+
+		if(error != 0) {
+
+			fprintf(stderr, "Could not start worker %d: %s\n", i, strerror(error));
+		}
+	}
+
+	/*With no workers, nothing would ever answer a client*/
+	if(running == 0) {
+
+		stopping = 1;
+	}
+
+	struct epoll_event events[SERVE_EVENTS];
+
+	while(!stopping) {
+
+		int n = epoll_wait(epollFd, events, SERVE_EVENTS, -1);
+
+		for(i = 0; i < n; i++) {
+
+			if(events[i].data.ptr == NULL) {
+
+				acceptAll(listenFd);
+				continue;
+			}
+
+			struct Connection *conn = events[i].data.ptr;
+			conn->next = NULL;
+
+			pthread_mutex_lock(&queueLock);
+
+			if(queueTail == NULL) {
+
+				queueHead = conn;
+			}
+			else {
+
+				queueTail->next = conn;
+			}
+			queueTail = conn;
+
+			pthread_cond_signal(&queueReady);
+			pthread_mutex_unlock(&queueLock);
+		}
+	}
+
+	/*
+	 * Workers finish what is queued and then exit. Connections that are
+	 * still open are closed when the process exits.
+	 */
+	pthread_mutex_lock(&queueLock);
+	pthread_cond_broadcast(&queueReady);
+	pthread_mutex_unlock(&queueLock);
+
+	for(i = 0; i < workers; i++) {
+
+		if(started[i]) {
+
+			pthread_join(threads[i], NULL);
+		}
+	}
+	free(threads);
+	free(started);
+
+	close(listenFd);
+	close(epollFd);
+	unlink(path);
+
+return running > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
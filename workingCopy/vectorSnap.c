@@ -0,0 +1,271 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorSnap.c						//
+ * Synopsis	:	Snapshots of a session written to a file that a new	//
+ * 			vecalc maps back in, to carry on where it left off	//
+ *==============================================================================//
+ */
+
+/*For fsync(), fileno() and mmap()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*Local Headers*/
+#include "vectorSnap.h"
+#include "vectorMem.h" /*For map_elements() and copy_vec()*/
+#include "vectorPack.h" /*For pack_vec()*/
+#include "vectorDiag.h"
+
+/*
+ * The form a vector is in. A vector cleared with c is made again in the
+ * session's storage, so it is packed if that is
+ * param session: The session
+ * return: The form of its vector
+ */
+static enum SnapForm formOf(struct Session *session) {
+
+	if(session->vec == NULL) {
+
+		return session->storage != STORAGE_FLOAT ? SNAP_PACKED : SNAP_DENSE;
+	}
+
+	if(session->vec->sparse != NULL) {
+
+		return SNAP_SPARSE;
+	}
+
+return session->vec->packed != NULL ? SNAP_PACKED : SNAP_DENSE;
+}
+
+/*
+ * Writes the header, elements and line of a snapshot to a stream
+ * param file: The stream
+ * param session: The session
+ * param ran: The number of the last input line that has run
+ * return: false if any of it couldn't be written
+ */
+static bool writeSnapshot(FILE *file, struct Session *session, long ran) {
+
+	/*The header is padded with zeroes up to where the elements start*/
+	unsigned char page[SNAP_HEADER_BYTES];
+	memset(page, 0, sizeof(page));
+
+	/*Only the line parsed for the commands running now is in the snapshot*/
+	const char *line = session->lastLineShared ? NULL : session->lastLine;
+
+	struct SnapHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SNAP_MAGIC, sizeof(SNAP_MAGIC));
+	header.version = SNAP_VERSION;
+	header.elemBytes = sizeof(Elem);
+	header.order = SNAP_ORDER;
+	header.form = formOf(session);
+	header.storage = session->storage;
+	header.format = session->format;
+	header.size = session->vec != NULL ? session->vec->size : 0;
+	header.line = ran;
+	header.lineBytes = line != NULL ? strlen(line) : 0;
+	memcpy(page, &header, sizeof(header));
+
+	if(fwrite(page, 1, sizeof(page), file) != sizeof(page)) {
+
+		return false;
+	}
+
+	/*A sparse or packed vector is written out dense, so it can be mapped*/
+	struct Vector *dense = session->vec;
+
+	if(dense != NULL && (dense->sparse != NULL || dense->packed != NULL)) {
+
+		dense = copy_vec(session->vec);
+	}
+	bool written = header.size == 0 || fwrite(dense->elements, sizeof(Elem), header.size, file) == header.size;
+
+	if(dense != session->vec) {
+
+		dealloc_vec(dense);
+	}
+
+return written && (header.lineBytes == 0 || fwrite(line, 1, header.lineBytes, file) == header.lineBytes);
+}
+
+/*
+ * Writes a snapshot of a session to a file
+ * param session: The session
+ * param path: The path of the snapshot
+ * param ran: The number of the last input line that has run
+ * return: false if it couldn't be written, with errno set
+ */
+bool snapshot_write(struct Session *session, const char *path, long ran) {
+
+	char *partial = malloc(strlen(path) + sizeof(".part"));
+	checkAlloc(partial);
+	sprintf(partial, "%s.part", path);
+
+	FILE *file = fopen(partial, "wb");
+
+	if(file == NULL) {
+
+		free(partial);
+		return false;
+	}
+
+	/*It has to be on disk before it replaces the last one*/
+	bool written = writeSnapshot(file, session, ran) && fflush(file) == 0 && fsync(fileno(file)) == 0;
+	int error = errno;
+
+	if(fclose(file) != 0 && written) {
+
+		written = false;
+		error = errno;
+	}
+
+	if(written && rename(partial, path) != 0) {
+
+		written = false;
+		error = errno;
+	}
+
+	if(!written) {
+
+		remove(partial);
+	}
+	free(partial);
+	errno = error;
+
+return written;
+}
+
+/*
+ * Checks that a header is one this vecalc wrote, and that the file is long
+ * enough for everything it says follows it
+ * param header: The header
+ * param length: The length of the file
+ * return: true if the snapshot can be restored
+ */
+static bool validHeader(struct SnapHeader *header, uint64_t length) {
+
+	if(memcmp(header->magic, SNAP_MAGIC, sizeof(SNAP_MAGIC)) != 0 || header->version != SNAP_VERSION || header->order != SNAP_ORDER || header->elemBytes != sizeof(Elem)) {
+
+		return false;
+	}
+
+	if(header->form > SNAP_PACKED || header->storage > STORAGE_XOR || header->format > FORMAT_BINARY || header->size > MAXVECSIZE) {
+
+		return false;
+	}
+
+return header->lineBytes <= length && SNAP_HEADER_BYTES + header->size*sizeof(Elem) <= length - header->lineBytes;
+}
+
+/*
+ * Restores a session from a snapshot, leaving the vector's elements in the
+ * mapping of the file
+ * param session: The session, whose vector is replaced
+ * param path: The path of the snapshot
+ * return: false if the snapshot couldn't be restored, which leaves the
+ * session as it was
+ */
+bool snapshot_restore(struct Session *session, const char *path) {
+
+	int fd = open(path, O_RDONLY);
+
+	if(fd < 0) {
+
+		return false;
+	}
+
+	struct stat status;
+
+	if(fstat(fd, &status) != 0 || status.st_size < SNAP_HEADER_BYTES) {
+
+		close(fd);
+		return false;
+	}
+
+	/*Private, so changes to the vector never reach the file*/
+	size_t length = status.st_size;
+	void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(base == MAP_FAILED) {
+
+		return false;
+	}
+
+	struct SnapHeader header;
+	memcpy(&header, base, sizeof(header));
+
+	if(!validHeader(&header, length)) {
+
+		munmap(base, length);
+		return false;
+	}
+
+	free(session->lastLine);
+	session->lastLine = NULL;
+
+	if(header.lineBytes > 0) {
+
+		session->lastLine = malloc(header.lineBytes + 1);
+		checkAlloc(session->lastLine);
+		memcpy(session->lastLine, (char *)base + SNAP_HEADER_BYTES + header.size*sizeof(Elem), header.lineBytes);
+		session->lastLine[header.lineBytes] = '\0';
+	}
+
+	dealloc_vec(session->vec);
+	session->vec = alloc_vec();
+
+	if(header.size > 0) {
+
+		session->vec->elements = (Elem *)((char *)base + SNAP_HEADER_BYTES);
+		session->vec->size = header.size;
+		map_elements(base, length, session->vec->elements);
+	}
+	else {
+
+		munmap(base, length);
+	}
+
+	session->storage = header.storage;
+	session->format = header.format;
+	session->line = header.line;
+
+	if(header.form == SNAP_PACKED) {
+
+		pack_vec(session->vec, session->storage, NULL);
+	}
+
+return true;
+}
+
+/*
+ * Takes a periodic snapshot if snapshotEvery lines have run since the last
+ * param session: The session
+ * param line: The line that has just finished running
+ */
+void snapshot_due(struct Session *session, long line) {
+
+	if(session->snapshotEvery <= 0 || line - session->snapshotLast < session->snapshotEvery) {
+
+		return;
+	}
+	session->snapshotLast = line;
+
+	if(!snapshot_write(session, session->snapshotPath, line)) {
+
+		diagnose(&session->diag, DIAG_SNAPSHOT, line, session->err, "Could not write a snapshot to %s: %s\n", session->snapshotPath, strerror(errno));
+	}
+}
@@ -0,0 +1,357 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorSparse.c						//
+ * Synopsis	:	Vectors kept as the few elements that differ from a	//
+ * 			background value, and switching to and from them	//
+ *==============================================================================//
+ */
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h> /*For memcmp()*/
+
+/*Local Headers*/
+#include "vectorSparse.h"
+#include "vectorMem.h" /*For checkAlloc() and free_elements()*/
+#include "vectorProbe.h"
+
+/*Elements there is room to list when a sparse form is first made*/
+#define SPARSE_MIN_CAPACITY 16
+
+/*
+ * Checks if an element is the background. NaN is never the background, and -0
+ * and 0 are different elements
+ * param value: The element
+ * param background: The background
+ * return: true if they have the same bits
+ */
+static bool isBackground(Elem value, Elem background) {
+
+return memcmp(&value, &background, sizeof(Elem)) == 0;
+}
+
+/*
+ * Runs an operation on one element, the way the kernels' loops do
+ * param option: +, -, * or /
+ * param element: The element
+ * param value: The value of the operation
+ * return: The new element
+ */
+static Elem apply(char option, Elem element, Elem value) {
+
+	switch(option) {
+
+		case '+':	return element + value;
+		case '-':	return element - value;
+		case '*':	return element*value;
+		default:	return element/value;
+	}
+}
+
+/*
+ * Makes room to list more elements
+ * param sparse: The sparse form
+ * param count: Elements that will be listed
+ */
+static void reserve(struct Sparse *sparse, int count) {
+
+	if(count <= sparse->capacity && sparse->capacity > 0) {
+
+		return;
+	}
+
+	int capacity = sparse->capacity*2 > count ? sparse->capacity*2 : count;
+
+	if(capacity < SPARSE_MIN_CAPACITY) {
+
+		capacity = SPARSE_MIN_CAPACITY;
+	}
+
+	sparse->indices = realloc(sparse->indices, capacity*sizeof(int));
+	sparse->values = realloc(sparse->values, capacity*sizeof(Elem));
+	checkAlloc(sparse->indices);
+	checkAlloc(sparse->values);
+	sparse->capacity = capacity;
+}
+
+/*
+ * Makes a dense vector sparse, if it is at least SPARSE_MIN_SIZE long and no
+ * more than 1 in SPARSE_DENSITY of its elements are not 0. Counting stops as
+ * soon as there are too many.
+ * param vector: The vector
+ * return: true if the vector is sparse
+ */
+bool sparsify(struct Vector *vector) {
+
+	if(vector->sparse != NULL) {
+
+		return true;
+	}
+
+	if(vector->size < SPARSE_MIN_SIZE || vector->packed != NULL) {
+
+		return false;
+	}
+
+	Elem background = 0;
+	int most = vector->size/SPARSE_DENSITY;
+	int count = 0;
+
+	int i;
+	for(i = 0; i < vector->size && count <= most; i++) {
+
+		count += !isBackground(vector->elements[i], background);
+	}
+
+	if(count > most) {
+
+		return false;
+	}
+
+	struct Sparse *sparse = calloc(1, sizeof(struct Sparse));
+	checkAlloc(sparse);
+	sparse->background = background;
+	reserve(sparse, count);
+
+	for(i = 0; i < vector->size; i++) {
+
+		if(!isBackground(vector->elements[i], background)) {
+
+			sparse->indices[sparse->count] = i;
+			sparse->values[sparse->count++] = vector->elements[i];
+		}
+	}
+	VEC_PROBE2(vector_sparse, vector->size, sparse->count);
+
+	free_elements(vector->elements);
+	vector->elements = NULL;
+	vector->sparse = sparse;
+
+return true;
+}
+
+/*
+ * Writes out the elements of a sparse vector from first up to last. Only the
+ * listed elements in that range are looked at
+ * param vector: The sparse vector
+ * param first: Index of the first element
+ * param last: Index one past the last element
+ * param elements: Filled with the elements, the first one at index 0
+ */
+void sparse_fill(struct Vector *vector, int first, int last, Elem *elements) {
+
+	struct Sparse *sparse = vector->sparse;
+
+	int i;
+	for(i = first; i < last; i++) {
+
+		elements[i - first] = sparse->background;
+	}
+
+	/*The indices are in order, so the first one in range is searched for*/
+	int low = 0;
+	int high = sparse->count;
+
+	while(low < high) {
+
+		int middle = low + (high - low)/2;
+
+		if(sparse->indices[middle] < first) {
+
+			low = middle + 1;
+		}
+		else {
+
+			high = middle;
+		}
+	}
+
+	for(i = low; i < sparse->count && sparse->indices[i] < last; i++) {
+
+		elements[sparse->indices[i] - first] = sparse->values[i];
+	}
+}
+
+/*
+ * Makes a sparse vector dense. A dense vector is left alone
+ * param vector: The vector
+ */
+void densify(struct Vector *vector) {
+
+	if(vector->sparse == NULL) {
+
+		return;
+	}
+	VEC_PROBE2(vector_dense, vector->size, vector->sparse->count);
+
+	vector->elements = malloc(vector->size*sizeof(Elem));
+	checkAlloc(vector->elements);
+	sparse_fill(vector, 0, vector->size, vector->elements);
+
+	sparse_free(vector->sparse);
+	vector->sparse = NULL;
+}
+
+/*
+ * Switches a vector to the form that suits it after an option changed it
+ * param vector: The vector
+ * param option: The option that changed it
+ * param value: The value of the option
+ */
+void settle_vec(struct Vector *vector, char option, Elem value) {
+
+	/*A packed vector stays packed until the z option unpacks it*/
+	if(vector->packed != NULL) {
+
+		return;
+	}
+
+	if(vector->sparse != NULL) {
+
+		if((long)vector->sparse->count*DENSE_DENSITY > vector->size) {
+
+			densify(vector);
+		}
+	}
+	else if(vector->size >= SPARSE_MIN_SIZE) {
+
+		bool zeroed = option == '*' && value == 0;
+		bool doubled = option == 'a' && (vector->size & (vector->size - 1)) == 0;
+
+		if(zeroed || doubled) {
+
+			sparsify(vector);
+		}
+	}
+}
+
+/*
+ * Applies an operation to a sparse vector. Every element that isn't listed is
+ * the background, so it is the same operation on the same bits for each of
+ * them, and is done once.
+ * param vector: The sparse vector
+ * param option: +, -, * or /
+ * param value: The value of the operation
+ */
+void sparse_sweep(struct Vector *vector, char option, Elem value) {
+
+	struct Sparse *sparse = vector->sparse;
+	sparse->background = apply(option, sparse->background, value);
+
+	int kept = 0;
+
+	int i;
+	for(i = 0; i < sparse->count; i++) {
+
+		Elem element = apply(option, sparse->values[i], value);
+
+		if(!isBackground(element, sparse->background)) {
+
+			sparse->indices[kept] = sparse->indices[i];
+			sparse->values[kept++] = element;
+		}
+	}
+	sparse->count = kept;
+}
+
+/*
+ * Sums a sparse vector
+ * param vector: The sparse vector
+ * return: The sum
+ */
+Elem sparse_magnitude(struct Vector *vector) {
+
+	struct Sparse *sparse = vector->sparse;
+	Elem magnitude = 0;
+
+	/*A background of 0 adds nothing, so the sum is the one the dense vector gives*/
+	if(isBackground(sparse->background, 0)) {
+
+		int i;
+		for(i = 0; i < sparse->count; i++) {
+
+			magnitude += sparse->values[i];
+		}
+		return magnitude;
+	}
+
+	/*
+	 * Otherwise the background is added in where it is, so the sum is
+	 * rounded the same way as the dense vector's
+	 */
+	int listed = 0;
+
+	int i;
+	for(i = 0; i < vector->size; i++) {
+
+		if(listed < sparse->count && sparse->indices[listed] == i) {
+
+			magnitude += sparse->values[listed++];
+		}
+		else {
+
+			magnitude += sparse->background;
+		}
+	}
+
+return magnitude;
+}
+
+/*
+ * Appends elements to a sparse vector, in place
+ * param vector: The sparse vector
+ * param values: The values
+ * param count: The number of values
+ */
+void sparse_append(struct Vector *vector, Elem *values, int count) {
+
+	struct Sparse *sparse = vector->sparse;
+
+	int i;
+	for(i = 0; i < count; i++) {
+
+		if(!isBackground(values[i], sparse->background)) {
+
+			reserve(sparse, sparse->count + 1);
+			sparse->indices[sparse->count] = vector->size + i;
+			sparse->values[sparse->count++] = values[i];
+		}
+	}
+	vector->size += count;
+}
+
+/*
+ * Copies the sparse form of a vector
+ * param vector: The sparse vector
+ * return: A copy of its sparse form
+ */
+struct Sparse *sparse_copy(struct Vector *vector) {
+
+	struct Sparse *copy = calloc(1, sizeof(struct Sparse));
+	checkAlloc(copy);
+	copy->background = vector->sparse->background;
+	reserve(copy, vector->sparse->count);
+
+	memcpy(copy->indices, vector->sparse->indices, vector->sparse->count*sizeof(int));
+	memcpy(copy->values, vector->sparse->values, vector->sparse->count*sizeof(Elem));
+	copy->count = vector->sparse->count;
+
+return copy;
+}
+
+/*
+ * Frees the sparse form of a vector
+ * param sparse: The sparse form. Null is ignored
+ */
+void sparse_free(struct Sparse *sparse) {
+
+	if(sparse == NULL) {
+
+		return;
+	}
+	free(sparse->indices);
+	free(sparse->values);
+	free(sparse);
+}
@@ -0,0 +1,157 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorStats.c						//
+ * Synopsis	:	Latency histograms of the commands a session runs	//
+ *==============================================================================//
+ */
+
+/*For clock_gettime()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/*Local Headers*/
+#include "vectorStats.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+
+/*
+ * Reads the cycle counter, or the monotonic clock in nanoseconds where there is
+ * no cycle counter
+ * return: The time in STATS_UNIT
+ */
+uint64_t statsClock(void) {
+
+	#if defined(__x86_64__) || defined(__i386__)
+
+	return __builtin_ia32_rdtsc();
+
+	#else
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (uint64_t)time.tv_sec*1000000000 + time.tv_nsec;
+
+	#endif
+}
+
+/*
+ * Finds the bucket a latency belongs in. Latencies under STATS_SUB_BUCKETS get
+ * a bucket each, and every power of two above that is split into
+ * STATS_SUB_BUCKETS buckets
+ * param value: The latency
+ * return: The bucket
+ */
+static int bucketOf(uint64_t value) {
+
+	if(value < STATS_SUB_BUCKETS) {
+
+		return value;
+	}
+
+	int shift = 63 - __builtin_clzll(value) - STATS_SUB_BITS;
+
+return (shift + 1)*STATS_SUB_BUCKETS + ((value >> shift) & (STATS_SUB_BUCKETS - 1));
+}
+
+/*
+ * The largest latency that belongs in a bucket
+ * param bucket: The bucket
+ * return: The latency
+ */
+static uint64_t bucketTop(int bucket) {
+
+	if(bucket < STATS_SUB_BUCKETS) {
+
+		return bucket;
+	}
+
+	int shift = bucket/STATS_SUB_BUCKETS - 1;
+	uint64_t bottom = (uint64_t)(STATS_SUB_BUCKETS + bucket%STATS_SUB_BUCKETS) << shift;
+
+return bottom + (((uint64_t)1 << shift) - 1);
+}
+
+/*
+ * Counts one command in the histogram of its option
+ * param stats: The statistics
+ * param option: The option
+ * param ticks: How long the command took, in STATS_UNIT
+ * param elements: The elements in the vector when it ran
+ */
+void statsRecord(struct Stats *stats, char option, uint64_t ticks, long elements) {
+
+	int index = option & (STATS_OPTIONS - 1);
+	struct Histogram *histogram = stats->options[index];
+
+	if(histogram == NULL) {
+
+		histogram = calloc(1, sizeof(struct Histogram));
+		checkAlloc(histogram);
+		stats->options[index] = histogram;
+	}
+
+	histogram->count++;
+	histogram->elements += elements;
+	histogram->buckets[bucketOf(ticks)]++;
+
+	if(ticks > histogram->max) {
+
+		histogram->max = ticks;
+	}
+}
+
+/*
+ * The latency that a fraction of the commands in a histogram took no longer
+ * than, to within the width of its bucket
+ * param histogram: The histogram
+ * param fraction: The fraction, from 0 to 1
+ * return: The latency in STATS_UNIT
+ */
+uint64_t statsPercentile(struct Histogram *histogram, double fraction) {
+
+	/*The rank of the command at that fraction, counting from 1*/
+	long rank = (long)(fraction*histogram->count + 0.999999);
+
+	if(rank < 1) {
+
+		rank = 1;
+	}
+
+	long seen = 0;
+
+	int i;
+	for(i = 0; i < STATS_BUCKETS; i++) {
+
+		seen += histogram->buckets[i];
+
+		if(seen >= rank) {
+
+			break;
+		}
+	}
+
+	/*The top of the bucket can be more than anything that was in it*/
+	uint64_t top = bucketTop(i);
+
+return top < histogram->max ? top : histogram->max;
+}
+
+/*
+ * Frees the histograms held by statistics
+ * param stats: The statistics, which are not freed themselves
+ */
+void free_stats(struct Stats *stats) {
+
+	int i;
+	for(i = 0; i < STATS_OPTIONS; i++) {
+
+		free(stats->options[i]);
+		stats->options[i] = NULL;
+	}
+}
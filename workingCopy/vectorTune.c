@@ -0,0 +1,324 @@
+/*
+ *==============================================================================//
+ * Author	:	Ben Haubrich						//
+ * File		:	vectorTune.c						//
+ * Synopsis	:	Sizes at which the kernels switch from scalar loops to	//
+ * 			SIMD and to threads, measured on the host		//
+ *==============================================================================//
+ */
+
+/*For clock_gettime()*/
+#define _POSIX_C_SOURCE 200809L
+
+/*Standard Headers*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h> /*For HUGE_VAL*/
+
+/*Local Headers*/
+#include "vectorTune.h"
+#include "vectorOps.h" /*For sweep()*/
+#include "vectorDiff.h"
+#include "vectorMem.h" /*For checkAlloc()*/
+#include "vectorPlace.h" /*For the names of the placements*/
+
+/*Smallest and largest vectors calibrated*/
+#define TUNE_MIN_SIZE 16
+#define TUNE_MAX_SIZE 1048576
+
+/*Timed samples of each path at each size; the median is kept*/
+#define TUNE_REPS 9
+
+/*Each sample runs a path until it has touched at least this many elements*/
+#define TUNE_BATCH_ELEMENTS 262144
+
+/*Number of sizes calibrated, doubling from TUNE_MIN_SIZE to TUNE_MAX_SIZE*/
+#define TUNE_SIZES 17
+
+/*
+ * Threads are not timed on vectors smaller than this. Starting them takes
+ * longer than sweeping a vector this size, and timing thousands of them makes
+ * calibration take seconds
+ */
+#define TUNE_THREAD_SIZE 1024
+
+/*
+ * A path has to be this much faster than the one it replaces to count as
+ * faster, so that noise in the timings doesn't set a threshold
+ */
+#define TUNE_MARGIN 0.9
+
+struct Tuning tuning = {TUNE_DEFAULT_SIMD_MIN, TUNE_DEFAULT_THREAD_MIN, DIFF_PARALLEL_MIN, 0, PLACE_LOCAL};
+
+/*
+ * The path of the profile
+ * return: VECALC_PROFILE if it is set, or TUNE_PROFILE_NAME in the home
+ * directory. The string is never freed
+ */
+const char *tuningPath(void) {
+
+	static char path[4096];
+
+	if(getenv("VECALC_PROFILE") != NULL) {
+
+		return getenv("VECALC_PROFILE");
+	}
+
+	if(path[0] == '\0') {
+
+		sprintf(path, "%.4000s/%s", getenv("HOME") != NULL ? getenv("HOME") : ".", TUNE_PROFILE_NAME);
+	}
+
+return path;
+}
+
+/*
+ * Loads a profile written by calibrate(). It is a few lines of a name and a
+ * number, so reading it costs no more than opening it.
+ * param path: The path of the profile
+ * return: true if the profile was read
+ */
+bool loadTuning(const char *path) {
+
+	if(tuning.threads == 0) {
+
+		tuning.threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	FILE *profile = fopen(path, "r");
+
+	if(profile == NULL) {
+
+		return false;
+	}
+
+	char line[128];
+	char name[32];
+	char word[32];
+	long value;
+
+	while(fgets(line, sizeof(line), profile) != NULL) {
+
+		/*The placement is the only setting given by name*/
+		if(sscanf(line, "%31s %31s", name, word) == 2 && strcmp(name, "placement") == 0 && placementByName(word) >= 0) {
+
+			tuning.placement = placementByName(word);
+			continue;
+		}
+
+		if(sscanf(line, "%31s %ld", name, &value) != 2 || value < 0) {
+
+			continue;
+		}
+
+		if(strcmp(name, "simdMin") == 0) {
+
+			tuning.simdMin = value;
+		}
+		else if(strcmp(name, "threadMin") == 0) {
+
+			tuning.threadMin = value;
+		}
+		else if(strcmp(name, "diffThreadMin") == 0) {
+
+			tuning.diffThreadMin = value;
+		}
+		else if(strcmp(name, "threads") == 0 && value > 0) {
+
+			tuning.threads = value;
+		}
+	}
+	fclose(profile);
+
+return true;
+}
+
+/*
+ * Reads the monotonic clock
+ * return: The time in nanoseconds
+ */
+static double now() {
+
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+return time.tv_sec*1e9 + time.tv_nsec;
+}
+
+/*
+ * Orders two doubles from smallest to largest, for qsort()
+ * param a: A double
+ * param b: Another double
+ * return: Less than zero if a comes first, more than zero if b comes first
+ */
+static int ascending(const void *a, const void *b) {
+
+	double first = *(const double *)a;
+	double second = *(const double *)b;
+
+return (first > second) - (first < second);
+}
+
+/*
+ * Times one path at one size. Multiplying by one leaves the elements as they
+ * were, so every sample sees the same numbers.
+ * param vector: The vector, which is the size being timed
+ * param other: A vector as large, for diff_vec() to compare against
+ * param path: The path, or PATH_AUTO to time diff_vec() as it is tuned
+ * return: The median nanoseconds per element
+ */
+static double timePath(struct Vector *vector, struct Vector *other, enum Path path) {
+
+	double samples[TUNE_REPS];
+	long batch = (TUNE_BATCH_ELEMENTS + vector->size - 1)/vector->size;
+	struct Tolerance tolerance = {0, 0, 0};
+	struct DiffResult result;
+
+	int r;
+	for(r = -1; r < TUNE_REPS; r++) {
+
+		double start = now();
+
+		long b;
+		for(b = 0; b < batch; b++) {
+
+			if(path == PATH_AUTO) {
+
+				diff_vec(vector, other, &tolerance, 0, &result);
+			}
+			else {
+
+				sweep(vector, '*', 1, path);
+			}
+		}
+
+		/*The first sample warms the caches and isn't kept*/
+		if(r >= 0) {
+
+			samples[r] = (now() - start)/batch/vector->size;
+		}
+	}
+	qsort(samples, TUNE_REPS, sizeof(double), ascending);
+
+return samples[TUNE_REPS/2];
+}
+
+/*
+ * The smallest size from which one path is faster than another by TUNE_MARGIN
+ * at every size calibrated
+ * param sizes: The sizes
+ * param faster: Nanoseconds per element of the path that should be faster
+ * param slower: Nanoseconds per element of the path it replaces
+ * return: The size, or TUNE_NEVER if it is never faster at the largest size
+ */
+static long crossover(long *sizes, double *faster, double *slower) {
+
+	long from = TUNE_NEVER;
+
+	int s;
+	for(s = TUNE_SIZES - 1; s >= 0 && faster[s] < slower[s]*TUNE_MARGIN; s--) {
+
+		from = sizes[s];
+	}
+
+return from;
+}
+
+/*
+ * Times the scalar, SIMD and threaded kernels and diff_vec() at sizes from
+ * TUNE_MIN_SIZE to TUNE_MAX_SIZE, finds where each path starts to win, and
+ * writes a profile. The thresholds are also used from then on.
+ * param path: The path the profile is written to
+ * param report: Where the timings are reported
+ * return: true if the profile was written
+ */
+bool calibrate(const char *path, FILE *report) {
+
+	long sizes[TUNE_SIZES];
+	double scalar[TUNE_SIZES];
+	double simd[TUNE_SIZES];
+	double threads[TUNE_SIZES];
+	double best[TUNE_SIZES];
+	double diffSerial[TUNE_SIZES];
+	double diffThreads[TUNE_SIZES];
+
+	if(tuning.threads == 0) {
+
+		tuning.threads = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	struct Vector vector;
+	struct Vector other;
+	vector.elements = malloc(TUNE_MAX_SIZE*sizeof(Elem));
+	other.elements = malloc(TUNE_MAX_SIZE*sizeof(Elem));
+	checkAlloc(vector.elements);
+	checkAlloc(other.elements);
+
+	long i;
+	for(i = 0; i < TUNE_MAX_SIZE; i++) {
+
+		vector.elements[i] = i%100;
+		other.elements[i] = i%100;
+	}
+
+	fprintf(report, "%10s %10s %10s %10s %10s %10s   (ns/element, %d threads)\n", "elements", "scalar", "simd", "threads", "diff", "diff x2", tuning.threads);
+
+	int s;
+	for(s = 0; s < TUNE_SIZES; s++) {
+
+		sizes[s] = (long)TUNE_MIN_SIZE << s;
+		vector.size = sizes[s];
+		other.size = sizes[s];
+
+		scalar[s] = timePath(&vector, NULL, PATH_SCALAR);
+		simd[s] = timePath(&vector, NULL, PATH_SIMD);
+		best[s] = simd[s] < scalar[s] ? simd[s] : scalar[s];
+
+		/*diff_vec() on one thread, then on two*/
+		tuning.diffThreadMin = TUNE_NEVER;
+		diffSerial[s] = timePath(&vector, &other, PATH_AUTO);
+
+		/*With one CPU, threads can only be slower*/
+		if(tuning.threads > 1 && sizes[s] >= TUNE_THREAD_SIZE) {
+
+			threads[s] = timePath(&vector, NULL, PATH_THREADS);
+			tuning.diffThreadMin = sizes[s]/2;
+			diffThreads[s] = timePath(&vector, &other, PATH_AUTO);
+		}
+		else {
+
+			threads[s] = HUGE_VAL;
+			diffThreads[s] = HUGE_VAL;
+		}
+
+		fprintf(report, "%10ld %10.3f %10.3f %10.3f %10.3f %10.3f\n", sizes[s], scalar[s], simd[s], threads[s], diffSerial[s], diffThreads[s]);
+	}
+	free(vector.elements);
+	free(other.elements);
+
+	tuning.simdMin = crossover(sizes, simd, scalar);
+	tuning.threadMin = crossover(sizes, threads, best);
+	tuning.diffThreadMin = crossover(sizes, diffThreads, diffSerial)/2;
+
+	FILE *profile = fopen(path, "w");
+
+	if(profile == NULL) {
+
+		fprintf(report, "Could not write %s\n", path);
+		return false;
+	}
+	fprintf(profile, "# Written by vecalc --calibrate. Sizes in elements; %d means never\n", TUNE_NEVER);
+	fprintf(profile, "simdMin %ld\n", tuning.simdMin);
+	fprintf(profile, "threadMin %ld\n", tuning.threadMin);
+	fprintf(profile, "diffThreadMin %ld\n", tuning.diffThreadMin);
+	fprintf(profile, "threads %d\n", tuning.threads);
+	fprintf(profile, "placement %s\n", placementName(tuning.placement));
+
+	fprintf(report, "simdMin %ld, threadMin %ld, diffThreadMin %ld written to %s\n", tuning.simdMin, tuning.threadMin, tuning.diffThreadMin, path);
+
+return fclose(profile) == 0;
+}